@@ -0,0 +1,127 @@
+#include <benchmark/benchmark.h>
+
+#include <src/http_handler.hpp>
+#include <src/http_parser.hpp>
+#include <src/simd_scanner.hpp>
+
+// Chrome 访问首页时发出的典型请求
+static const std::string BROWSER_REQUEST =
+        "GET /images/background.jpg HTTP/1.1\r\n"
+        "Host: 127.0.0.1:8080\r\n"
+        "Connection: keep-alive\r\n"
+        "sec-ch-ua: \"Chromium\";v=\"118\", \"Google Chrome\";v=\"118\", \"Not=A?Brand\";v=\"99\"\r\n"
+        "sec-ch-ua-mobile: ?0\r\n"
+        "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/537.36 (KHTML, like Gecko) "
+        "Chrome/118.0.0.0 Safari/537.36\r\n"
+        "sec-ch-ua-platform: \"macOS\"\r\n"
+        "Accept: image/avif,image/webp,image/apng,image/svg+xml,image/*,*/*;q=0.8\r\n"
+        "Sec-Fetch-Site: same-origin\r\n"
+        "Sec-Fetch-Mode: no-cors\r\n"
+        "Sec-Fetch-Dest: image\r\n"
+        "Referer: http://127.0.0.1:8080/index\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\n"
+        "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+        "Cookie: _ga=GA1.1.1440186411.1697071215; session=6f1d2c3b4a5e6f708192a3b4c5d6e7f8\r\n"
+        "If-None-Match: \"f1e2d3c4b5a6\"\r\n"
+        "If-Modified-Since: Mon, 26 Sep 2022 08:12:45 GMT\r\n"
+        "\r\n";
+
+static void parseWithLevel(benchmark::State &state, SimdLevel level) {
+    if (!SimdScanner::setLevel(level)) {
+        state.SkipWithError("Instruction set not supported");
+        return;
+    }
+    HttpParser parser;
+    for (auto _: state) {
+        parser.reset();
+        benchmark::DoNotOptimize(parser.parse(BROWSER_REQUEST));
+        benchmark::DoNotOptimize(parser.request().headerCount);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * BROWSER_REQUEST.size()));
+    SimdScanner::setLevel(SimdScanner::detectLevel());
+}
+
+static void BM_HttpParserScalar(benchmark::State &state) {
+    parseWithLevel(state, SimdLevel::SCALAR);
+}
+
+static void BM_HttpParserSse42(benchmark::State &state) {
+    parseWithLevel(state, SimdLevel::SSE42);
+}
+
+static void BM_HttpParserAvx2(benchmark::State &state) {
+    parseWithLevel(state, SimdLevel::AVX2);
+}
+
+// 逐字节扫描的旧式解析流程：每个字段都复制成 std::string
+static void BM_ByteByByteCopyingParser(benchmark::State &state) {
+    for (auto _: state) {
+        const std::string &bytes = BROWSER_REQUEST;
+        HttpRequest request;
+        size_t index = 0;
+        while (bytes[index] != ' ')
+            ++index;
+        request.method = bytes.substr(0, index);
+        size_t urlBegin = ++index;
+        while (bytes[index] != ' ')
+            ++index;
+        request.url = bytes.substr(urlBegin, index - urlBegin);
+        size_t versionBegin = ++index;
+        while (!(bytes[index] == '\r' && bytes[index + 1] == '\n'))
+            ++index;
+        request.version = bytes.substr(versionBegin, index - versionBegin);
+        index += 2;
+        while (!(bytes[index] == '\r' && bytes[index + 1] == '\n')) {
+            size_t begin = index, split = begin;
+            while (!(bytes[index] == '\r' && bytes[index + 1] == '\n')) {
+                if (bytes[index] == ':' && split == begin)
+                    split = index;
+                ++index;
+            }
+            request.headers.put(bytes.substr(begin, split - begin), bytes.substr(split + 2, index - split - 2));
+            index += 2;
+        }
+        benchmark::DoNotOptimize(request);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * BROWSER_REQUEST.size()));
+}
+
+static void BM_ResolveRequest(benchmark::State &state) {
+    for (auto _: state) {
+        benchmark::DoNotOptimize(HttpHandler::resolveRequest(std::string(BROWSER_REQUEST)));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * BROWSER_REQUEST.size()));
+}
+
+// 每个请求都要查找的四个头字段：按名字查找（先经过完美哈希）与直接按常见头字段查找
+static void BM_HeaderLookupByName(benchmark::State &state) {
+    HttpParser parser;
+    parser.parse(BROWSER_REQUEST);
+    const HttpRequestView &request = parser.request();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(request.header("Host"));
+        benchmark::DoNotOptimize(request.header("Connection"));
+        benchmark::DoNotOptimize(request.header("Content-Length"));
+        benchmark::DoNotOptimize(request.header("If-None-Match"));
+    }
+}
+
+static void BM_HeaderLookupKnown(benchmark::State &state) {
+    HttpParser parser;
+    parser.parse(BROWSER_REQUEST);
+    const HttpRequestView &request = parser.request();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(request.header(KnownHeader::HOST));
+        benchmark::DoNotOptimize(request.header(KnownHeader::CONNECTION));
+        benchmark::DoNotOptimize(request.header(KnownHeader::CONTENT_LENGTH));
+        benchmark::DoNotOptimize(request.header(KnownHeader::IF_NONE_MATCH));
+    }
+}
+
+BENCHMARK(BM_HttpParserScalar);
+BENCHMARK(BM_HttpParserSse42);
+BENCHMARK(BM_HttpParserAvx2);
+BENCHMARK(BM_ByteByByteCopyingParser);
+BENCHMARK(BM_ResolveRequest);
+BENCHMARK(BM_HeaderLookupByName);
+BENCHMARK(BM_HeaderLookupKnown);
@@ -0,0 +1,455 @@
+/**
+ * HTTP 负载生成器
+ *
+ * 通过回环地址向服务器重复请求 statics/ 下的页面，统计吞吐量与延迟分布，结果以 JSON 输出：
+ *
+ *   闭环模式（默认）：每个连接收到响应后立即发送下一个请求，测量服务器能承受的最大吞吐量
+ *   开环模式（--rate）：按固定速率发送请求，不受响应快慢影响，延迟从「计划发送时刻」算起，
+ *                     不会因协调遗漏（coordinated omission）而低估排队造成的尾延迟
+ *
+ * 用法：load_generator [--host 127.0.0.1] [--port 8080] [--threads 2] [--connections 16]
+ *                      [--duration 5] [--warmup 1] [--rate 0] [--paths /,/style.css]
+ *                      [--embedded [--io-uring] [--pack-assets]] [--output result.json]
+ */
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <src/histogram.hpp>
+#include <src/http_parser.hpp>
+#include <src/server.hpp>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct LoadOptions {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int threads = 2;
+    int connections = 16;
+    double durationSeconds = 5;
+    double warmupSeconds = 1;
+    double rate = 0; // 每秒请求数（所有线程合计），0 表示闭环模式
+    std::vector<std::string> paths;
+    bool embedded = false; // 在本进程中启动服务器
+
+    bool ioUring = false; // 内嵌的服务器使用 io_uring 后端
+    bool packAssets = false; // 内嵌的服务器在启动时打包 statics/ 并从映射的资源包提供
+    std::string output; // 为空时输出到标准输出
+};
+
+/**
+ * 单个线程的统计结果
+ */
+struct LoadResult {
+    Histogram latency; // 纳秒
+    uint64_t requests = 0;
+    uint64_t non2xx = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+
+    void merge(const LoadResult &other) {
+        latency.merge(other.latency);
+        requests += other.requests;
+        non2xx += other.non2xx;
+        errors += other.errors;
+        bytes += other.bytes;
+    }
+};
+
+/**
+ * 负载线程：用 epoll 驱动自己的一组持久连接
+ */
+class LoadWorker {
+public:
+    LoadWorker(const LoadOptions &options, int connections, double rate, Clock::time_point start)
+            : options_(options), rate_(rate), start_(start),
+              measureFrom_(start + toDuration(options.warmupSeconds)),
+              end_(measureFrom_ + toDuration(options.durationSeconds)) {
+        epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+        connections_.resize(connections);
+        for (size_t i = 0; i < connections_.size(); ++i) {
+            connections_[i].index = i;
+            connections_[i].nextPath = i % options_.paths.size();
+        }
+    }
+
+    ~LoadWorker() {
+        for (auto &connection: connections_) {
+            if (connection.fd >= 0)
+                close(connection.fd);
+        }
+        close(epollFd_);
+    }
+
+    void run() {
+        for (auto &connection: connections_) {
+            if (!open(connection))
+                return;
+        }
+        if (rate_ <= 0) { // 闭环：每个连接先发出一个请求
+            for (auto &connection: connections_) {
+                send(connection, Clock::now());
+            }
+        }
+
+        std::vector<epoll_event> events(connections_.size());
+        uint64_t scheduled = 0;
+        while (Clock::now() < end_) {
+            int timeoutMs = 100;
+            if (rate_ > 0) {
+                // 开环：按计划时刻发送，落后时立即补发
+                Clock::time_point now = Clock::now();
+                Clock::time_point due;
+                while ((due = start_ + toDuration(static_cast<double>(scheduled) / rate_)) <= now) {
+                    send(leastLoaded(), due);
+                    ++scheduled;
+                }
+                timeoutMs = static_cast<int>(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(due - now).count());
+            }
+
+            int n = epoll_wait(epollFd_, events.data(), static_cast<int>(events.size()), timeoutMs);
+            for (int i = 0; i < n; ++i) {
+                receive(connections_[events[i].data.u64]);
+            }
+        }
+    }
+
+    LoadResult result;
+
+private:
+    struct Connection {
+        size_t index = 0;
+        int fd = -1;
+        std::string readBuffer;
+        std::deque<Clock::time_point> pending; // 已发送、未收到响应的请求的计划时刻
+        size_t nextPath = 0;
+    };
+
+    static Clock::duration toDuration(double seconds) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    bool open(Connection &connection) {
+        connection.fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(options_.port);
+        address.sin_addr.s_addr = inet_addr(options_.host.c_str());
+        if (connect(connection.fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            std::cerr << "Fail to connect " << options_.host << ":" << options_.port << ": " << strerror(errno)
+                      << std::endl;
+            close(connection.fd);
+            connection.fd = -1;
+            return false;
+        }
+        int enable = 1;
+        setsockopt(connection.fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = connection.index;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, connection.fd, &event);
+        return true;
+    }
+
+    /**
+     * 连接被服务器关闭（如达到单连接请求数上限）时重新连接，并重发未得到响应的请求（保留计划时刻）
+     */
+    void reopen(Connection &connection) {
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, connection.fd, nullptr);
+        close(connection.fd);
+        connection.readBuffer.clear();
+        std::deque<Clock::time_point> pending;
+        pending.swap(connection.pending);
+        if (!open(connection)) {
+            result.errors += pending.size();
+            return;
+        }
+        for (auto intended: pending) {
+            send(connection, intended);
+        }
+    }
+
+    Connection &leastLoaded() {
+        Connection *best = &connections_[0];
+        for (auto &connection: connections_) {
+            if (connection.pending.size() < best->pending.size())
+                best = &connection;
+        }
+        return *best;
+    }
+
+    void send(Connection &connection, Clock::time_point intended) {
+        if (connection.fd < 0) {
+            ++result.errors;
+            return;
+        }
+        const std::string &path = options_.paths[connection.nextPath];
+        connection.nextPath = (connection.nextPath + 1) % options_.paths.size();
+
+        std::string request = "GET " + path + " HTTP/1.1\r\nHost: " + options_.host + "\r\n\r\n";
+        size_t offset = 0;
+        while (offset < request.size()) {
+            ssize_t len = ::send(connection.fd, request.data() + offset, request.size() - offset, MSG_NOSIGNAL);
+            if (len < 0 && errno == EINTR)
+                continue;
+            if (len <= 0) {
+                ++result.errors;
+                return;
+            }
+            offset += len;
+        }
+        connection.pending.push_back(intended);
+    }
+
+    void receive(Connection &connection) {
+        char buf[65536];
+        ssize_t len = recv(connection.fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (len < 0 && (errno == EAGAIN || errno == EINTR))
+            return;
+        if (len <= 0) {
+            reopen(connection);
+            return;
+        }
+        connection.readBuffer.append(buf, len);
+
+        // 依次取出完整的响应
+        while (!connection.pending.empty()) {
+            size_t headerEnd = connection.readBuffer.find("\r\n\r\n");
+            if (headerEnd == std::string::npos)
+                return;
+            std::string_view head(connection.readBuffer.data(), headerEnd);
+            size_t bodyLength = contentLength(head);
+            size_t total = headerEnd + 4 + bodyLength;
+            if (connection.readBuffer.size() < total)
+                return;
+
+            Clock::time_point now = Clock::now();
+            Clock::time_point intended = connection.pending.front();
+            connection.pending.pop_front();
+            if (now >= measureFrom_ && now < end_) {
+                result.latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - intended).count());
+                ++result.requests;
+                result.bytes += total;
+                if (head.size() < 12 || head[9] != '2')
+                    ++result.non2xx;
+            }
+            bool isClose = head.find("Connection: close") != std::string_view::npos;
+            connection.readBuffer.erase(0, total);
+
+            if (isClose) {
+                reopen(connection);
+                if (rate_ <= 0 && connection.pending.empty() && now < end_)
+                    send(connection, now);
+                return;
+            }
+            if (rate_ <= 0 && now < end_) {
+                send(connection, now);
+            }
+        }
+    }
+
+    static size_t contentLength(std::string_view head) {
+        size_t pos = 0;
+        while ((pos = head.find("\r\n", pos)) != std::string_view::npos) {
+            pos += 2;
+            std::string_view line = head.substr(pos, head.find("\r\n", pos) - pos);
+            size_t colon = line.find(':');
+            if (colon != std::string_view::npos && equalsIgnoreCase(line.substr(0, colon), "Content-Length")) {
+                size_t value = 0;
+                for (char c: line.substr(colon + 1)) {
+                    if (c >= '0' && c <= '9')
+                        value = value * 10 + (c - '0');
+                }
+                return value;
+            }
+        }
+        return 0;
+    }
+
+    const LoadOptions &options_;
+
+    double rate_;
+
+    Clock::time_point start_, measureFrom_, end_;
+
+    int epollFd_;
+
+    std::vector<Connection> connections_;
+};
+
+/**
+ * 默认请求 statics/ 下的全部 .html 与 .css 页面
+ */
+static std::vector<std::string> staticPages() {
+    std::vector<std::string> paths = {"/"};
+    if (DIR *dir = opendir("statics")) {
+        while (dirent *entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.ends_with(".html") || name.ends_with(".css"))
+                paths.push_back("/" + name);
+        }
+        closedir(dir);
+    }
+    std::sort(paths.begin() + 1, paths.end());
+    return paths;
+}
+
+static std::vector<std::string> split(const std::string &s, char delimiter) {
+    std::vector<std::string> parts;
+    size_t start = 0, end;
+    while ((end = s.find(delimiter, start)) != std::string::npos) {
+        parts.push_back(s.substr(start, end - start));
+        start = end + 1;
+    }
+    parts.push_back(s.substr(start));
+    return parts;
+}
+
+static bool parseArguments(int argc, char **argv, LoadOptions &options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc)
+                throw std::invalid_argument("missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--host") options.host = value();
+        else if (arg == "--port") options.port = std::stoi(value());
+        else if (arg == "--threads") options.threads = std::stoi(value());
+        else if (arg == "--connections") options.connections = std::stoi(value());
+        else if (arg == "--duration") options.durationSeconds = std::stod(value());
+        else if (arg == "--warmup") options.warmupSeconds = std::stod(value());
+        else if (arg == "--rate") options.rate = std::stod(value());
+        else if (arg == "--paths") options.paths = split(value(), ',');
+        else if (arg == "--embedded") options.embedded = true;
+        else if (arg == "--io-uring") options.ioUring = true;
+        else if (arg == "--pack-assets") options.packAssets = true;
+        else if (arg == "--output") options.output = value();
+        else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    if (options.paths.empty())
+        options.paths = staticPages();
+    options.threads = std::max(1, options.threads);
+    options.connections = std::max(options.threads, options.connections);
+    return true;
+}
+
+static std::string toJson(const LoadOptions &options, const LoadResult &result) {
+    const Histogram &latency = result.latency;
+    auto micros = [](uint64_t nanos) { return static_cast<double>(nanos) / 1000.0; };
+
+    std::string json = fmt::format(
+            "{{\n"
+            "  \"mode\": \"{}\",\n"
+            "  \"threads\": {},\n"
+            "  \"connections\": {},\n"
+            "  \"target_rate\": {},\n"
+            "  \"duration_seconds\": {},\n"
+            "  \"paths\": {},\n"
+            "  \"requests\": {},\n"
+            "  \"errors\": {},\n"
+            "  \"non_2xx\": {},\n"
+            "  \"requests_per_second\": {:.1f},\n"
+            "  \"bytes_per_second\": {:.1f},\n"
+            "  \"latency_us\": {{\"min\": {:.1f}, \"mean\": {:.1f}, \"p50\": {:.1f}, \"p90\": {:.1f}, "
+            "\"p99\": {:.1f}, \"p99_9\": {:.1f}, \"p99_99\": {:.1f}, \"max\": {:.1f}}},\n",
+            options.rate > 0 ? "open" : "closed", options.threads, options.connections, options.rate,
+            options.durationSeconds, options.paths.size(), result.requests, result.errors, result.non2xx,
+            static_cast<double>(result.requests) / options.durationSeconds,
+            static_cast<double>(result.bytes) / options.durationSeconds,
+            micros(latency.min()), latency.mean() / 1000.0, micros(latency.valueAtPercentile(50)),
+            micros(latency.valueAtPercentile(90)), micros(latency.valueAtPercentile(99)),
+            micros(latency.valueAtPercentile(99.9)), micros(latency.valueAtPercentile(99.99)),
+            micros(latency.max()));
+
+    // HDR 风格的百分位分布：每一级把剩余的比例减半
+    json += "  \"latency_distribution\": [\n";
+    double percentile = 0;
+    for (int step = 0;; ++step) {
+        json += fmt::format("    {{\"percentile\": {:.6f}, \"value_us\": {:.1f}}}", percentile,
+                            micros(latency.valueAtPercentile(percentile)));
+        if (step == 20 || latency.count() == 0 ||
+            (100 - percentile) * static_cast<double>(latency.count()) < 100) {
+            json += fmt::format(",\n    {{\"percentile\": 100.000000, \"value_us\": {:.1f}}}\n",
+                                micros(latency.max()));
+            break;
+        }
+        json += ",\n";
+        percentile += (100 - percentile) / 2;
+    }
+    json += "  ]\n}\n";
+    return json;
+}
+
+int main(int argc, char **argv) {
+    LoadOptions options;
+    try {
+        if (!parseArguments(argc, argv, options))
+            return 1;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<Server> server;
+    std::thread serverThread;
+    if (options.embedded) {
+        LogLevel level = LogLevel::ERROR;
+        auto formatter = std::make_shared<LogFormatter>(level);
+        Logger logger(level, std::make_shared<TerminalLogAppender>(formatter, level));
+        ServerOptions serverOptions;
+        serverOptions.ioBackend = options.ioUring ? IoBackend::IO_URING : IoBackend::EPOLL;
+        serverOptions.packAssetsOnStartup = options.packAssets;
+        server = std::make_unique<Server>(options.host, options.port, logger, serverOptions);
+        serverThread = std::thread([&server]() { server->setup(); });
+    }
+
+    Clock::time_point start = Clock::now() + std::chrono::milliseconds(50);
+    std::vector<std::unique_ptr<LoadWorker>> workers;
+    for (int i = 0; i < options.threads; ++i) {
+        int connections = options.connections / options.threads + (i < options.connections % options.threads);
+        workers.push_back(std::make_unique<LoadWorker>(options, connections, options.rate / options.threads, start));
+    }
+    std::this_thread::sleep_until(start);
+    std::vector<std::thread> threads;
+    for (auto &worker: workers) {
+        threads.emplace_back([&worker]() { worker->run(); });
+    }
+    LoadResult total;
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+        total.merge(workers[i]->result);
+    }
+
+    if (server) {
+        server->shutdown();
+        serverThread.join();
+    }
+
+    std::string json = toJson(options, total);
+    if (options.output.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream(options.output) << json;
+    }
+    return total.requests > 0 ? 0 : 1;
+}
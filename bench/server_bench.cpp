@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+
+#include <src/asset_cache.hpp>
+#include <src/file_util.hpp>
+#include <src/http_handler.hpp>
+#include <src/thread_pool.hpp>
+
+// 需要在仓库根目录下运行（读取 statics/）
+
+static const std::string SIMPLE_REQUEST =
+        "GET /index.html HTTP/1.1\r\nHost: 127.0.0.1:8080\r\nConnection: keep-alive\r\n"
+        "Accept: text/html\r\n\r\n";
+
+static void BM_ResolveSimpleRequest(benchmark::State &state) {
+    for (auto _: state) {
+        benchmark::DoNotOptimize(HttpHandler::resolveRequest(std::string(SIMPLE_REQUEST)));
+    }
+}
+
+BENCHMARK(BM_ResolveSimpleRequest);
+
+static void BM_SerializeResponse(benchmark::State &state) {
+    std::string body(static_cast<size_t>(state.range(0)), 'x');
+    for (auto _: state) {
+        HttpHeaders headers;
+        headers.put("Content-Type", "text/html; charset=utf-8");
+        headers.put("Connection", "keep-alive");
+        benchmark::DoNotOptimize(
+                HttpHandler::serializeResponse(HttpResponse("HTTP/1.1", "200", "OK", std::move(headers), body)));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * body.size()));
+}
+
+BENCHMARK(BM_SerializeResponse)->Arg(0)->Arg(4096)->Arg(64 * 1024);
+
+// 外部线程提交任务并等待结果：一次完整的派发与唤醒往返
+static void BM_ThreadPoolSubmitRoundTrip(benchmark::State &state) {
+    ThreadPool &pool = getThreadPool();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(pool.submit([](int x) { return x + 1; }, 1).get());
+    }
+}
+
+BENCHMARK(BM_ThreadPoolSubmitRoundTrip)->UseRealTime();
+
+// 批量提交：衡量提交路径本身的吞吐量
+static void BM_ThreadPoolSubmitBatch(benchmark::State &state) {
+    ThreadPool &pool = getThreadPool();
+    std::vector<std::future<void>> futures;
+    futures.reserve(state.range(0));
+    for (auto _: state) {
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            futures.push_back(pool.submit([]() {}));
+        }
+        for (auto &future: futures) {
+            future.get();
+        }
+        futures.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ThreadPoolSubmitBatch)->Arg(1024)->UseRealTime();
+
+static void BM_ThreadPoolPostBatch(benchmark::State &state) {
+    ThreadPool &pool = getThreadPool();
+    std::atomic<int64_t> done(0);
+    for (auto _: state) {
+        done.store(0, std::memory_order_relaxed);
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            pool.post([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+        }
+        while (done.load(std::memory_order_acquire) != state.range(0)) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ThreadPoolPostBatch)->Arg(1024)->UseRealTime();
+
+static void BM_GetStaticResource(benchmark::State &state) {
+    if (!FileUtil::getStaticResource("index.html").second) {
+        state.SkipWithError("statics/index.html not found, run from the repository root");
+        return;
+    }
+    for (auto _: state) {
+        benchmark::DoNotOptimize(FileUtil::getStaticResource("index.html"));
+    }
+}
+
+BENCHMARK(BM_GetStaticResource);
+
+// 对照：同一文件从静态资源缓存中获取
+static void BM_AssetCacheHit(benchmark::State &state) {
+    AssetCache cache;
+    if (!cache.get("index.html")) {
+        state.SkipWithError("statics/index.html not found, run from the repository root");
+        return;
+    }
+    for (auto _: state) {
+        benchmark::DoNotOptimize(cache.get("index.html"));
+    }
+}
+
+BENCHMARK(BM_AssetCacheHit);
@@ -0,0 +1,120 @@
+#ifndef WEBSERVER_ADMISSION_CONTROL_HPP
+#define WEBSERVER_ADMISSION_CONTROL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 并发上限的准入控制（AIMD）
+ *
+ * 进入线程池（排队与执行中）的请求数不超过当前的并发上限，超过时拒绝，由调用方立即回应 503；
+ * 上限由请求在线程池中的排队时间驱动：排队时间超过目标说明工作线程已经饱和，上限乘以 DECREASE_FACTOR
+ * （每个目标时长内最多降低一次，同一阵拥塞只计一次）；否则在上限确实被用到一半以上时加 1 / 上限，
+ * 即每处理约一个上限的请求加 1，逐步探回 maxLimit
+ *
+ * tryAcquire() 只由一个线程（分片的事件循环线程）调用，release() 可由任意工作线程调用
+ */
+class AdmissionController {
+public:
+    static constexpr double DECREASE_FACTOR = 0.9;
+
+    /**
+     * @param maxLimit 并发上限的最大值（也是初始值），为 0 时不限制
+     * @param targetWait 排队时间的目标，为 0 时并发上限固定为 maxLimit
+     * @param minLimit 并发上限的最小值，降低后仍保证一定的吞吐量
+     */
+    explicit AdmissionController(size_t maxLimit = 0, std::chrono::nanoseconds targetWait = {}, size_t minLimit = 1)
+            : maxLimit_(static_cast<double>(maxLimit)), minLimit_(static_cast<double>(std::min(minLimit, maxLimit))),
+              targetWait_(targetWait), limit_(static_cast<double>(maxLimit)) {}
+
+    AdmissionController(const AdmissionController &) = delete;
+
+    AdmissionController &operator=(const AdmissionController &) = delete;
+
+    /**
+     * 请求进入线程池之前调用
+     *
+     * @return 是否接受，接受的请求处理完后必须调用 release()
+     */
+    bool tryAcquire() {
+        size_t inFlight = inFlight_.load(std::memory_order_relaxed);
+        if (maxLimit_ > 0 && static_cast<double>(inFlight) >= limit_.load(std::memory_order_relaxed)) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        inFlight_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * 请求处理完后调用，以它在线程池中的排队时间调整并发上限
+     */
+    void release(std::chrono::nanoseconds queueWait) {
+        size_t inFlight = inFlight_.fetch_sub(1, std::memory_order_relaxed);
+        if (maxLimit_ == 0 || targetWait_.count() == 0)
+            return;
+
+        if (queueWait > targetWait_) {
+            int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+            int64_t last = lastDecrease_.load(std::memory_order_relaxed);
+            if (now - last < std::chrono::duration_cast<std::chrono::steady_clock::duration>(targetWait_).count() ||
+                !lastDecrease_.compare_exchange_strong(last, now, std::memory_order_relaxed))
+                return;
+            update([this](double limit) { return std::max(minLimit_, limit * DECREASE_FACTOR); });
+        } else {
+            update([this, inFlight](double limit) {
+                if (static_cast<double>(inFlight) * 2 < limit) // 上限没有被用到时不增加，避免空闲时无限增长
+                    return limit;
+                return std::min(maxLimit_, limit + 1 / limit);
+            });
+        }
+    }
+
+    /**
+     * 当前的并发上限（不限制时为 0）
+     */
+    size_t limit() const {
+        return static_cast<size_t>(limit_.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * 已接受、尚未处理完的请求数
+     */
+    size_t inFlight() const {
+        return inFlight_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * 被拒绝的请求数
+     */
+    size_t rejected() const {
+        return rejected_.load(std::memory_order_relaxed);
+    }
+
+private:
+    template<typename F>
+    void update(F &&next) {
+        double limit = limit_.load(std::memory_order_relaxed);
+        while (!limit_.compare_exchange_weak(limit, next(limit), std::memory_order_relaxed)) {
+        }
+    }
+
+    const double maxLimit_;
+
+    const double minLimit_;
+
+    const std::chrono::nanoseconds targetWait_;
+
+    std::atomic<double> limit_;
+
+    std::atomic<size_t> inFlight_{0};
+
+    std::atomic<size_t> rejected_{0};
+
+    std::atomic<int64_t> lastDecrease_{0}; // 上次降低上限的时间（steady_clock 的计数）
+};
+
+#endif //WEBSERVER_ADMISSION_CONTROL_HPP
@@ -0,0 +1,708 @@
+#ifndef WEBSERVER_ASSET_CACHE_HPP
+#define WEBSERVER_ASSET_CACHE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <src/content_encoding.hpp>
+#include <src/file_util.hpp>
+#include <src/response_writer.hpp>
+#include <string>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * 静态资源（加载后不可变，可被多个连接同时引用）
+ */
+class Asset {
+public:
+    std::string path; // 规范化后的路径（相对于静态资源根目录）
+
+    std::string body; // 内存中的内容（大文件为空，改用 file；资源包中的资源为空，改用 mapped）
+
+    std::shared_ptr<const FileHandle> file; // 大文件保持打开，通过 sendfile 发送
+
+    std::string_view mapped; // 资源包中的资源：只读映射中的内容
+
+    std::shared_ptr<const void> mapping; // 资源包的映射，保证 mapped 有效
+
+    size_t size = 0; // 文件大小
+
+    std::string contentType;
+
+    ContentEncoding encoding = ContentEncoding::IDENTITY; // 响应体的内容编码
+
+    std::string headerFields; // 预先生成的 Content-Type、Content-Length 等头字段（每个都以 CRLF 结尾）
+
+    std::string etag; // 强实体标签（带引号），由修改时间、大小与编码生成，每个版本只生成一次
+
+    std::string validatorFields; // 预先生成的 ETag、Last-Modified 与 Accept-Ranges 头字段
+
+    struct timespec modifiedTime{}; // 原文件的修改时间（压缩版本与原文件相同）
+
+    struct timespec fileModifiedTime{}; // 预压缩文件自己的修改时间（不早于原文件），其他版本为空
+
+    bool isNegotiable = false; // 是否存在其他编码的版本
+
+    bool isFileBacked() const {
+        return file != nullptr;
+    }
+
+    /**
+     * 内存中（或映射中）的内容，大文件为空
+     */
+    std::string_view content() const {
+        return mapping ? mapped : std::string_view(body);
+    }
+
+    /**
+     * 生成 headerFields、etag 与 validatorFields
+     *
+     * @param negotiable 是否存在其他编码的版本，是时加上 Vary: Accept-Encoding，让中间缓存区分不同的编码
+     */
+    void buildHeaderFields(bool negotiable) {
+        isNegotiable = negotiable;
+        ResponseWriter writer(headerFields);
+        writer.header(HttpHeader::CONTENT_TYPE, contentType).header(HttpHeader::CONTENT_LENGTH, size);
+        if (encoding != ContentEncoding::IDENTITY)
+            writer.header(HttpHeader::CONTENT_ENCODING, ContentCoding::name(encoding));
+        if (isNegotiable)
+            writer.header(HttpHeader::VARY, "Accept-Encoding");
+
+        // 与 nginx 相同的形式 "修改时间-大小"，不同编码的版本内容不同，再加上编码名；
+        // 预压缩文件用自己的修改时间，只重新生成它时实体标签也会改变
+        const struct timespec &versionTime = fileModifiedTime.tv_sec != 0 ? fileModifiedTime : modifiedTime;
+        etag = "\"";
+        appendHex(etag, versionTime.tv_sec);
+        etag += '.';
+        appendHex(etag, versionTime.tv_nsec);
+        etag += '-';
+        appendHex(etag, size);
+        if (encoding != ContentEncoding::IDENTITY)
+            etag.append("-").append(ContentCoding::name(encoding));
+        etag += '"';
+        ResponseWriter(validatorFields)
+                .header(HttpHeader::ETAG, etag)
+                .header(HttpHeader::LAST_MODIFIED, CachedClock::httpDate(modifiedTime.tv_sec))
+                .header(HttpHeader::ACCEPT_RANGES, "bytes");
+    }
+
+    /**
+     * 根据扩展名推断 Content-Type
+     */
+    static std::string contentTypeOf(std::string_view path) {
+        static const std::unordered_map<std::string_view, std::string_view> types = {
+                {"html", "text/html; charset=utf-8"},
+                {"htm",  "text/html; charset=utf-8"},
+                {"css",  "text/css; charset=utf-8"},
+                {"js",   "application/javascript; charset=utf-8"},
+                {"json", "application/json"},
+                {"txt",  "text/plain; charset=utf-8"},
+                {"jpg",  "image/jpeg"},
+                {"jpeg", "image/jpeg"},
+                {"png",  "image/png"},
+                {"gif",  "image/gif"},
+                {"svg",  "image/svg+xml"},
+                {"ico",  "image/x-icon"},
+        };
+        size_t dot = path.rfind('.');
+        if (dot != std::string_view::npos) {
+            if (auto it = types.find(path.substr(dot + 1)); it != types.end())
+                return std::string(it->second);
+        }
+        return "application/octet-stream";
+    }
+
+private:
+    static void appendHex(std::string &text, uint64_t value) {
+        char digits[16];
+        auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value, 16);
+        text.append(digits, end - digits);
+    }
+};
+
+/**
+ * 不存在的路径的记录：容量固定的 FIFO，按路径的 64 位哈希查找
+ *
+ * 记录排成一个环，满了之后覆盖最早确认的一条，重新确认的路径移到最新的位置；索引是线性探测的开放寻址表，
+ * 删除时把探测链上后面的项前移，不留墓碑。记录与索引在构造时一次分配，之后记录、查找与淘汰都不分配内存。
+ * 只保存哈希而不保存路径，两条路径哈希相同时，存在的文件也可能在一个校验间隔内被当作不存在
+ *
+ * 不是线程安全的，由调用方加锁
+ */
+class AbsentPaths {
+public:
+    explicit AbsentPaths(size_t capacity)
+            : records_(std::max<size_t>(capacity, 1)), index_(std::bit_ceil(records_.size() * 2), EMPTY),
+              mask_(index_.size() - 1) {}
+
+    /**
+     * @return 确认 hash 对应的路径不存在的时间，没有记录时为空
+     */
+    const std::chrono::steady_clock::time_point *find(uint64_t hash) const {
+        uint32_t record = index_[locate(hash)];
+        return record == EMPTY ? nullptr : &records_[record].confirmedAt;
+    }
+
+    /**
+     * 记录（或重新确认）不存在的路径，已满时先淘汰最早确认的一条
+     */
+    void insert(uint64_t hash, std::chrono::steady_clock::time_point now) {
+        erase(hash);
+        if (records_[next_].isUsed)
+            erase(records_[next_].hash);
+        records_[next_] = {hash, now, true};
+        index_[locate(hash)] = next_;
+        next_ = next_ + 1 == records_.size() ? 0 : next_ + 1;
+        ++size_;
+    }
+
+    void erase(uint64_t hash) {
+        size_t hole = locate(hash);
+        if (index_[hole] == EMPTY)
+            return;
+        records_[index_[hole]].isUsed = false;
+        --size_;
+        // 探测链上后面的项只有在 hole 位于它的起始位置与当前位置之间时才能前移到 hole，否则从起始位置探测不到它
+        for (size_t i = (hole + 1) & mask_; index_[i] != EMPTY; i = (i + 1) & mask_) {
+            size_t home = homeOf(records_[index_[i]].hash);
+            if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+                index_[hole] = index_[i];
+                hole = i;
+            }
+        }
+        index_[hole] = EMPTY;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    size_t capacity() const {
+        return records_.size();
+    }
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    struct Record {
+        uint64_t hash = 0;
+        std::chrono::steady_clock::time_point confirmedAt;
+        bool isUsed = false;
+    };
+
+    size_t homeOf(uint64_t hash) const {
+        // 同一分片的哈希低位相同，乘以黄金比例常数后用高位定位
+        return static_cast<size_t>((hash * 0x9e3779b97f4a7c15) >> 32) & mask_;
+    }
+
+    /**
+     * hash 所在的索引位置，不存在时为探测链末尾的空位
+     */
+    size_t locate(uint64_t hash) const {
+        size_t i = homeOf(hash);
+        while (index_[i] != EMPTY && records_[index_[i]].hash != hash) {
+            i = (i + 1) & mask_;
+        }
+        return i;
+    }
+
+    std::vector<Record> records_; // 按确认的先后排成环
+
+    std::vector<uint32_t> index_; // 记录的下标，容量至少是记录数的两倍
+
+    size_t mask_;
+
+    uint32_t next_ = 0; // 下一条记录写入的位置，也是最早确认的一条
+
+    size_t size_ = 0;
+};
+
+/**
+ * 并发的静态资源缓存
+ *
+ * 以规范化路径为键，按路径哈希分片，每个分片一把锁、一条 LRU 链表，总内存不超过 capacity；
+ * 命中时不做任何文件 I/O，只在距上次校验超过 revalidateInterval 后用 stat() 检查修改时间；
+ * 不存在的路径同样记录一段时间（每个分片最多 MAX_ABSENT_PER_SHARD 个，见 AbsentPaths），重复请求不存在的 URL 时
+ * 不再访问文件系统；
+ * 不小于 fileBackedThreshold 的文件不读入内存，只缓存打开的文件描述符与响应头
+ *
+ * 每个资源可以有多个内容编码的版本，按请求的 Accept-Encoding 选择：加载时一并读取不早于原文件的预压缩文件
+ * （style.css.gz、style.css.br），没有预压缩文件的文本资源交给 compressor 在后台压缩一次，完成后加入缓存，
+ * 之后的请求不再消耗压缩的 CPU。各版本与原文件一起校验、淘汰
+ */
+class AssetCache {
+public:
+    /**
+     * 执行后台任务的方式（如提交到线程池）
+     */
+    using Executor = std::function<void(std::function<void()>)>;
+
+    static constexpr size_t MIN_COMPRESS_SIZE = 256; // 更小的资源压缩后节省的字节数抵不上额外的头字段
+
+    /**
+     * 一个资源的各个编码版本，下标为 ContentEncoding，原始内容总是存在，其他版本可能为空
+     */
+    using Variants = std::array<std::shared_ptr<const Asset>, ContentCoding::COUNT>;
+
+    /**
+     * @param compressor 执行压缩任务的方式，为空时不在服务器中压缩，只使用预压缩文件
+     */
+    explicit AssetCache(std::string root = "statics/", size_t capacity = 64 * 1024 * 1024,
+                        std::chrono::milliseconds revalidateInterval = std::chrono::seconds(1),
+                        size_t fileBackedThreshold = 256 * 1024, Executor compressor = nullptr)
+            : root_(std::move(root)), shardCapacity_(capacity / SHARDS),
+              revalidateInterval_(revalidateInterval), fileBackedThreshold_(fileBackedThreshold),
+              compressor_(std::move(compressor)) {}
+
+    AssetCache(const AssetCache &) = delete;
+
+    AssetCache &operator=(const AssetCache &) = delete;
+
+    /**
+     * 等待仍在进行的压缩任务结束（任务引用着缓存）
+     */
+    ~AssetCache() {
+        std::unique_lock<std::mutex> lock(pendingMutex_);
+        pendingDone_.wait(lock, [this]() { return pendingCompressions_ == 0; });
+    }
+
+    /**
+     * 获取资源
+     *
+     * @param path 规范化后的路径
+     * @param accept 请求可以接受的内容编码，默认只接受原始内容
+     * @return 资源（可接受的版本中权重最高、压缩率最高的一个），不存在（或不是普通文件）时为空
+     */
+    std::shared_ptr<const Asset> get(const std::string &path, const AcceptEncoding &accept = AcceptEncoding()) {
+        uint64_t hash = std::hash<std::string>()(path);
+        Shard &shard = shards_[hash % SHARDS];
+        auto now = std::chrono::steady_clock::now();
+
+        Variants cached;
+        Siblings siblings;
+        {
+            const std::lock_guard<std::mutex> lockGuard(shard.mutex);
+            if (auto it = shard.index.find(path); it != shard.index.end()) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                Entry &entry = *it->second;
+                if (now - entry.validatedAt < revalidateInterval_) {
+                    hits_.fetch_add(1, std::memory_order_relaxed);
+                    return select(entry.variants, accept);
+                }
+                cached = entry.variants;
+                siblings = entry.siblings;
+                entry.validatedAt = now;
+            } else if (const auto *confirmedAt = shard.absent.find(hash);
+                    confirmedAt != nullptr && now - *confirmedAt < revalidateInterval_) {
+                negativeHits_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+
+        // 缓存的资源需要校验：原文件与预压缩文件的修改时间与大小都未变时继续使用
+        if (cached[0]) {
+            struct stat st{};
+            std::array<char, PATH_MAX> fullPath;
+            if (resolve(path, fullPath) && ::stat(fullPath.data(), &st) == 0 && sameVersion(st, *cached[0]) &&
+                sameSiblings(path, siblings)) {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return select(cached, accept);
+            }
+        }
+
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        Variants variants = load(path, siblings);
+        if (!variants[0]) {
+            if (cached[0])
+                erase(shard, path);
+            rememberAbsent(shard, hash, now);
+            return nullptr;
+        }
+        insert(shard, variants, siblings, now);
+        compressInBackground(shard, variants);
+        return select(variants, accept);
+    }
+
+    /**
+     * 选择可接受的版本中权重最高的，权重相同时选择压缩率更高的编码；都不可接受时仍返回原始内容
+     */
+    static std::shared_ptr<const Asset> select(const Variants &variants, const AcceptEncoding &accept) {
+        size_t best = 0;
+        uint16_t bestQuality = accept.quality(ContentEncoding::IDENTITY);
+        for (size_t i = 1; i < ContentCoding::COUNT; ++i) {
+            uint16_t quality = accept.quality(ContentCoding::ALL[i]);
+            if (variants[i] && quality > 0 && quality >= bestQuality) {
+                best = i;
+                bestQuality = quality;
+            }
+        }
+        return variants[best];
+    }
+
+    size_t hits() const {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    size_t misses() const {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * 由不存在路径的记录直接回答、没有访问文件系统的查找次数
+     */
+    size_t negativeHits() const {
+        return negativeHits_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * 当前缓存占用的字节数
+     */
+    size_t usage() {
+        size_t bytes = 0;
+        for (auto &shard: shards_) {
+            const std::lock_guard<std::mutex> lockGuard(shard.mutex);
+            bytes += shard.bytes;
+        }
+        return bytes;
+    }
+
+    static constexpr size_t MAX_ABSENT_PER_SHARD = 1024;
+
+private:
+    static constexpr size_t SHARDS = 16;
+
+    /**
+     * 文件在加载时的修改时间与大小，用于校验
+     */
+    struct FileVersion {
+        bool exists = false;
+        struct timespec modifiedTime{};
+        size_t size = 0;
+    };
+
+    /**
+     * 各编码的预压缩文件在加载时的版本（包括比原文件旧而没有使用的），下标 0 不使用
+     */
+    using Siblings = std::array<FileVersion, ContentCoding::COUNT>;
+
+    struct Entry {
+        Variants variants;
+        Siblings siblings;
+        std::chrono::steady_clock::time_point validatedAt;
+        size_t bytes; // 全部版本占用的字节数
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru; // 表头最近使用
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        AbsentPaths absent{MAX_ABSENT_PER_SHARD}; // 不存在的路径与确认的时间
+        size_t bytes = 0;
+    };
+
+    static bool sameVersion(const struct stat &st, const Asset &asset) {
+        return st.st_mtim.tv_sec == asset.modifiedTime.tv_sec && st.st_mtim.tv_nsec == asset.modifiedTime.tv_nsec &&
+               static_cast<size_t>(st.st_size) == asset.size;
+    }
+
+    static bool sameVersion(const struct stat &st, const FileVersion &version) {
+        return st.st_mtim.tv_sec == version.modifiedTime.tv_sec &&
+               st.st_mtim.tv_nsec == version.modifiedTime.tv_nsec && static_cast<size_t>(st.st_size) == version.size;
+    }
+
+    /**
+     * 预压缩文件是否与加载时相同（重新生成、新增或删除都需要重新加载）
+     */
+    bool sameSiblings(const std::string &path, const Siblings &siblings) const {
+        for (size_t i = 1; i < ContentCoding::COUNT; ++i) {
+            struct stat st{};
+            std::array<char, PATH_MAX> fullPath;
+            bool exists = resolve(path, fullPath, ContentCoding::extension(ContentCoding::ALL[i])) &&
+                          ::stat(fullPath.data(), &st) == 0 && S_ISREG(st.st_mode);
+            if (exists != siblings[i].exists || (exists && !sameVersion(st, siblings[i])))
+                return false;
+        }
+        return true;
+    }
+
+    static size_t footprint(const Asset &asset) {
+        return asset.body.size() + asset.path.size() * 2 + asset.headerFields.size();
+    }
+
+    static size_t footprint(const Variants &variants) {
+        size_t bytes = 0;
+        for (const auto &variant: variants) {
+            if (variant)
+                bytes += footprint(*variant);
+        }
+        return bytes;
+    }
+
+    /**
+     * 是否会在后台压缩该资源（内存中的文本资源）
+     */
+    bool isCompressible(const Asset &asset) const {
+        return compressor_ && !asset.isFileBacked() && asset.size >= MIN_COMPRESS_SIZE &&
+               ContentCoding::isCompressible(asset.contentType) &&
+               (ContentCoding::canCompress(ContentEncoding::GZIP) || ContentCoding::canCompress(ContentEncoding::BROTLI));
+    }
+
+    /**
+     * 资源在文件系统中的路径写入 buffer（校验与查找不存在的文件时不分配堆内存）
+     *
+     * @param extension 追加在路径后的扩展名，如预压缩文件的 .gz
+     * @return 路径是否没有超过长度限制
+     */
+    bool resolve(const std::string &path, std::array<char, PATH_MAX> &buffer, std::string_view extension = {}) const {
+        size_t length = root_.size() + path.size() + extension.size();
+        if (length >= buffer.size())
+            return false;
+        std::memcpy(buffer.data(), root_.data(), root_.size());
+        std::memcpy(buffer.data() + root_.size(), path.data(), path.size());
+        std::copy(extension.begin(), extension.end(), buffer.data() + root_.size() + path.size());
+        buffer[length] = '\0';
+        return true;
+    }
+
+    /**
+     * 从磁盘加载资源与不早于它的预压缩文件，并生成响应头
+     *
+     * @param siblings 记录预压缩文件的版本，供之后校验
+     */
+    Variants load(const std::string &path, Siblings &siblings) const {
+        Variants variants;
+        siblings = {};
+        std::shared_ptr<Asset> asset = loadFile(path);
+        if (!asset)
+            return variants;
+        asset->contentType = Asset::contentTypeOf(path);
+
+        bool isNegotiable = isCompressible(*asset);
+        for (size_t i = 1; i < ContentCoding::COUNT; ++i) {
+            ContentEncoding encoding = ContentCoding::ALL[i];
+            std::shared_ptr<Asset> sibling = loadFile(path + std::string(ContentCoding::extension(encoding)));
+            if (!sibling)
+                continue;
+            siblings[i] = {true, sibling->modifiedTime, sibling->size};
+            if (isOlder(sibling->modifiedTime, asset->modifiedTime)) // 原文件修改后没有重新压缩
+                continue;
+            sibling->path = path;
+            sibling->contentType = asset->contentType;
+            sibling->encoding = encoding;
+            sibling->fileModifiedTime = sibling->modifiedTime;
+            sibling->modifiedTime = asset->modifiedTime;
+            sibling->buildHeaderFields(true);
+            variants[i] = std::move(sibling);
+            isNegotiable = true;
+        }
+        asset->buildHeaderFields(isNegotiable);
+        variants[0] = std::move(asset);
+        return variants;
+    }
+
+    /**
+     * 读取文件（大文件只保持打开），不生成响应头
+     */
+    std::shared_ptr<Asset> loadFile(const std::string &path) const {
+        std::array<char, PATH_MAX> fullPath;
+        int fd = resolve(path, fullPath) ? open(fullPath.data(), O_RDONLY | O_CLOEXEC) : -1;
+        if (fd < 0)
+            return nullptr;
+
+        auto asset = std::make_shared<Asset>();
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            close(fd);
+            return nullptr;
+        }
+
+        if (static_cast<size_t>(st.st_size) >= fileBackedThreshold_) {
+            asset->file = std::make_shared<FileHandle>(fd);
+            asset->size = st.st_size;
+        } else {
+            asset->body.resize(st.st_size);
+            size_t offset = 0;
+            while (offset < asset->body.size()) {
+                ssize_t len = read(fd, asset->body.data() + offset, asset->body.size() - offset);
+                if (len < 0 && errno == EINTR)
+                    continue;
+                if (len <= 0)
+                    break;
+                offset += len;
+            }
+            close(fd);
+            asset->body.resize(offset); // 读取期间文件被截断
+            asset->size = offset;
+        }
+
+        asset->path = path;
+        asset->modifiedTime = st.st_mtim;
+        return asset;
+    }
+
+    static bool isOlder(const struct timespec &a, const struct timespec &b) {
+        return a.tv_sec < b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec);
+    }
+
+    /**
+     * 没有预压缩文件的编码交给 compressor 压缩，完成后加入缓存中的同一项（期间资源被替换或淘汰时丢弃结果）
+     */
+    void compressInBackground(Shard &shard, const Variants &variants) {
+        const std::shared_ptr<const Asset> &source = variants[0];
+        if (!isCompressible(*source))
+            return;
+        std::array<bool, ContentCoding::COUNT> missing{};
+        bool hasMissing = false;
+        for (size_t i = 1; i < ContentCoding::COUNT; ++i) {
+            missing[i] = !variants[i] && ContentCoding::canCompress(ContentCoding::ALL[i]);
+            hasMissing = hasMissing || missing[i];
+        }
+        if (!hasMissing)
+            return;
+
+        {
+            const std::lock_guard<std::mutex> lockGuard(pendingMutex_);
+            ++pendingCompressions_;
+        }
+        compressor_([this, &shard, source, missing]() {
+            Variants compressed;
+            for (size_t i = 1; i < ContentCoding::COUNT; ++i) {
+                if (!missing[i])
+                    continue;
+                auto variant = std::make_shared<Asset>();
+                // 压缩后没有变小时不使用
+                if (!ContentCoding::compress(ContentCoding::ALL[i], source->body, variant->body) ||
+                    variant->body.size() >= source->body.size())
+                    continue;
+                variant->path = source->path;
+                variant->size = variant->body.size();
+                variant->contentType = source->contentType;
+                variant->encoding = ContentCoding::ALL[i];
+                variant->modifiedTime = source->modifiedTime;
+                variant->buildHeaderFields(true);
+                compressed[i] = std::move(variant);
+            }
+            attach(shard, source, compressed);
+
+            const std::lock_guard<std::mutex> lockGuard(pendingMutex_);
+            --pendingCompressions_;
+            pendingDone_.notify_all();
+        });
+    }
+
+    /**
+     * 把压缩好的版本加入原始内容仍为 source 的缓存项
+     */
+    void attach(Shard &shard, const std::shared_ptr<const Asset> &source, const Variants &compressed) {
+        const std::lock_guard<std::mutex> lockGuard(shard.mutex);
+        auto it = shard.index.find(source->path);
+        if (it == shard.index.end() || it->second->variants[0] != source)
+            return;
+        Entry &entry = *it->second;
+        for (size_t i = 1; i < ContentCoding::COUNT; ++i) {
+            if (!compressed[i] || entry.variants[i])
+                continue;
+            size_t bytes = footprint(*compressed[i]);
+            if (entry.bytes + bytes > shardCapacity_)
+                continue;
+            entry.variants[i] = compressed[i];
+            entry.bytes += bytes;
+            shard.bytes += bytes;
+        }
+        evict(shard, 0);
+    }
+
+    void insert(Shard &shard, const Variants &variants, const Siblings &siblings,
+                std::chrono::steady_clock::time_point now) {
+        size_t bytes = footprint(variants);
+        // 超过分片容量的资源不缓存，每次从磁盘读取
+        if (bytes > shardCapacity_)
+            return;
+
+        const std::lock_guard<std::mutex> lockGuard(shard.mutex);
+        const std::string &path = variants[0]->path;
+        if (auto it = shard.index.find(path); it != shard.index.end()) {
+            shard.bytes -= it->second->bytes;
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+        shard.absent.erase(std::hash<std::string>()(path));
+        evict(shard, bytes);
+        shard.lru.push_front({variants, siblings, now, bytes});
+        shard.index.emplace(path, shard.lru.begin());
+        shard.bytes += bytes;
+    }
+
+    /**
+     * 从最久未使用的一端淘汰，直到能再放入 incoming 字节（调用方持有分片的锁）
+     */
+    void evict(Shard &shard, size_t incoming) const {
+        while (!shard.lru.empty() && shard.bytes + incoming > shardCapacity_) {
+            Entry &victim = shard.lru.back();
+            shard.bytes -= victim.bytes;
+            shard.index.erase(victim.variants[0]->path);
+            shard.lru.pop_back();
+        }
+    }
+
+    /**
+     * 记录不存在的路径；记录已满时淘汰最早确认的一条（大量不同的路径只会互相替换，不会占用更多内存）
+     */
+    static void rememberAbsent(Shard &shard, uint64_t hash, std::chrono::steady_clock::time_point now) {
+        const std::lock_guard<std::mutex> lockGuard(shard.mutex);
+        shard.absent.insert(hash, now);
+    }
+
+    static void erase(Shard &shard, const std::string &path) {
+        const std::lock_guard<std::mutex> lockGuard(shard.mutex);
+        if (auto it = shard.index.find(path); it != shard.index.end()) {
+            shard.bytes -= it->second->bytes;
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+    }
+
+    std::string root_;
+
+    size_t shardCapacity_;
+
+    std::chrono::milliseconds revalidateInterval_;
+
+    size_t fileBackedThreshold_;
+
+    Executor compressor_;
+
+    std::array<Shard, SHARDS> shards_;
+
+    std::mutex pendingMutex_;
+
+    std::condition_variable pendingDone_;
+
+    size_t pendingCompressions_ = 0; // 已提交、尚未结束的压缩任务数
+
+    std::atomic<size_t> hits_{0};
+
+    std::atomic<size_t> misses_{0};
+
+    std::atomic<size_t> negativeHits_{0};
+};
+
+#endif //WEBSERVER_ASSET_CACHE_HPP
@@ -0,0 +1,402 @@
+#ifndef WEBSERVER_ASSET_PACK_HPP
+#define WEBSERVER_ASSET_PACK_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <src/asset_cache.hpp>
+#include <src/content_encoding.hpp>
+#include <src/perfect_hash.hpp>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/**
+ * 只读映射的静态资源包
+ *
+ * 把静态资源目录整个打包成一个不可变的文件（启动时或构建时用 pack_assets 生成），运行时用 mmap 映射：
+ * 文件内容按页对齐存放，响应头与实体标签预先生成，URL 到资源的索引是最小完美哈希。
+ * 查找只需计算一次哈希、读一个种子、比较一次路径，不做任何系统调用；多个进程映射同一个文件时共享同一份页缓存
+ *
+ * 文件布局：Header | 每个桶的种子（uint32） | Entry 数组（按槽位排列） | 字符串区 | 页对齐的文件内容
+ *
+ * 完美哈希（见 src/perfect_hash.hpp）的种子在打包时生成，与资源一起保存在文件中
+ */
+class AssetPack {
+public:
+    static constexpr std::string_view MAGIC = "WSPACK01";
+
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    AssetPack(const AssetPack &) = delete;
+
+    AssetPack &operator=(const AssetPack &) = delete;
+
+    /**
+     * 映射资源包文件，并为每个资源建立引用映射内容的 Asset（只在打开时分配一次）
+     *
+     * @return 文件不存在或格式错误时为空
+     */
+    static std::shared_ptr<const AssetPack> open(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return nullptr;
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            close(fd);
+            return nullptr;
+        }
+        // 预先读入全部页，之后的请求不会触发缺页
+        void *address = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED)
+            return nullptr;
+
+        auto mapping = std::make_shared<const Mapping>(static_cast<const char *>(address), st.st_size);
+        std::shared_ptr<AssetPack> pack(new AssetPack(std::move(mapping)));
+        if (!pack->load())
+            return nullptr;
+        return pack;
+    }
+
+    /**
+     * 把 root 下的全部普通文件打包写入 path（先写入临时文件再改名，已经映射旧文件的进程不受影响）
+     *
+     * 与 AssetCache 相同，不早于原文件的 .gz / .br 文件作为原文件的压缩版本；compress 为真时，
+     * 没有预压缩文件的文本资源在打包时压缩
+     *
+     * @return 是否成功
+     */
+    static bool build(const std::string &root, const std::string &path, bool compress = true) {
+        std::vector<std::string> paths;
+        std::error_code error;
+        for (std::filesystem::recursive_directory_iterator it(root, error), end; !error && it != end;
+             it.increment(error)) {
+            if (it->is_regular_file(error))
+                paths.push_back(it->path().lexically_relative(root).generic_string());
+        }
+        if (error)
+            return false;
+        std::sort(paths.begin(), paths.end());
+
+        // 有原文件的 .gz / .br 文件不单独成为资源
+        std::vector<std::string> originals;
+        for (const std::string &file: paths) {
+            bool isSibling = false;
+            for (size_t i = 1; i < ContentCoding::COUNT; ++i) {
+                std::string_view extension = ContentCoding::extension(ContentCoding::ALL[i]);
+                if (file.ends_with(extension) &&
+                    std::binary_search(paths.begin(), paths.end(), file.substr(0, file.size() - extension.size())))
+                    isSibling = true;
+            }
+            if (!isSibling)
+                originals.push_back(file);
+        }
+
+        std::vector<AssetCache::Variants> assets;
+        for (const std::string &file: originals) {
+            AssetCache::Variants variants = loadVariants(root, file, compress);
+            if (!variants[0])
+                return false;
+            assets.push_back(std::move(variants));
+        }
+
+        std::vector<std::string_view> keys;
+        for (const auto &variants: assets) {
+            keys.push_back(variants[0]->path);
+        }
+        std::vector<uint32_t> seeds, slots;
+        if (!PerfectHash::build(keys, seeds, slots))
+            return false;
+
+        std::string image = serialize(assets, seeds, slots);
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream os(temporary, std::ios::binary | std::ios::trunc);
+            os.write(image.data(), static_cast<std::streamsize>(image.size()));
+            if (!os.good()) {
+                std::remove(temporary.c_str());
+                return false;
+            }
+        }
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
+
+    /**
+     * 获取资源
+     *
+     * @param path 规范化后的路径
+     * @param accept 请求可以接受的内容编码
+     * @return 资源（可接受的版本中权重最高、压缩率最高的一个），不在资源包中时为空
+     */
+    std::shared_ptr<const Asset> get(std::string_view path, const AcceptEncoding &accept = AcceptEncoding()) const {
+        if (assets_.empty())
+            return nullptr;
+        uint32_t slot = PerfectHash::slotOf(path, seeds_, assets_.size());
+        // 不在资源包中的路径也会落在某个槽位上，需要比较路径
+        if (assets_[slot][0]->path != path)
+            return nullptr;
+        return AssetCache::select(assets_[slot], accept);
+    }
+
+    /**
+     * 资源数
+     */
+    size_t size() const {
+        return assets_.size();
+    }
+
+    /**
+     * 映射的字节数
+     */
+    size_t mappedBytes() const {
+        return mapping_->size;
+    }
+
+private:
+    struct Mapping {
+        Mapping(const char *data, size_t size) : data(data), size(size) {}
+
+        Mapping(const Mapping &) = delete;
+
+        Mapping &operator=(const Mapping &) = delete;
+
+        ~Mapping() {
+            munmap(const_cast<char *>(data), size);
+        }
+
+        const char *data;
+
+        size_t size;
+    };
+
+    /**
+     * 文件中的一段（相对文件开头的偏移量）
+     */
+    struct Span {
+        uint64_t offset;
+        uint64_t length;
+    };
+
+    struct Header {
+        char magic[8];
+        uint64_t fileSize;
+        uint32_t entryCount;
+        uint32_t bucketCount;
+    };
+
+    /**
+     * 一个编码版本，headerFields.offset 为 0 表示不存在
+     */
+    struct Variant {
+        Span body;
+        Span headerFields;
+        Span etag;
+        Span validatorFields;
+    };
+
+    struct Entry {
+        Span path;
+        Span contentType;
+        int64_t modifiedSeconds;
+        int64_t modifiedNanoseconds;
+        uint64_t isNegotiable;
+        std::array<Variant, ContentCoding::COUNT> variants;
+    };
+
+    explicit AssetPack(std::shared_ptr<const Mapping> mapping) : mapping_(std::move(mapping)) {}
+
+    /**
+     * 读取资源与它的压缩版本，生成响应头
+     */
+    static AssetCache::Variants loadVariants(const std::string &root, const std::string &path, bool compress) {
+        AssetCache::Variants variants;
+        std::shared_ptr<Asset> asset = loadFile(root, path);
+        if (!asset)
+            return variants;
+        asset->contentType = Asset::contentTypeOf(path);
+
+        bool isNegotiable = false;
+        for (size_t i = 1; i < ContentCoding::COUNT; ++i) {
+            ContentEncoding encoding = ContentCoding::ALL[i];
+            std::shared_ptr<Asset> variant = loadFile(root, path + std::string(ContentCoding::extension(encoding)));
+            if (variant && isOlder(variant->modifiedTime, asset->modifiedTime))
+                variant = nullptr;
+            if (!variant && compress && asset->size >= AssetCache::MIN_COMPRESS_SIZE &&
+                ContentCoding::isCompressible(asset->contentType)) {
+                variant = std::make_shared<Asset>();
+                if (!ContentCoding::compress(encoding, asset->body, variant->body) ||
+                    variant->body.size() >= asset->body.size())
+                    variant = nullptr;
+            }
+            if (!variant)
+                continue;
+            variant->path = path;
+            variant->size = variant->body.size();
+            variant->contentType = asset->contentType;
+            variant->encoding = encoding;
+            variant->fileModifiedTime = variant->modifiedTime; // 压缩生成的版本为空
+            variant->modifiedTime = asset->modifiedTime;
+            variant->buildHeaderFields(true);
+            variants[i] = std::move(variant);
+            isNegotiable = true;
+        }
+        asset->buildHeaderFields(isNegotiable);
+        variants[0] = std::move(asset);
+        return variants;
+    }
+
+    static std::shared_ptr<Asset> loadFile(const std::string &root, const std::string &path) {
+        std::string fullPath = root + "/" + path;
+        struct stat st{};
+        if (::stat(fullPath.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+            return nullptr;
+        std::ifstream is(fullPath, std::ios::binary);
+        if (!is.is_open())
+            return nullptr;
+        auto asset = std::make_shared<Asset>();
+        asset->body.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+        asset->path = path;
+        asset->size = asset->body.size();
+        asset->modifiedTime = st.st_mtim;
+        return asset;
+    }
+
+    static bool isOlder(const struct timespec &a, const struct timespec &b) {
+        return a.tv_sec < b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec);
+    }
+
+    static size_t alignUp(size_t offset, size_t alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    /**
+     * 生成资源包文件的内容
+     */
+    static std::string serialize(const std::vector<AssetCache::Variants> &assets, const std::vector<uint32_t> &seeds,
+                                 const std::vector<uint32_t> &slots) {
+        size_t seedsOffset = sizeof(Header);
+        size_t entriesOffset = alignUp(seedsOffset + seeds.size() * sizeof(uint32_t), alignof(Entry));
+        std::string image(entriesOffset + assets.size() * sizeof(Entry), '\0');
+        std::vector<Entry> entries(assets.size());
+
+        auto append = [&image](std::string_view data) {
+            Span span{image.size(), data.size()};
+            image.append(data);
+            return span;
+        };
+        for (size_t i = 0; i < assets.size(); ++i) {
+            const Asset &asset = *assets[i][0];
+            Entry &entry = entries[slots[i]];
+            entry.path = append(asset.path);
+            entry.contentType = append(asset.contentType);
+            entry.modifiedSeconds = asset.modifiedTime.tv_sec;
+            entry.modifiedNanoseconds = asset.modifiedTime.tv_nsec;
+            entry.isNegotiable = asset.isNegotiable;
+            for (size_t j = 0; j < ContentCoding::COUNT; ++j) {
+                if (const auto &variant = assets[i][j]) {
+                    entry.variants[j].headerFields = append(variant->headerFields);
+                    entry.variants[j].etag = append(variant->etag);
+                    entry.variants[j].validatorFields = append(variant->validatorFields);
+                }
+            }
+        }
+        // 文件内容放在最后，每个都从新的一页开始
+        for (size_t i = 0; i < assets.size(); ++i) {
+            for (size_t j = 0; j < ContentCoding::COUNT; ++j) {
+                if (const auto &variant = assets[i][j]) {
+                    image.resize(alignUp(image.size(), PAGE_SIZE));
+                    entries[slots[i]].variants[j].body = append(variant->body);
+                }
+            }
+        }
+
+        Header header{};
+        std::memcpy(header.magic, MAGIC.data(), sizeof(header.magic));
+        header.fileSize = image.size();
+        header.entryCount = static_cast<uint32_t>(assets.size());
+        header.bucketCount = static_cast<uint32_t>(seeds.size());
+        std::memcpy(image.data(), &header, sizeof(header));
+        std::memcpy(image.data() + seedsOffset, seeds.data(), seeds.size() * sizeof(uint32_t));
+        std::memcpy(image.data() + entriesOffset, entries.data(), entries.size() * sizeof(Entry));
+        return image;
+    }
+
+    /**
+     * 校验映射的内容，建立每个资源的 Asset
+     */
+    bool load() {
+        const char *data = mapping_->data;
+        size_t size = mapping_->size;
+        Header header{};
+        std::memcpy(&header, data, sizeof(header));
+        if (std::string_view(header.magic, sizeof(header.magic)) != MAGIC || header.fileSize != size ||
+            (header.entryCount > 0 && header.bucketCount == 0))
+            return false;
+        size_t seedsOffset = sizeof(Header);
+        size_t entriesOffset = alignUp(seedsOffset + header.bucketCount * sizeof(uint32_t), alignof(Entry));
+        if (entriesOffset + header.entryCount * sizeof(Entry) > size)
+            return false;
+
+        seeds_.resize(header.bucketCount);
+        std::memcpy(seeds_.data(), data + seedsOffset, seeds_.size() * sizeof(uint32_t));
+        auto isValid = [size](const Span &span) { return span.offset <= size && span.length <= size - span.offset; };
+        auto view = [data](const Span &span) { return std::string_view(data + span.offset, span.length); };
+
+        assets_.resize(header.entryCount);
+        for (size_t i = 0; i < header.entryCount; ++i) {
+            Entry entry{};
+            std::memcpy(&entry, data + entriesOffset + i * sizeof(Entry), sizeof(Entry));
+            if (!isValid(entry.path) || !isValid(entry.contentType))
+                return false;
+            for (size_t j = 0; j < ContentCoding::COUNT; ++j) {
+                const Variant &variant = entry.variants[j];
+                if (variant.headerFields.offset == 0)
+                    continue;
+                if (!isValid(variant.body) || !isValid(variant.headerFields) || !isValid(variant.etag) ||
+                    !isValid(variant.validatorFields))
+                    return false;
+                auto asset = std::make_shared<Asset>();
+                asset->path = view(entry.path);
+                asset->mapped = view(variant.body);
+                asset->mapping = mapping_;
+                asset->size = variant.body.length;
+                asset->contentType = view(entry.contentType);
+                asset->encoding = ContentCoding::ALL[j];
+                asset->headerFields = view(variant.headerFields);
+                asset->etag = view(variant.etag);
+                asset->validatorFields = view(variant.validatorFields);
+                asset->modifiedTime = {entry.modifiedSeconds, entry.modifiedNanoseconds};
+                asset->isNegotiable = entry.isNegotiable != 0;
+                assets_[i][j] = std::move(asset);
+            }
+            if (!assets_[i][0])
+                return false;
+        }
+        // 每个资源必须位于自己路径的槽位上
+        for (size_t i = 0; i < assets_.size(); ++i) {
+            if (PerfectHash::slotOf(assets_[i][0]->path, seeds_, assets_.size()) != i)
+                return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<const Mapping> mapping_;
+
+    std::vector<uint32_t> seeds_; // 每个桶的种子
+
+    std::vector<AssetCache::Variants> assets_; // 按槽位排列
+};
+
+#endif //WEBSERVER_ASSET_PACK_HPP
@@ -0,0 +1,210 @@
+#ifndef WEBSERVER_ASYNC_IO_HPP
+#define WEBSERVER_ASYNC_IO_HPP
+
+#include <cerrno>
+#include <coroutine>
+#include <cstdint>
+#include <netinet/in.h>
+#include <src/coroutine.hpp>
+#include <src/event_loop.hpp>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <utility>
+
+/**
+ * 在 EventLoop 上等待就绪的非阻塞文件描述符
+ *
+ * 文件描述符由所有者以边缘触发方式注册到事件循环，事件循环报告的事件交给 notify()。
+ * 每个操作先直接调用系统调用，返回 EAGAIN 时挂起，直到下一次相应的就绪事件再重试；
+ * 同一时间最多一个协程在它上面等待（一个连接由一个协程驱动）
+ */
+class AsyncFd {
+public:
+    explicit AsyncFd(int fd = -1) : fd_(fd) {}
+
+    AsyncFd(const AsyncFd &) = delete;
+
+    AsyncFd &operator=(const AsyncFd &) = delete;
+
+    int fd() const {
+        return fd_;
+    }
+
+    /**
+     * 事件循环报告的就绪事件，等待其中任一事件（或出错、挂断）的协程被恢复
+     *
+     * 被恢复的协程可能关闭并销毁该对象，返回后不能再访问它
+     */
+    void notify(uint32_t events) {
+        ready_ |= events;
+        if (waiter_ && (events & (interest_ | EPOLLERR | EPOLLHUP)))
+            std::exchange(waiter_, {}).resume();
+    }
+
+    /**
+     * 取消：恢复等待中的协程，之后的操作都立即返回 -ECANCELED
+     */
+    void cancel() {
+        isCancelled_ = true;
+        if (waiter_)
+            std::exchange(waiter_, {}).resume();
+    }
+
+    bool isCancelled() const {
+        return isCancelled_;
+    }
+
+    class Awaiter {
+    public:
+        Awaiter(AsyncFd &fd, uint32_t events) : fd_(fd), events_(events) {}
+
+        bool await_ready() const noexcept {
+            return fd_.isCancelled_ || (fd_.ready_ & (events_ | EPOLLERR | EPOLLHUP));
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept {
+            fd_.waiter_ = handle;
+            fd_.interest_ = events_;
+        }
+
+        /**
+         * @return 是否未被取消
+         */
+        bool await_resume() const noexcept {
+            return !fd_.isCancelled_;
+        }
+
+    private:
+        AsyncFd &fd_;
+
+        uint32_t events_;
+    };
+
+    /**
+     * 等待上次操作之后出现的就绪事件
+     *
+     * @param events EPOLLIN 或 EPOLLOUT
+     */
+    Awaiter wait(uint32_t events) {
+        return {*this, events};
+    }
+
+    /**
+     * 读取数据
+     *
+     * @return 读到的字节数，0 表示对端已关闭，负数为 -errno
+     */
+    Coroutine<ssize_t> read(void *buffer, size_t length) {
+        return perform(EPOLLIN, [this, buffer, length]() { return ::recv(fd_, buffer, length, 0); });
+    }
+
+    /**
+     * 发送 message 中的数据（可能只发送一部分）
+     *
+     * @return 发送的字节数，负数为 -errno
+     */
+    Coroutine<ssize_t> write(const msghdr *message, int flags = 0) {
+        return perform(EPOLLOUT, [this, message, flags]() { return ::sendmsg(fd_, message, flags | MSG_NOSIGNAL); });
+    }
+
+    /**
+     * 把文件 fileFd 中从 offset 开始的至多 count 字节直接从页缓存发送
+     *
+     * @return 发送的字节数，0 表示文件在 offset 处已经结束，负数为 -errno
+     */
+    Coroutine<ssize_t> sendfile(int fileFd, off_t offset, size_t count) {
+        return perform(EPOLLOUT, [this, fileFd, offset, count]() mutable {
+            return ::sendfile(fd_, fileFd, &offset, count);
+        });
+    }
+
+    /**
+     * 接受一个连接，得到的 socket 是非阻塞的
+     *
+     * @return 新连接的文件描述符，负数为 -errno
+     */
+    Coroutine<ssize_t> accept(sockaddr_in *address) {
+        return perform(EPOLLIN, [this, address]() {
+            socklen_t length = sizeof(*address);
+            return static_cast<ssize_t>(::accept4(fd_, reinterpret_cast<sockaddr *>(address), &length,
+                                                  SOCK_NONBLOCK | SOCK_CLOEXEC));
+        });
+    }
+
+private:
+    /**
+     * 调用系统调用，遇到 EINTR 时重试，遇到 EAGAIN 时等待 events 就绪后重试
+     */
+    template<typename Syscall>
+    Coroutine<ssize_t> perform(uint32_t events, Syscall syscall) {
+        while (true) {
+            if (isCancelled_)
+                co_return -ECANCELED;
+            // 在系统调用之前清除就绪标记：之后的边缘一定在挂起之后才由事件循环报告
+            ready_ &= ~events;
+            ssize_t result = syscall();
+            if (result >= 0)
+                co_return result;
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                co_return -errno;
+            co_await wait(events);
+        }
+    }
+
+    int fd_;
+
+    std::coroutine_handle<> waiter_;
+
+    uint32_t interest_ = 0; // 等待者关注的事件
+
+    uint32_t ready_ = 0; // 上次操作之后报告过的事件
+
+    bool isCancelled_ = false;
+};
+
+/**
+ * 在事件循环上挂起一段时间：co_await SleepFor(loop, std::chrono::seconds(1))
+ *
+ * 挂起中的协程被销毁时同时取消定时器
+ */
+class SleepFor {
+public:
+    SleepFor(EventLoop &loop, EventLoop::Clock::duration delay) : loop_(loop), delay_(delay) {}
+
+    SleepFor(const SleepFor &) = delete;
+
+    SleepFor &operator=(const SleepFor &) = delete;
+
+    ~SleepFor() {
+        if (isPending_)
+            loop_.cancelTimer(timer_);
+    }
+
+    bool await_ready() const noexcept {
+        return delay_ <= EventLoop::Clock::duration::zero();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        timer_ = loop_.runAfter(delay_, [this, handle]() {
+            isPending_ = false;
+            handle.resume();
+        });
+        isPending_ = true;
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    EventLoop &loop_;
+
+    EventLoop::Clock::duration delay_;
+
+    EventLoop::TimerId timer_{};
+
+    bool isPending_ = false;
+};
+
+#endif //WEBSERVER_ASYNC_IO_HPP
@@ -0,0 +1,149 @@
+#ifndef WEBSERVER_CLOCK_HPP
+#define WEBSERVER_CLOCK_HPP
+
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <string_view>
+
+/**
+ * 秒级时钟与时间字符串缓存
+ *
+ * 日志时间戳与 HTTP Date 头的精度都是秒，每个线程各自缓存一份格式化结果，
+ * 同一秒内的后续调用只比较一次整数，不再调用 localtime/gmtime，也不需要任何同步
+ */
+class CachedClock {
+public:
+    /**
+     * 当前时间（秒），使用粗粒度时钟，开销只是一次 vDSO 读取
+     */
+    static std::time_t now() {
+        struct timespec ts{};
+        clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+        return ts.tv_sec;
+    }
+
+    /**
+     * 本地时间的日志时间戳，如 "2022-05-27 13:14:15"
+     *
+     * @param time 日志产生的时间（秒）
+     * @return 指向线程局部缓冲区的视图，同一线程下次以不同的秒数调用前有效
+     */
+    static std::string_view logTimestamp(std::time_t time) {
+        thread_local Cache<19> cache;
+        if (cache.second != time) {
+            struct tm tm{};
+            localtime_r(&time, &tm);
+            char *p = cache.text.data();
+            p = writeDigits(p, tm.tm_year + 1900, 4);
+            *p++ = '-';
+            p = writeDigits(p, tm.tm_mon + 1, 2);
+            *p++ = '-';
+            p = writeDigits(p, tm.tm_mday, 2);
+            *p++ = ' ';
+            writeTime(p, tm);
+            cache.second = time;
+        }
+        return {cache.text.data(), cache.text.size()};
+    }
+
+    /**
+     * 当前时间的 RFC 7231 HTTP 日期（IMF-fixdate），如 "Sun, 06 Nov 1994 08:49:37 GMT"
+     */
+    static std::string_view httpDate() {
+        return httpDate(now());
+    }
+
+    static std::string_view httpDate(std::time_t time) {
+        static constexpr std::array<std::string_view, 7> DAYS = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+        static constexpr std::array<std::string_view, 12> MONTHS = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                                                    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+        thread_local Cache<29> cache;
+        if (cache.second != time) {
+            struct tm tm{};
+            gmtime_r(&time, &tm);
+            char *p = cache.text.data();
+            p = copy(p, DAYS[tm.tm_wday]);
+            *p++ = ',';
+            *p++ = ' ';
+            p = writeDigits(p, tm.tm_mday, 2);
+            *p++ = ' ';
+            p = copy(p, MONTHS[tm.tm_mon]);
+            *p++ = ' ';
+            p = writeDigits(p, tm.tm_year + 1900, 4);
+            *p++ = ' ';
+            p = writeTime(p, tm);
+            copy(p, " GMT");
+            cache.second = time;
+        }
+        return {cache.text.data(), cache.text.size()};
+    }
+
+    /**
+     * 解析 IMF-fixdate 格式的 HTTP 日期（If-Modified-Since 等），不支持已废弃的 RFC 850 与 asctime 格式
+     *
+     * @return 是否解析成功
+     */
+    static bool parseHttpDate(std::string_view text, std::time_t &time) {
+        // "Sun, 06 Nov 1994 08:49:37 GMT"
+        if (text.size() != 29 || text[3] != ',' || text[4] != ' ' || text[7] != ' ' || text[11] != ' ' ||
+            text[16] != ' ' || text[19] != ':' || text[22] != ':' || text.substr(25) != " GMT")
+            return false;
+        static constexpr std::string_view MONTHS = "JanFebMarAprMayJunJulAugSepOctNovDec";
+        size_t month = MONTHS.find(text.substr(8, 3));
+        int day, year, hour, minute, second;
+        if (month == std::string_view::npos || month % 3 != 0 || !readDigits(text.substr(5, 2), day) ||
+            !readDigits(text.substr(12, 4), year) || !readDigits(text.substr(17, 2), hour) ||
+            !readDigits(text.substr(20, 2), minute) || !readDigits(text.substr(23, 2), second))
+            return false;
+        std::chrono::year_month_day date{std::chrono::year(year), std::chrono::month(month / 3 + 1),
+                                         std::chrono::day(day)};
+        if (!date.ok() || hour > 23 || minute > 59 || second > 60)
+            return false;
+        auto days = std::chrono::sys_days(date).time_since_epoch().count();
+        time = static_cast<std::time_t>(days) * 86400 + hour * 3600 + minute * 60 + second;
+        return true;
+    }
+
+private:
+    static bool readDigits(std::string_view digits, int &value) {
+        value = 0;
+        for (char c: digits) {
+            if (c < '0' || c > '9')
+                return false;
+            value = value * 10 + (c - '0');
+        }
+        return true;
+    }
+
+    template<size_t N>
+    struct Cache {
+        std::time_t second = -1;
+        std::array<char, N> text{};
+    };
+
+    static char *writeDigits(char *p, int value, int width) {
+        for (int i = width - 1; i >= 0; --i) {
+            p[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        return p + width;
+    }
+
+    static char *writeTime(char *p, const struct tm &tm) {
+        p = writeDigits(p, tm.tm_hour, 2);
+        *p++ = ':';
+        p = writeDigits(p, tm.tm_min, 2);
+        *p++ = ':';
+        return writeDigits(p, tm.tm_sec, 2);
+    }
+
+    static char *copy(char *p, std::string_view s) {
+        for (char c: s) {
+            *p++ = c;
+        }
+        return p;
+    }
+};
+
+#endif //WEBSERVER_CLOCK_HPP
@@ -0,0 +1,232 @@
+#ifndef WEBSERVER_CONDITIONAL_REQUEST_HPP
+#define WEBSERVER_CONDITIONAL_REQUEST_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <src/clock.hpp>
+#include <src/http_parser.hpp>
+#include <string_view>
+
+/**
+ * 响应体中的一段字节（长度不为 0）
+ */
+struct ByteRange {
+    size_t offset;
+
+    size_t length;
+
+    size_t last() const {
+        return offset + length - 1;
+    }
+};
+
+/**
+ * 解析后的 Range 头（只支持 bytes 单位）
+ *
+ * 多于 MAX_RANGES 段或各段总长超过资源大小（重叠的范围）时忽略整个 Range 头，返回完整内容，
+ * 避免少量请求字节换来大量的分段响应
+ */
+class ByteRanges {
+public:
+    static constexpr size_t MAX_RANGES = 16;
+
+    enum class Result {
+        IGNORED, // 没有 Range 头、格式错误或不支持，返回完整内容
+        SATISFIABLE,
+        UNSATISFIABLE, // 所有范围都超出了资源，返回 416
+    };
+
+    /**
+     * @param header Range 的值，如 "bytes=0-499, -500"
+     * @param size 资源的大小
+     */
+    Result parse(std::string_view header, size_t size) {
+        count_ = 0;
+        if (!header.starts_with("bytes="))
+            return Result::IGNORED;
+        header.remove_prefix(6);
+
+        size_t total = 0;
+        bool isEmpty = true;
+        while (!header.empty()) {
+            size_t comma = header.find(',');
+            std::string_view spec = trim(header.substr(0, comma));
+            header = comma == std::string_view::npos ? std::string_view() : header.substr(comma + 1);
+            if (spec.empty()) // 列表中允许空元素
+                continue;
+            isEmpty = false;
+
+            size_t dash = spec.find('-');
+            if (dash == std::string_view::npos)
+                return Result::IGNORED;
+            uint64_t first, last;
+            bool hasFirst = readNumber(spec.substr(0, dash), first);
+            bool hasLast = readNumber(spec.substr(dash + 1), last);
+            if ((!hasFirst && dash != 0) || (!hasLast && dash + 1 != spec.size()) || (!hasFirst && !hasLast))
+                return Result::IGNORED;
+
+            ByteRange range{};
+            if (!hasFirst) { // 后缀范围 "-500"：最后 500 字节
+                if (last == 0 || size == 0)
+                    continue;
+                range.length = std::min<uint64_t>(last, size);
+                range.offset = size - range.length;
+            } else {
+                if (hasLast && last < first)
+                    return Result::IGNORED;
+                if (first >= size) // 不可满足的一段
+                    continue;
+                range.offset = first;
+                range.length = (hasLast ? std::min<uint64_t>(last, size - 1) : size - 1) - first + 1;
+            }
+            if (count_ == MAX_RANGES)
+                return Result::IGNORED;
+            total += range.length;
+            if (total > size)
+                return Result::IGNORED;
+            ranges_[count_++] = range;
+        }
+        if (isEmpty)
+            return Result::IGNORED;
+        return count_ == 0 ? Result::UNSATISFIABLE : Result::SATISFIABLE;
+    }
+
+    size_t size() const {
+        return count_;
+    }
+
+    const ByteRange &operator[](size_t index) const {
+        return ranges_[index];
+    }
+
+    const ByteRange *begin() const {
+        return ranges_.data();
+    }
+
+    const ByteRange *end() const {
+        return ranges_.data() + count_;
+    }
+
+private:
+    static std::string_view trim(std::string_view value) {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+            value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+            value.remove_suffix(1);
+        return value;
+    }
+
+    /**
+     * @return 是否为非空的十进制数（溢出时截断为最大值，相当于超出资源）
+     */
+    static bool readNumber(std::string_view digits, uint64_t &value) {
+        if (digits.empty())
+            return false;
+        value = 0;
+        for (char c: digits) {
+            if (c < '0' || c > '9')
+                return false;
+            value = value > (UINT64_MAX - 9) / 10 ? UINT64_MAX : value * 10 + (c - '0');
+        }
+        return true;
+    }
+
+    std::array<ByteRange, MAX_RANGES> ranges_{};
+
+    size_t count_ = 0;
+};
+
+/**
+ * 条件请求与范围请求的判定（RFC 9110 第 13 节）
+ *
+ * 依次检查 If-None-Match（没有时检查 If-Modified-Since）决定是否返回 304，再检查 If-Range 与 Range 决定是否返回
+ * 部分内容。这些头字段只对 GET 与 HEAD 生效，其他方法总是得到 FULL。只读取请求视图中已识别的头字段，不分配内存
+ */
+class ConditionalRequest {
+public:
+    enum class Outcome {
+        FULL, // 200 完整内容
+        NOT_MODIFIED, // 304
+        PARTIAL, // 206，范围在 ranges 中
+        RANGE_NOT_SATISFIABLE, // 416
+    };
+
+    /**
+     * @param etag 资源当前的强 ETag（带引号）
+     * @param lastModified 资源的修改时间（秒）
+     * @param size 资源（所选编码版本）的大小
+     * @param ranges 返回 PARTIAL 时保存请求的范围
+     */
+    static Outcome evaluate(const HttpRequestView &request, std::string_view etag, std::time_t lastModified,
+                            size_t size, ByteRanges &ranges) {
+        if (request.method != "GET" && request.method != "HEAD")
+            return Outcome::FULL;
+
+        if (request.hasHeader(KnownHeader::IF_NONE_MATCH)) {
+            if (matchesAny(request.header(KnownHeader::IF_NONE_MATCH), etag, false))
+                return Outcome::NOT_MODIFIED;
+        } else if (request.hasHeader(KnownHeader::IF_MODIFIED_SINCE)) {
+            std::time_t since;
+            if (CachedClock::parseHttpDate(request.header(KnownHeader::IF_MODIFIED_SINCE), since) &&
+                lastModified <= since)
+                return Outcome::NOT_MODIFIED;
+        }
+
+        if (!request.hasHeader(KnownHeader::RANGE))
+            return Outcome::FULL;
+        // If-Range 与当前版本不一致时客户端缓存的部分已过期，返回完整内容
+        if (request.hasHeader(KnownHeader::IF_RANGE) &&
+            !isCurrent(request.header(KnownHeader::IF_RANGE), etag, lastModified))
+            return Outcome::FULL;
+        switch (ranges.parse(request.header(KnownHeader::RANGE), size)) {
+            case ByteRanges::Result::SATISFIABLE:
+                return Outcome::PARTIAL;
+            case ByteRanges::Result::UNSATISFIABLE:
+                return Outcome::RANGE_NOT_SATISFIABLE;
+            default:
+                return Outcome::FULL;
+        }
+    }
+
+    /**
+     * If-None-Match / If-Match 形式的列表（"*" 或逗号分隔的实体标签）中是否有与 etag 匹配的
+     *
+     * @param isStrong 是否使用强比较（弱标签 W/"..." 不与任何标签匹配），否则使用弱比较（忽略 W/ 前缀）
+     */
+    static bool matchesAny(std::string_view list, std::string_view etag, bool isStrong) {
+        while (!list.empty()) {
+            size_t start = list.find_first_not_of(" \t,");
+            if (start == std::string_view::npos)
+                break;
+            list.remove_prefix(start);
+            if (list.front() == '*')
+                return true;
+
+            bool isWeak = list.starts_with("W/");
+            size_t open = isWeak ? 2 : 0;
+            size_t close = list.size() > open ? list.find('"', open + 1) : std::string_view::npos;
+            if (list.size() <= open || list[open] != '"' || close == std::string_view::npos)
+                return false; // 格式错误
+            if (list.substr(open, close - open + 1) == etag && !(isStrong && isWeak))
+                return true;
+            list.remove_prefix(close + 1);
+        }
+        return false;
+    }
+
+private:
+    /**
+     * If-Range 的值（实体标签或日期）是否对应当前版本：实体标签使用强比较，日期必须与修改时间完全一致
+     */
+    static bool isCurrent(std::string_view validator, std::string_view etag, std::time_t lastModified) {
+        if (validator.starts_with('"') || validator.starts_with("W/"))
+            return matchesAny(validator, etag, true);
+        std::time_t time;
+        return CachedClock::parseHttpDate(validator, time) && time == lastModified;
+    }
+};
+
+#endif //WEBSERVER_CONDITIONAL_REQUEST_HPP
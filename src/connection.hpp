@@ -0,0 +1,175 @@
+#ifndef WEBSERVER_CONNECTION_HPP
+#define WEBSERVER_CONNECTION_HPP
+
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <src/async_io.hpp>
+#include <src/coroutine.hpp>
+#include <src/http_parser.hpp>
+#include <src/memory_pool.hpp>
+#include <src/timing_wheel.hpp>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <utility>
+#include <vector>
+
+/**
+ * 待发送的消息：自有的响应头 + 引用外部数据的响应体
+ *
+ * 响应体可以是内存中的数据，也可以是文件描述符中的一段（用 sendfile 发送）；
+ * 两者通常来自资源缓存，owner 保证发送完成之前数据与文件描述符不会被释放，发送时不复制
+ */
+class OutgoingMessage {
+public:
+    OutgoingMessage() = default;
+
+    explicit OutgoingMessage(std::string head, std::string_view body = {}, std::shared_ptr<const void> owner = nullptr)
+            : head(std::move(head)), body(body), owner(std::move(owner)) {}
+
+    /**
+     * 构造响应体为文件中一段的消息
+     */
+    static OutgoingMessage fromFile(std::string head, int fd, off_t offset, size_t length,
+                                    std::shared_ptr<const void> owner) {
+        OutgoingMessage message(std::move(head), {}, std::move(owner));
+        message.fileFd = fd;
+        message.fileOffset = offset;
+        message.fileLength = length;
+        return message;
+    }
+
+    /**
+     * 内存部分（响应头与内存中的响应体）中剩余未发送的部分填入 iovec
+     *
+     * @return 使用的 iovec 个数
+     */
+    int fill(iovec *iov) const {
+        int count = 0;
+        if (sent < head.size()) {
+            iov[count++] = {const_cast<char *>(head.data()) + sent, head.size() - sent};
+        }
+        size_t bodySent = sent > head.size() ? sent - head.size() : 0;
+        if (bodySent < body.size()) {
+            iov[count++] = {const_cast<char *>(body.data()) + bodySent, body.size() - bodySent};
+        }
+        return count;
+    }
+
+    size_t remaining() const {
+        return memorySize() + fileLength - sent;
+    }
+
+    size_t memorySize() const {
+        return head.size() + body.size();
+    }
+
+    bool hasFile() const {
+        return fileFd >= 0;
+    }
+
+    /**
+     * 内存部分已发送完，只剩文件部分
+     */
+    bool isSendingFile() const {
+        return hasFile() && sent >= memorySize();
+    }
+
+    bool empty() const {
+        return head.empty() && body.empty() && !hasFile();
+    }
+
+    std::string head;
+
+    std::string_view body;
+
+    int fileFd = -1;
+
+    off_t fileOffset = 0;
+
+    size_t fileLength = 0;
+
+    std::shared_ptr<const void> owner;
+
+    size_t sent = 0;
+
+    std::chrono::steady_clock::time_point queuedAt; // 加入发送队列的时间，用于统计发送耗时
+
+    std::vector<OutgoingMessage> continuation; // 分段的响应（如 multipart/byteranges）中随后发送的消息，加入发送队列时展开
+};
+
+/**
+ * 连接当前的超时
+ */
+enum class ConnectionTimeout : uint8_t {
+    NONE,
+    REQUEST, // 从连接建立或收到请求的第一个字节起，收到完整请求的期限
+    IDLE, // 持久连接上两个请求之间的空闲时间
+    WRITE, // 发送没有任何进展的最长时间
+};
+
+/**
+ * 客户端连接的状态
+ *
+ * 由一个协程驱动（读取、处理、发送），只在事件循环线程中访问；
+ * 读缓冲区、发送队列与内存区域都从事件循环的缓冲区池分配，连接关闭后留给之后的连接
+ */
+class Connection {
+public:
+    Connection(int fd, uint64_t id, std::string peer,
+               std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : fd(fd), id(id), peer(std::move(peer)), readBuffer(resource), outgoing(resource), arena(resource),
+              io(fd), fileChunk(resource) {}
+
+    int fd;
+
+    uint64_t id;
+
+    std::string peer;
+
+    std::pmr::string readBuffer;
+
+    HttpParser parser; // 解析读缓冲区起始处的请求，跨多次 recv() 保持进度
+
+    std::pmr::deque<OutgoingMessage> outgoing; // 按顺序等待发送的响应
+
+    Arena arena; // 交给线程池的请求的副本，每个请求开始时重置
+
+    std::coroutine_handle<> handler; // 驱动连接的协程，结束前清除；服务器关闭时销毁仍在挂起的协程
+
+    AsyncFd io; // epoll 后端：等待 socket 就绪
+
+    bool isPeerClosed = false; // 对端已关闭写方向
+
+    bool isCloseAfterWrite = false;
+
+    size_t requestCount = 0; // 该连接上已派发的请求数
+
+    TimerNode timeout; // 事件循环时间轮上的超时，到期时取消连接正在等待的 I/O
+
+    ConnectionTimeout timeoutKind = ConnectionTimeout::NONE;
+
+    static constexpr size_t MAX_IOV = 16;
+
+    std::array<iovec, MAX_IOV> iov{}; // 发送中的 iovec，io_uring 后端中保存到发送完成
+
+    msghdr message{};
+
+    // 以下只用于 io_uring 后端：同一时间最多一个发送（或读文件）请求在途，它引用的数据保存在连接中直到完成
+
+    AsyncEvent received; // 收到数据（结果为 recv 的返回值）
+
+    AsyncEvent completed; // 发送或读文件完成（结果为请求的返回值）
+
+    bool isCloseSubmitted = false; // 关闭请求已提交（可能链接在最后一次发送之后）
+
+    std::pmr::vector<char> fileChunk; // 大文件分块读入后发送
+};
+
+#endif //WEBSERVER_CONNECTION_HPP
@@ -0,0 +1,258 @@
+#ifndef WEBSERVER_CONTENT_ENCODING_HPP
+#define WEBSERVER_CONTENT_ENCODING_HPP
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <src/http_headers.hpp>
+#include <string>
+#include <string_view>
+
+#ifdef WEBSERVER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef WEBSERVER_HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+/**
+ * 响应体的内容编码，按服务器的偏好从低到高排列（权重相同时选择压缩率更高的编码）
+ */
+enum class ContentEncoding : uint8_t {
+    IDENTITY,
+    GZIP,
+    BROTLI,
+};
+
+/**
+ * 内容编码的名字、预压缩文件的扩展名与压缩实现
+ *
+ * 压缩库在构建时可选（WEBSERVER_HAVE_ZLIB / WEBSERVER_HAVE_BROTLI），没有压缩库时仍可使用预压缩的文件
+ */
+class ContentCoding {
+public:
+    static constexpr size_t COUNT = 3;
+
+    static constexpr std::array<ContentEncoding, COUNT> ALL = {
+            ContentEncoding::IDENTITY, ContentEncoding::GZIP, ContentEncoding::BROTLI,
+    };
+
+    /**
+     * Content-Encoding 与 Accept-Encoding 中的名字
+     */
+    static constexpr std::string_view name(ContentEncoding encoding) {
+        constexpr std::array<std::string_view, COUNT> names = {"identity", "gzip", "br"};
+        return names[static_cast<size_t>(encoding)];
+    }
+
+    /**
+     * 预压缩文件相对原文件追加的扩展名，如 style.css.gz
+     */
+    static constexpr std::string_view extension(ContentEncoding encoding) {
+        constexpr std::array<std::string_view, COUNT> extensions = {"", ".gz", ".br"};
+        return extensions[static_cast<size_t>(encoding)];
+    }
+
+    /**
+     * 是否可以在服务器中压缩（构建时找到了对应的压缩库）
+     */
+    static constexpr bool canCompress(ContentEncoding encoding) {
+        switch (encoding) {
+            case ContentEncoding::GZIP:
+#ifdef WEBSERVER_HAVE_ZLIB
+                return true;
+#else
+                return false;
+#endif
+            case ContentEncoding::BROTLI:
+#ifdef WEBSERVER_HAVE_BROTLI
+                return true;
+#else
+                return false;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * 该类型的内容是否值得压缩（文本类型；图片等已经压缩过的格式不再压缩）
+     */
+    static bool isCompressible(std::string_view contentType) {
+        std::string_view type = contentType.substr(0, contentType.find(';'));
+        return type.starts_with("text/") || type == "application/javascript" || type == "application/json" ||
+               type == "image/svg+xml";
+    }
+
+    /**
+     * 以最高压缩率压缩（耗时较长，只在后台任务中执行一次）
+     *
+     * @param encoding 编码
+     * @param input 原始内容
+     * @param output 压缩后的内容
+     * @return 是否成功（没有对应的压缩库时失败）
+     */
+    static bool compress(ContentEncoding encoding, std::string_view input, std::string &output) {
+        switch (encoding) {
+            case ContentEncoding::GZIP:
+                return gzip(input, output);
+            case ContentEncoding::BROTLI:
+                return brotli(input, output);
+            default:
+                return false;
+        }
+    }
+
+private:
+    static bool gzip([[maybe_unused]] std::string_view input, [[maybe_unused]] std::string &output) {
+#ifdef WEBSERVER_HAVE_ZLIB
+        if (input.size() > UINT_MAX)
+            return false;
+        z_stream stream{};
+        // windowBits 加 16 生成 gzip 格式（而不是 zlib 格式）
+        if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+            return false;
+        output.resize(deflateBound(&stream, input.size()));
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+        stream.avail_in = static_cast<uInt>(input.size());
+        stream.next_out = reinterpret_cast<Bytef *>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+        int result = deflate(&stream, Z_FINISH);
+        output.resize(stream.total_out);
+        deflateEnd(&stream);
+        return result == Z_STREAM_END;
+#else
+        return false;
+#endif
+    }
+
+    static bool brotli([[maybe_unused]] std::string_view input, [[maybe_unused]] std::string &output) {
+#ifdef WEBSERVER_HAVE_BROTLI
+        size_t size = BrotliEncoderMaxCompressedSize(input.size());
+        if (size == 0)
+            return false;
+        output.resize(size);
+        if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, input.size(),
+                                   reinterpret_cast<const uint8_t *>(input.data()), &size,
+                                   reinterpret_cast<uint8_t *>(output.data())))
+            return false;
+        output.resize(size);
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+/**
+ * 解析后的 Accept-Encoding：每种编码的权重（0 到 1000，0 表示不接受）
+ *
+ * 没有 Accept-Encoding 时只接受 identity；出现时未列出的编码取 "*" 的权重，identity 未列出时仍可接受
+ */
+class AcceptEncoding {
+public:
+    /**
+     * 只接受 identity
+     */
+    AcceptEncoding() {
+        qualities_[static_cast<size_t>(ContentEncoding::IDENTITY)] = MAX_QUALITY;
+    }
+
+    /**
+     * @param header Accept-Encoding 的值，为空视图时相当于没有该头字段
+     */
+    explicit AcceptEncoding(std::string_view header) : AcceptEncoding() {
+        if (header.empty())
+            return;
+
+        std::array<bool, ContentCoding::COUNT> listed{};
+        int wildcard = -1;
+        while (!header.empty()) {
+            size_t comma = header.find(',');
+            std::string_view item = header.substr(0, comma);
+            header = comma == std::string_view::npos ? std::string_view() : header.substr(comma + 1);
+
+            size_t semicolon = item.find(';');
+            std::string_view coding = trim(item.substr(0, semicolon));
+            uint16_t quality = MAX_QUALITY;
+            if (semicolon != std::string_view::npos)
+                quality = parseQuality(item.substr(semicolon + 1));
+
+            if (coding == "*") {
+                wildcard = quality;
+                continue;
+            }
+            for (ContentEncoding encoding: ContentCoding::ALL) {
+                if (equalsIgnoreCase(coding, ContentCoding::name(encoding)) ||
+                    (encoding == ContentEncoding::GZIP && equalsIgnoreCase(coding, "x-gzip"))) {
+                    qualities_[static_cast<size_t>(encoding)] = quality;
+                    listed[static_cast<size_t>(encoding)] = true;
+                }
+            }
+        }
+        if (wildcard >= 0) {
+            for (size_t i = 0; i < ContentCoding::COUNT; ++i) {
+                if (!listed[i])
+                    qualities_[i] = static_cast<uint16_t>(wildcard);
+            }
+        }
+    }
+
+    uint16_t quality(ContentEncoding encoding) const {
+        return qualities_[static_cast<size_t>(encoding)];
+    }
+
+    bool accepts(ContentEncoding encoding) const {
+        return quality(encoding) > 0;
+    }
+
+    /**
+     * 是否接受 identity 以外的任何编码
+     */
+    bool acceptsAnyCompression() const {
+        return accepts(ContentEncoding::GZIP) || accepts(ContentEncoding::BROTLI);
+    }
+
+private:
+    static constexpr uint16_t MAX_QUALITY = 1000;
+
+    static std::string_view trim(std::string_view value) {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+            value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+            value.remove_suffix(1);
+        return value;
+    }
+
+    /**
+     * 解析 "q=0.5" 形式的参数（最多三位小数），格式错误时视为 1
+     */
+    static uint16_t parseQuality(std::string_view parameters) {
+        while (!parameters.empty()) {
+            size_t semicolon = parameters.find(';');
+            std::string_view parameter = trim(parameters.substr(0, semicolon));
+            parameters = semicolon == std::string_view::npos ? std::string_view() : parameters.substr(semicolon + 1);
+            if (parameter.size() < 3 || toLowerAscii(parameter[0]) != 'q' || parameter[1] != '=')
+                continue;
+
+            std::string_view value = parameter.substr(2);
+            if (value[0] != '0') // "1" 或 "1.000"
+                return MAX_QUALITY;
+            uint16_t quality = 0, scale = 100;
+            for (size_t i = 2; i < value.size() && i < 5 && value[1] == '.'; ++i) {
+                if (value[i] < '0' || value[i] > '9')
+                    break;
+                quality += static_cast<uint16_t>((value[i] - '0') * scale);
+                scale /= 10;
+            }
+            return quality;
+        }
+        return MAX_QUALITY;
+    }
+
+    std::array<uint16_t, ContentCoding::COUNT> qualities_{};
+};
+
+#endif //WEBSERVER_CONTENT_ENCODING_HPP
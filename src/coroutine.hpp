@@ -0,0 +1,358 @@
+#ifndef WEBSERVER_COROUTINE_HPP
+#define WEBSERVER_COROUTINE_HPP
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+/**
+ * 协程帧的内存池
+ *
+ * 帧的大小按 GRANULARITY 字节向上取整分级，每个线程为每一级保存一个空闲链表：协程结束后帧归还到当前线程的链表，
+ * 之后创建同样大小的协程时直接取出。稳定运行时创建协程不分配堆内存，超过 MAX_POOLED_SIZE 的帧直接使用堆内存
+ */
+class FramePool {
+public:
+    static constexpr size_t GRANULARITY = 64;
+
+    static constexpr size_t MAX_POOLED_SIZE = 4096;
+
+    static constexpr size_t MAX_CACHED_PER_CLASS = 1024; // 每一级最多缓存的空闲帧数，多出的归还给堆
+
+    static void *allocate(size_t size) {
+        if (size > MAX_POOLED_SIZE)
+            return ::operator new(size);
+        FreeLists &lists = freeLists();
+        size_t index = classOf(size);
+        if (FreeBlock *block = lists.heads[index]) {
+            lists.heads[index] = block->next;
+            --lists.counts[index];
+            return block;
+        }
+        return ::operator new((index + 1) * GRANULARITY);
+    }
+
+    static void deallocate(void *p, size_t size) noexcept {
+        if (size > MAX_POOLED_SIZE) {
+            ::operator delete(p);
+            return;
+        }
+        FreeLists &lists = freeLists();
+        size_t index = classOf(size);
+        if (lists.isClosed || lists.counts[index] >= MAX_CACHED_PER_CLASS) {
+            ::operator delete(p);
+            return;
+        }
+        auto *block = static_cast<FreeBlock *>(p);
+        block->next = lists.heads[index];
+        lists.heads[index] = block;
+        ++lists.counts[index];
+    }
+
+    /**
+     * 当前线程缓存的空闲帧数
+     */
+    static size_t cached() {
+        size_t total = 0;
+        for (size_t count: freeLists().counts) {
+            total += count;
+        }
+        return total;
+    }
+
+private:
+    static constexpr size_t CLASSES = MAX_POOLED_SIZE / GRANULARITY;
+
+    static size_t classOf(size_t size) {
+        return size == 0 ? 0 : (size - 1) / GRANULARITY;
+    }
+
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    struct FreeLists {
+        ~FreeLists() {
+            for (FreeBlock *&head: heads) {
+                while (head) {
+                    ::operator delete(std::exchange(head, head->next));
+                }
+            }
+            counts = {};
+            isClosed = true; // 线程退出时，之后才销毁的协程帧直接归还给堆
+        }
+
+        std::array<FreeBlock *, CLASSES> heads{};
+
+        std::array<size_t, CLASSES> counts{};
+
+        bool isClosed = false;
+    };
+
+    static FreeLists &freeLists() {
+        thread_local FreeLists lists;
+        return lists;
+    }
+};
+
+/**
+ * promise 类型的基类：协程帧从 FramePool 分配
+ */
+struct PooledFrame {
+    static void *operator new(size_t size) {
+        return FramePool::allocate(size);
+    }
+
+    static void operator delete(void *p, size_t size) noexcept {
+        FramePool::deallocate(p, size);
+    }
+};
+
+/**
+ * 惰性启动的协程：创建时不执行，被 co_await 时才开始，结束后恢复等待它的协程
+ *
+ * 被等待时在等待者的 await_suspend 中直接执行，同步完成时等待者不挂起、直接继续，
+ * 循环中大量同步完成的 co_await 不会逐层加深调用栈（不依赖编译器把对称转移优化为尾调用）；
+ * 挂起后由事件循环恢复、再完成时，才通过对称转移恢复等待者。等待者与它必须在同一线程中恢复
+ *
+ * 协程对象拥有协程帧，析构时销毁仍未结束的协程；协程中未捕获的异常在 co_await 处重新抛出
+ *
+ * @tparam T 结果的类型
+ */
+template<typename T = void>
+class [[nodiscard]] Coroutine {
+    struct PromiseBase : PooledFrame {
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept {
+                return false;
+            }
+
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+                PromiseBase &promise = handle.promise();
+                // 仍在等待者的 await_suspend 中执行（同步完成）时由它继续，否则恢复等待者
+                if (promise.isRunningInline || !promise.continuation)
+                    return std::noop_coroutine();
+                return promise.continuation;
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept {
+            return {};
+        }
+
+        void unhandled_exception() noexcept {
+            exception = std::current_exception();
+        }
+
+        void rethrowIfFailed() const {
+            if (exception)
+                std::rethrow_exception(exception);
+        }
+
+        std::coroutine_handle<> continuation;
+
+        std::exception_ptr exception;
+
+        bool isRunningInline = false;
+    };
+
+    struct ValuePromise : PromiseBase {
+        template<typename U>
+        void return_value(U &&result) {
+            value.emplace(std::forward<U>(result));
+        }
+
+        T result() {
+            this->rethrowIfFailed();
+            return std::move(*value);
+        }
+
+        std::optional<T> value;
+    };
+
+    struct VoidPromise : PromiseBase {
+        void return_void() noexcept {}
+
+        void result() {
+            this->rethrowIfFailed();
+        }
+    };
+
+public:
+    struct promise_type : std::conditional_t<std::is_void_v<T>, VoidPromise, ValuePromise> {
+        Coroutine get_return_object() noexcept {
+            return Coroutine(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+    };
+
+    Coroutine(Coroutine &&other) noexcept: handle_(std::exchange(other.handle_, {})) {}
+
+    Coroutine &operator=(Coroutine &&other) noexcept {
+        if (this != &other) {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    Coroutine(const Coroutine &) = delete;
+
+    Coroutine &operator=(const Coroutine &) = delete;
+
+    ~Coroutine() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    /**
+     * 在当前线程中开始执行（不被其他协程等待时使用），到第一个挂起点或结束时返回
+     */
+    void start() {
+        handle_.resume();
+    }
+
+    bool done() const {
+        return handle_.done();
+    }
+
+    /**
+     * 已结束的协程的结果，协程以异常结束时重新抛出
+     */
+    T result() {
+        return handle_.promise().result();
+    }
+
+    bool await_ready() const noexcept {
+        return handle_.done();
+    }
+
+    /**
+     * @return 协程是否挂起（未同步完成），挂起时等待者也挂起
+     */
+    bool await_suspend(std::coroutine_handle<> continuation) {
+        promise_type &promise = handle_.promise();
+        promise.continuation = continuation;
+        promise.isRunningInline = true;
+        handle_.resume();
+        promise.isRunningInline = false;
+        return !handle_.done();
+    }
+
+    T await_resume() {
+        return handle_.promise().result();
+    }
+
+private:
+    explicit Coroutine(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * 独立运行的协程：没有等待者，结束后自行销毁协程帧
+ *
+ * 创建后需要调用 start()；仍在挂起中的协程可以由保存了 handle() 的一方销毁（如服务器关闭时），
+ * 因此协程结束之前应当清除保存的 handle。协程中未捕获的异常会终止程序
+ */
+class [[nodiscard]] Detached {
+public:
+    struct promise_type : PooledFrame {
+        Detached get_return_object() noexcept {
+            return Detached(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+
+    std::coroutine_handle<> handle() const {
+        return handle_;
+    }
+
+    void start() {
+        handle_.resume();
+    }
+
+private:
+    explicit Detached(std::coroutine_handle<> handle) : handle_(handle) {}
+
+    std::coroutine_handle<> handle_;
+};
+
+/**
+ * 由回调唤醒的事件，同一时间最多一个协程等待
+ *
+ * notify() 保存结果并恢复等待者；没有等待者时结果被保留，下一次等待立即返回（之前保留的结果被覆盖）。
+ * 被恢复的协程可能销毁事件所在的对象，因此 notify() 返回后不能再访问该对象
+ */
+class AsyncEvent {
+public:
+    class Awaiter {
+    public:
+        explicit Awaiter(AsyncEvent &event) : event_(event) {}
+
+        bool await_ready() const noexcept {
+            return event_.isSet_;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept {
+            event_.waiter_ = handle;
+        }
+
+        int await_resume() noexcept {
+            event_.isSet_ = false;
+            return event_.result_;
+        }
+
+    private:
+        AsyncEvent &event_;
+    };
+
+    Awaiter wait() {
+        return Awaiter(*this);
+    }
+
+    void notify(int result) {
+        result_ = result;
+        isSet_ = true;
+        if (waiter_)
+            std::exchange(waiter_, {}).resume();
+    }
+
+    bool isWaiting() const {
+        return static_cast<bool>(waiter_);
+    }
+
+private:
+    std::coroutine_handle<> waiter_;
+
+    int result_ = 0;
+
+    bool isSet_ = false;
+};
+
+#endif //WEBSERVER_COROUTINE_HPP
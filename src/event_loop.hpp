@@ -0,0 +1,268 @@
+#ifndef WEBSERVER_EVENT_LOOP_HPP
+#define WEBSERVER_EVENT_LOOP_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <src/timing_wheel.hpp>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/**
+ * 基于 epoll（边缘触发）的事件循环
+ *
+ * 由单个线程调用 loop() 驱动，所有注册的文件描述符与定时器都只在该线程中处理；
+ * 其他线程通过 runInLoop() 把任务投递回循环线程执行
+ *
+ * 定时器有两种：runAfter() 的一次性定时器按到期时间排序，精确到毫秒；
+ * timeouts() 时间轮上的侵入式定时器精度为一个刻度，布置与取消都是 O(1)，用于大量连接各自的超时
+ */
+class EventLoop {
+public:
+    using EventHandler = std::function<void(int fd, uint32_t events)>;
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * 定时器的标识：到期时间与创建序号
+     */
+    using TimerId = std::pair<Clock::time_point, uint64_t>;
+
+    explicit EventLoop(int maxEvents = 1024) : epollFd_(epoll_create1(EPOLL_CLOEXEC)),
+                                               wakeupFd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+                                               events_(maxEvents),
+                                               isQuit_(false),
+                                               isWakeupPending_(false) {
+        if (epollFd_ < 0 || wakeupFd_ < 0) {
+            throw std::runtime_error("Fail to create epoll instance");
+        }
+        add(wakeupFd_, EPOLLIN | EPOLLET);
+    }
+
+    EventLoop(const EventLoop &) = delete;
+
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    ~EventLoop() {
+        close(wakeupFd_);
+        close(epollFd_);
+    }
+
+    /**
+     * 注册文件描述符
+     *
+     * @param fd 文件描述符（应当是非阻塞的）
+     * @param events 关注的事件，如 EPOLLIN | EPOLLET
+     * @return 是否注册成功
+     */
+    bool add(int fd, uint32_t events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        return epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    bool modify(int fd, uint32_t events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        return epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &event) == 0;
+    }
+
+    void remove(int fd) {
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
+    /**
+     * 在 delay 之后调用 callback（只能在循环线程中调用，回调也在循环线程中执行）
+     *
+     * @return 可用于 cancelTimer() 的标识
+     */
+    TimerId runAfter(Clock::duration delay, std::function<void()> callback) {
+        TimerId id{Clock::now() + delay, nextTimerSequence_++};
+        timers_.emplace(id, std::move(callback));
+        return id;
+    }
+
+    /**
+     * 取消尚未到期的定时器，已执行或已取消时什么也不做
+     */
+    void cancelTimer(const TimerId &id) {
+        timers_.erase(id);
+    }
+
+    /**
+     * 时间轮（只能在循环线程中使用），到期的定时器由 runExpiredTimers() 处理
+     */
+    TimingWheel &timeouts() {
+        return timeouts_;
+    }
+
+    /**
+     * 距最早的定时器到期的毫秒数（向上取整），没有定时器时为 -1，可直接作为 epoll_wait 等的超时参数
+     */
+    int nextTimeoutMs() const {
+        auto now = Clock::now();
+        int wheel = timeouts_.nextTimeoutMs(now);
+        if (timers_.empty())
+            return wheel;
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(timers_.begin()->first.first - now);
+        int timer = static_cast<int>(std::max<int64_t>(remaining.count(), 0));
+        return wheel < 0 ? timer : std::min(timer, wheel);
+    }
+
+    /**
+     * 执行所有已到期的定时器，由其他机制（如 io_uring）代替 loop() 驱动时每轮调用
+     */
+    void runExpiredTimers() {
+        auto now = Clock::now();
+        while (!timers_.empty() && timers_.begin()->first.first <= now) {
+            auto timer = timers_.extract(timers_.begin());
+            timer.mapped()();
+        }
+        timeouts_.advance(now);
+    }
+
+    /**
+     * 运行事件循环，直到 quit() 被调用
+     *
+     * @param handler 就绪事件的处理函数
+     */
+    void loop(const EventHandler &handler) {
+        while (!isQuit_) {
+            int n = epoll_wait(epollFd_, events_.data(), static_cast<int>(events_.size()), nextTimeoutMs());
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+
+            for (int i = 0; i < n; ++i) {
+                int fd = events_[i].data.fd;
+                if (fd == wakeupFd_) {
+                    drainWakeup();
+                    continue;
+                }
+                handler(fd, events_[i].events);
+            }
+
+            runPendingTasks();
+            runExpiredTimers();
+
+            // 就绪事件填满了数组，说明并发连接较多，扩大单轮可处理的事件数
+            if (static_cast<size_t>(n) == events_.size()) {
+                events_.resize(events_.size() * 2);
+            }
+        }
+    }
+
+    /**
+     * 将任务投递到循环线程中执行（线程安全）
+     *
+     * @param task 任务
+     */
+    void runInLoop(std::function<void()> task) {
+        {
+            const std::lock_guard<std::mutex> lockGuard(pendingTasksMutex_);
+            pendingTasks_.push_back(std::move(task));
+        }
+        wakeup();
+    }
+
+    /**
+     * 退出事件循环（线程安全）
+     */
+    void quit() {
+        isQuit_ = true;
+        wakeup();
+    }
+
+    bool isQuit() const {
+        return isQuit_;
+    }
+
+    /**
+     * 用于唤醒的 eventfd，由其他机制（如 io_uring）代替 loop() 驱动时监听它的可读事件
+     */
+    int wakeupFd() const {
+        return wakeupFd_;
+    }
+
+    /**
+     * wakeupFd() 可读时调用：清空 eventfd 并执行投递的任务（在循环线程中）
+     */
+    void handleWakeup() {
+        drainWakeup();
+        runPendingTasks();
+    }
+
+    /**
+     * 丢弃尚未执行的投递任务（循环退出之后、任务引用的对象销毁之前调用）
+     */
+    void discardPendingTasks() {
+        const std::lock_guard<std::mutex> lockGuard(pendingTasksMutex_);
+        pendingTasks_.clear();
+    }
+
+private:
+    void wakeup() {
+        // 已经有未处理的唤醒时，无需再次写 eventfd
+        if (isWakeupPending_.exchange(true))
+            return;
+        uint64_t one = 1;
+        [[maybe_unused]] auto n = write(wakeupFd_, &one, sizeof(one));
+    }
+
+    void drainWakeup() {
+        uint64_t value;
+        while (read(wakeupFd_, &value, sizeof(value)) > 0) {}
+    }
+
+    void runPendingTasks() {
+        isWakeupPending_ = false;
+        {
+            const std::lock_guard<std::mutex> lockGuard(pendingTasksMutex_);
+            runningTasks_.swap(pendingTasks_);
+        }
+        for (auto &task: runningTasks_) {
+            task();
+        }
+        runningTasks_.clear();
+    }
+
+    int epollFd_;
+
+    int wakeupFd_;
+
+    std::vector<epoll_event> events_;
+
+    std::atomic<bool> isQuit_;
+
+    std::atomic<bool> isWakeupPending_;
+
+    std::mutex pendingTasksMutex_;
+
+    std::vector<std::function<void()>> pendingTasks_;
+
+    std::vector<std::function<void()>> runningTasks_; // 与 pendingTasks_ 交换后执行，两者的容量循环使用
+
+    std::pmr::unsynchronized_pool_resource timerNodes_; // 定时器节点循环使用，周期性的定时器不反复分配堆内存
+
+    std::pmr::map<TimerId, std::function<void()>> timers_{&timerNodes_}; // 按到期时间排序
+
+    uint64_t nextTimerSequence_ = 0;
+
+    TimingWheel timeouts_;
+};
+
+#endif //WEBSERVER_EVENT_LOOP_HPP
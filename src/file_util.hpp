@@ -5,7 +5,39 @@
 #ifndef WEBSERVER_FILE_UTIL_HPP
 #define WEBSERVER_FILE_UTIL_HPP
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <unistd.h>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/**
+ * 只读文件描述符（RAII）
+ *
+ * 可被多个连接共享：sendfile 使用显式偏移量，不会改变文件描述符自身的读写位置
+ */
+class FileHandle {
+public:
+    explicit FileHandle(int fd) : fd_(fd) {}
+
+    FileHandle(const FileHandle &) = delete;
+
+    FileHandle &operator=(const FileHandle &) = delete;
+
+    ~FileHandle() {
+        if (fd_ >= 0)
+            close(fd_);
+    }
+
+    int fd() const {
+        return fd_;
+    }
+
+private:
+    int fd_;
+};
 
 class FileUtil {
 public:
@@ -38,6 +70,85 @@ public:
             return std::make_pair("", false);
         }
     }
+
+    /**
+     * 将请求 URL 规范化为 statics/ 文件夹下的相对路径
+     *
+     * 去掉查询串与片段，解码 %XX，合并多余的 '/' 与 '.'，处理 '..'；越出根目录或包含 NUL 时视为非法
+     *
+     * @param url 请求 URL，如 /images/../index.html?from=nav
+     * @return 相对路径（如 index.html）与是否合法
+     */
+    static std::pair<std::string, bool> normalizePath(std::string_view url) {
+        std::string result;
+        bool valid = normalizePath(url, result);
+        return std::make_pair(std::move(result), valid);
+    }
+
+    /**
+     * 将请求 URL 规范化为相对路径，结果写入调用方的缓冲区（先清空，容量可以循环使用）
+     *
+     * @param url 请求 URL
+     * @param result 规范化后的相对路径，非法时为空
+     * @return 是否合法
+     */
+    static bool normalizePath(std::string_view url, std::string &result) {
+        url = url.substr(0, url.find_first_of("?#"));
+
+        result.clear();
+        for (size_t i = 0; i < url.size(); ++i) {
+            if (url[i] != '%') {
+                result.push_back(url[i]);
+                continue;
+            }
+            int high = i + 2 < url.size() ? hexValue(url[i + 1]) : -1;
+            int low = i + 2 < url.size() ? hexValue(url[i + 2]) : -1;
+            if (high < 0 || low < 0 || (high == 0 && low == 0)) {
+                result.clear();
+                return false;
+            }
+            result.push_back(static_cast<char>(high * 16 + low));
+            i += 2;
+        }
+
+        // 在解码结果上原地合并路径段：每个写入的段之前至少读过一个 '/'，写入位置不会超过读取位置
+        size_t length = 0;
+        size_t begin = 0;
+        while (begin < result.size()) {
+            size_t slash = std::min(result.find('/', begin), result.size());
+            std::string_view segment(result.data() + begin, slash - begin);
+            begin = slash + 1;
+
+            if (segment.empty() || segment == ".")
+                continue;
+            if (segment == "..") {
+                if (length == 0) {
+                    result.clear();
+                    return false;
+                }
+                size_t previous = result.rfind('/', length - 1);
+                length = previous == std::string::npos ? 0 : previous;
+                continue;
+            }
+            if (length > 0)
+                result[length++] = '/';
+            std::memmove(result.data() + length, segment.data(), segment.size());
+            length += segment.size();
+        }
+        result.resize(length);
+        return true;
+    }
+
+private:
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
 };
 
 #endif //WEBSERVER_FILE_UTIL_HPP
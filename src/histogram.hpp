@@ -0,0 +1,156 @@
+#ifndef WEBSERVER_HISTOGRAM_HPP
+#define WEBSERVER_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * 对数-线性刻度
+ *
+ * 小于 2^SubBucketBits 的数值每个值一个桶；更大的数值按 2 的幂分段，每段均分为 2^(SubBucketBits-1) 个桶，
+ * 相对误差不超过 2^-(SubBucketBits-1)；每段的边界恰好是 2 的幂
+ */
+template<int SubBucketBits>
+struct LogLinearScale {
+    static constexpr uint64_t SUB_BUCKETS = uint64_t(1) << SubBucketBits;
+
+    static constexpr uint64_t HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+
+    /**
+     * 桶的下标
+     */
+    static constexpr size_t indexOf(uint64_t value) {
+        if (value < SUB_BUCKETS)
+            return value;
+        int shift = 63 - __builtin_clzll(value) - (SubBucketBits - 1);
+        return SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS + ((value >> shift) - HALF_SUB_BUCKETS);
+    }
+
+    /**
+     * 与下标为 index 的桶中数值等价的最大值
+     */
+    static constexpr uint64_t highestEquivalentValue(size_t index) {
+        if (index < SUB_BUCKETS)
+            return index;
+        size_t shift = (index - SUB_BUCKETS) / HALF_SUB_BUCKETS + 1;
+        uint64_t mantissa = (index - SUB_BUCKETS) % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+        return ((mantissa + 1) << shift) - 1;
+    }
+};
+
+/**
+ * HDR 风格的对数-线性直方图
+ *
+ * 把数值按 2 的幂分段，每段再均分为 SUB_BUCKETS / 2 个桶，任意数值的相对误差不超过 1/1024（三位有效数字）；
+ * 记录只是一次数组自增，不分配内存，多个直方图可以合并（如各线程分别记录后汇总）
+ */
+class Histogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 11;
+
+    using Scale = LogLinearScale<SUB_BUCKET_BITS>;
+
+    static constexpr uint64_t SUB_BUCKETS = Scale::SUB_BUCKETS; // 小于该值的数值精确记录
+
+    /**
+     * @param highestTrackableValue 可记录的最大值，更大的值按最大值记录
+     */
+    explicit Histogram(uint64_t highestTrackableValue = uint64_t(1) << 40)
+            : highest_(std::max(highestTrackableValue, SUB_BUCKETS)), counts_(indexOf(highest_) + 1, 0) {}
+
+    void record(uint64_t value) {
+        recordCount(value, 1);
+    }
+
+    void recordCount(uint64_t value, uint64_t count) {
+        value = std::min(value, highest_);
+        counts_[indexOf(value)] += count;
+        total_ += count;
+        sum_ += value * count;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    /**
+     * 合并另一个直方图（可记录范围必须相同）
+     */
+    void merge(const Histogram &other) {
+        for (size_t i = 0; i < counts_.size() && i < other.counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    void reset() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        total_ = sum_ = max_ = 0;
+        min_ = std::numeric_limits<uint64_t>::max();
+    }
+
+    uint64_t count() const {
+        return total_;
+    }
+
+    uint64_t min() const {
+        return total_ == 0 ? 0 : min_;
+    }
+
+    uint64_t max() const {
+        return max_;
+    }
+
+    double mean() const {
+        return total_ == 0 ? 0 : static_cast<double>(sum_) / static_cast<double>(total_);
+    }
+
+    /**
+     * 百分位数
+     *
+     * @param percentile 0 到 100
+     * @return 不小于 percentile% 记录值的最小桶的上界（不超过实际最大值）
+     */
+    uint64_t valueAtPercentile(double percentile) const {
+        if (total_ == 0)
+            return 0;
+        percentile = std::clamp(percentile, 0.0, 100.0);
+        auto target = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total_) + 0.5);
+        target = std::clamp<uint64_t>(target, 1, total_);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= target)
+                return std::clamp(highestEquivalentValue(i), min(), max_);
+        }
+        return max_;
+    }
+
+    static size_t indexOf(uint64_t value) {
+        return Scale::indexOf(value);
+    }
+
+    static uint64_t highestEquivalentValue(size_t index) {
+        return Scale::highestEquivalentValue(index);
+    }
+
+private:
+    uint64_t highest_;
+
+    std::vector<uint64_t> counts_;
+
+    uint64_t total_ = 0;
+
+    uint64_t sum_ = 0;
+
+    uint64_t min_ = std::numeric_limits<uint64_t>::max();
+
+    uint64_t max_ = 0;
+};
+
+#endif //WEBSERVER_HISTOGRAM_HPP
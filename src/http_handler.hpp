@@ -6,148 +6,173 @@
 #define WEBSERVER_HTTP_HANDLER_HPP
 
 #include <cstring>
+#include <src/http_headers.hpp>
+#include <src/http_parser.hpp>
+#include <src/response_writer.hpp>
 #include <exception>
 #include <iostream>
+#include <memory_resource>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <utility>
-#include <vector>
 
-class HttpHeaders {
+/**
+ * 解析后的请求，全部字段从构造时给定的内存资源分配
+ */
+class HttpRequest {
 public:
-    void put(const std::string &header, const std::string &attribute) {
-        headers_[header] = attribute;
-    }
-
-    /**
-     * 根据头字段的名字获得值
-     *
-     * @param header 头字段的名字
-     * @return 头字段的值（以字符串的形式返回，可能是多值的）
-     */
-    std::string get(const std::string &header) {
-        return headers_[header];
-    }
-
-    /**
-     * 获取所有存在的头字段的名字
-     *
-     * @return
-     */
-    std::vector<std::string> keys() const {
-        std::vector<std::string> keys_(headers_.size());
-        std::transform(headers_.begin(), headers_.end(), keys_.begin(), [](auto pair) { return pair.first; });
-        return keys_;
-    }
+    using allocator_type = std::pmr::polymorphic_allocator<>;
 
-    /**
-     * 返回不包含任何头字段的 HttpHeaders
-     *
-     * @return 不包含任何头字段的 HttpHeaders
-     */
-    static HttpHeaders empty() {
-        return {};
-    }
+    HttpRequest() = default;
 
-private:
-    std::unordered_map<std::string, std::string> headers_;
-};
+    explicit HttpRequest(const allocator_type &allocator)
+            : method(allocator), url(allocator), version(allocator), headers(allocator), body(allocator) {}
 
-class HttpRequest {
-public:
-    std::string method;
-    std::string url;
-    std::string version;
+    std::pmr::string method;
+    std::pmr::string url;
+    std::pmr::string version;
     HttpHeaders headers;
-    std::string body;
+    std::pmr::string body;
 };
 
 class HttpResponse {
 public:
-    HttpResponse(std::string version, std::string statusCode, std::string statusMessage,
-                 HttpHeaders headers, std::string body) : version(std::move(version)),
-                                                          statusCode(std::move(statusCode)),
-                                                          statusMessage(std::move(statusMessage)),
-                                                          headers(std::move(headers)),
-                                                          body(std::move(body)) {}
-
-    std::string version;
-    std::string statusCode;
-    std::string statusMessage;
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    HttpResponse(std::string_view version, std::string_view statusCode, std::string_view statusMessage,
+                 HttpHeaders headers, std::string_view body, const allocator_type &allocator = {})
+            : version(version, allocator),
+              statusCode(statusCode, allocator),
+              statusMessage(statusMessage, allocator),
+              headers(std::move(headers), allocator),
+              body(body, allocator) {}
+
+    std::pmr::string version;
+    std::pmr::string statusCode;
+    std::pmr::string statusMessage;
     HttpHeaders headers;
-    std::string body;
+    std::pmr::string body;
 };
 
 class HttpHandler {
 public:
     /**
      * 将字节数组解析成 HttpRequest 实例对象
+     *
+     * 字节数组应当是一个完整的请求；没有 Content-Length 时，头部之后的全部数据都作为请求体
+     *
      * @param bytes 通过 Socket 传来的字节数组
      * @return HttpRequest 实例对象
+     * @throw std::invalid_argument 请求不完整或格式错误
      */
     static HttpRequest resolveRequest(std::string &&bytes) {
-        HttpRequest request;
-
-        size_t index = 0;
-
-        // Method
-        while (bytes[index] != ' ')
-            ++index;
-        size_t lenOfMethod = index;
-        request.method = std::move(bytes.substr(0, lenOfMethod));
-        ++index;
-
-        // Url
-        while (bytes[index] != ' ')
-            ++index;
-        size_t lenOfUrl = index - lenOfMethod - 1;
-        request.url = std::move(bytes.substr(lenOfMethod + 1, lenOfUrl));
-        ++index;
-
-        // Version
-        while (!(bytes[index] == '\r' && bytes[index + 1] == '\n'))
-            ++index;
-        size_t lenOfVersion = index - lenOfUrl - lenOfMethod - 2;
-        request.version = std::move(bytes.substr(lenOfMethod + lenOfUrl + 2, lenOfVersion));
-        index += 2;
-
-        // Headers
-        while (!(bytes[index] == '\r' && bytes[index + 1] == '\n')) {
-            size_t begin = index, split = begin;
-            while (!(bytes[index] == '\r' && bytes[index + 1] == '\n')) {
-                if (bytes[index] == ':' && split == begin)
-                    split = index;
-                ++index;
-            }
-            request.headers.put(bytes.substr(begin, split - begin), bytes.substr(split + 2, index - split - 2));
-            index += 2;
+        return resolveRequest(bytes, std::pmr::get_default_resource());
+    }
+
+    /**
+     * 将字节数组解析成 HttpRequest 实例对象，请求的全部字段从 resource 分配（如每个请求重置一次的内存区域）
+     *
+     * @param bytes 一个完整的请求
+     * @param resource 内存资源，应当比返回的请求存活更久
+     * @return HttpRequest 实例对象
+     * @throw std::invalid_argument 请求不完整或格式错误
+     */
+    static HttpRequest resolveRequest(std::string_view bytes, std::pmr::memory_resource *resource) {
+        HttpParser parser;
+        if (parser.parse(bytes) != ParseResult::COMPLETE)
+            throw std::invalid_argument("Malformed or incomplete HTTP request");
+
+        const HttpRequestView &view = parser.request();
+
+        HttpRequest request(resource);
+        request.method = view.method;
+        request.url = view.url;
+        request.version = view.version;
+        for (size_t i = 0; i < view.headerCount; ++i) {
+            request.headers.add(view.headers[i].name, view.headers[i].value);
         }
-        index += 2;
+        request.body = view.hasHeader(KnownHeader::CONTENT_LENGTH) ? view.body : bytes.substr(parser.consumed());
+
+        return request;
+    }
 
-        // Body
-        request.body = std::move(bytes.substr(index));
+    /**
+     * 判断请求是否希望保持连接（HTTP/1.1 默认保持，HTTP/1.0 需显式声明 keep-alive）
+     *
+     * Connection 的值是逗号分隔的选项列表（如 "keep-alive, Upgrade"），按选项不区分大小写地查找，
+     * 出现 close 时总是关闭
+     *
+     * @param request 请求的视图
+     * @return 是否保持连接
+     */
+    static bool isKeepAlive(const HttpRequestView &request) {
+        std::string_view connection = request.header(KnownHeader::CONNECTION);
 
-        return std::move(request);
+        if (hasToken(connection, "close"))
+            return false;
+        return request.version == "HTTP/1.1" || hasToken(connection, "keep-alive");
     }
 
     /**
      * 将 HttpResponse 实例对象序列化为字节数组
      *
+     * 未显式设置 Content-Length 时根据响应体自动补充，以便客户端在持久连接上划分响应
+     *
      * @param response HttpResponse 实例对象
      * @return 字节数组
      */
     static std::string serializeResponse(HttpResponse &&response) {
-        std::string result = response.version + SPACE + response.statusCode + SPACE + response.statusMessage + CRLF;
-        for (const auto &key: response.headers.keys()) {
-            result += key + ":" + SPACE + response.headers.get(key) + CRLF;
-        }
-        return std::move(result + CRLF + response.body);
+        std::string result;
+        writeResponse(response, result);
+        return result;
+    }
+
+    /**
+     * 将 HttpResponse 实例对象序列化为字节数组，结果从 resource 分配
+     */
+    static std::pmr::string serializeResponse(const HttpResponse &response, std::pmr::memory_resource *resource) {
+        std::pmr::string result(resource);
+        writeResponse(response, result);
+        return result;
     }
 
 private:
-    static constexpr const char *SPACE = " ";
-    static constexpr const char *CRLF = "\r\n";
+    /**
+     * 逗号分隔的列表中是否有 token（不区分大小写，忽略两侧的空白）
+     */
+    static bool hasToken(std::string_view list, std::string_view token) {
+        while (!list.empty()) {
+            size_t comma = list.find(',');
+            std::string_view item = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+
+            while (!item.empty() && (item.front() == ' ' || item.front() == '\t'))
+                item.remove_prefix(1);
+            while (!item.empty() && (item.back() == ' ' || item.back() == '\t'))
+                item.remove_suffix(1);
+            if (equalsIgnoreCase(item, token))
+                return true;
+        }
+        return false;
+    }
+
+    template<typename String>
+    static void writeResponse(const HttpResponse &response, String &result) {
+        result.reserve(256 + response.body.size());
+
+        BasicResponseWriter<String> writer(result);
+        writer.status(response.version, response.statusCode, response.statusMessage);
+        response.headers.forEach([&writer](std::string_view header, std::string_view attribute) {
+            writer.header(header, attribute);
+        });
+        if (!response.headers.contains(KnownHeader::CONTENT_LENGTH)) {
+            writer.header(HttpHeader::CONTENT_LENGTH, response.body.size());
+        }
+        writer.end();
+
+        result.append(response.body);
+    }
 };
 
 #endif //WEBSERVER_HTTP_HANDLER_HPP
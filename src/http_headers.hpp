@@ -0,0 +1,465 @@
+#ifndef WEBSERVER_HTTP_HEADERS_HPP
+#define WEBSERVER_HTTP_HEADERS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * ASCII 字母转为小写
+ */
+constexpr char toLowerAscii(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+/**
+ * 不区分大小写地比较两个字符串（仅 ASCII）
+ */
+inline bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (toLowerAscii(a[i]) != toLowerAscii(b[i]))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * 常见的请求头字段，每个请求都会查找的字段可以不比较字符串直接定位
+ */
+enum class KnownHeader : uint8_t {
+    HOST,
+    CONNECTION,
+    CONTENT_LENGTH,
+    CONTENT_TYPE,
+    CONTENT_ENCODING,
+    TRANSFER_ENCODING,
+    IF_NONE_MATCH,
+    IF_MODIFIED_SINCE,
+    IF_MATCH,
+    IF_UNMODIFIED_SINCE,
+    IF_RANGE,
+    RANGE,
+    ACCEPT,
+    ACCEPT_ENCODING,
+    ACCEPT_LANGUAGE,
+    USER_AGENT,
+    COOKIE,
+    REFERER,
+    AUTHORIZATION,
+    CACHE_CONTROL,
+    PRAGMA,
+    UPGRADE,
+    EXPECT,
+    ORIGIN,
+    UNKNOWN,
+};
+
+/**
+ * 常见头字段名的完美哈希
+ *
+ * 由名字的长度与首、中、尾三个字符（转为小写）组成一个 32 位的键，乘以编译期找到的种子后取高位作为槽位，
+ * 全部常见名字落在不同的槽位；查找时只需一次乘法与一次不区分大小写的比较
+ */
+class HeaderNames {
+public:
+    static constexpr size_t COUNT = static_cast<size_t>(KnownHeader::UNKNOWN);
+
+    static constexpr std::string_view name(KnownHeader header) {
+        return NAMES[static_cast<size_t>(header)];
+    }
+
+    /**
+     * 根据名字（不区分大小写）找到常见头字段
+     *
+     * @return 不是常见头字段时为 KnownHeader::UNKNOWN
+     */
+    static constexpr KnownHeader lookup(std::string_view name) {
+        if (name.empty())
+            return KnownHeader::UNKNOWN;
+        uint8_t candidate = TABLE[slot(name, SEED)];
+        if (candidate == EMPTY_SLOT || !equalsIgnoreCaseConstexpr(name, NAMES[candidate]))
+            return KnownHeader::UNKNOWN;
+        return static_cast<KnownHeader>(candidate);
+    }
+
+private:
+    static constexpr std::array<std::string_view, COUNT> NAMES = {
+            "Host",
+            "Connection",
+            "Content-Length",
+            "Content-Type",
+            "Content-Encoding",
+            "Transfer-Encoding",
+            "If-None-Match",
+            "If-Modified-Since",
+            "If-Match",
+            "If-Unmodified-Since",
+            "If-Range",
+            "Range",
+            "Accept",
+            "Accept-Encoding",
+            "Accept-Language",
+            "User-Agent",
+            "Cookie",
+            "Referer",
+            "Authorization",
+            "Cache-Control",
+            "Pragma",
+            "Upgrade",
+            "Expect",
+            "Origin",
+    };
+
+    static constexpr unsigned TABLE_BITS = 8;
+
+    static constexpr uint8_t EMPTY_SLOT = 0xFF;
+
+    static constexpr bool equalsIgnoreCaseConstexpr(std::string_view a, std::string_view b) {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (toLowerAscii(a[i]) != toLowerAscii(b[i]))
+                return false;
+        }
+        return true;
+    }
+
+    static constexpr size_t slot(std::string_view name, uint32_t seed) {
+        auto byte = [](char c) { return static_cast<uint32_t>(static_cast<unsigned char>(toLowerAscii(c))); };
+        uint32_t key = static_cast<uint32_t>(name.size() & 0xFF) | byte(name[0]) << 8 |
+                       byte(name[name.size() / 2]) << 16 | byte(name.back()) << 24;
+        return static_cast<uint32_t>(key * seed) >> (32 - TABLE_BITS);
+    }
+
+    /**
+     * 从小到大尝试奇数种子，直到全部名字落在不同的槽位
+     */
+    static constexpr uint32_t findSeed() {
+        for (uint32_t seed = 1; seed < 1000000; seed += 2) {
+            std::array<bool, size_t(1) << TABLE_BITS> used{};
+            bool isPerfect = true;
+            for (std::string_view name: NAMES) {
+                size_t index = slot(name, seed);
+                if (used[index]) {
+                    isPerfect = false;
+                    break;
+                }
+                used[index] = true;
+            }
+            if (isPerfect)
+                return seed;
+        }
+        throw "No perfect hash seed for the known header names"; // 编译期求值时报错
+    }
+
+    static constexpr std::array<uint8_t, size_t(1) << TABLE_BITS> buildTable(uint32_t seed) {
+        std::array<uint8_t, size_t(1) << TABLE_BITS> table{};
+        table.fill(EMPTY_SLOT);
+        for (size_t i = 0; i < COUNT; ++i) {
+            table[slot(NAMES[i], seed)] = static_cast<uint8_t>(i);
+        }
+        return table;
+    }
+
+    static const uint32_t SEED;
+
+    static const std::array<uint8_t, size_t(1) << TABLE_BITS> TABLE;
+};
+
+// 种子与槽位表在类定义完整之后才能在编译期求值
+inline constexpr uint32_t HeaderNames::SEED = HeaderNames::findSeed();
+
+inline constexpr std::array<uint8_t, size_t(1) << HeaderNames::TABLE_BITS> HeaderNames::TABLE =
+        HeaderNames::buildTable(HeaderNames::SEED);
+
+/**
+ * 头字段的集合
+ *
+ * 按加入的顺序保存，名字不区分大小写，同一名字可以有多个值；前 INLINE_CAPACITY 个字段直接保存在对象中，
+ * 名字与值的字节依次追加到同一个字符串中（从构造时给定的内存资源分配），常见头字段另有索引，查找时不比较字符串
+ */
+class HttpHeaders {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    static constexpr size_t INLINE_CAPACITY = 8;
+
+    HttpHeaders() = default;
+
+    explicit HttpHeaders(const allocator_type &allocator) : overflow_(allocator), text_(allocator) {}
+
+    HttpHeaders(const HttpHeaders &other) = default;
+
+    HttpHeaders(const HttpHeaders &other, const allocator_type &allocator)
+            : inline_(other.inline_), overflow_(other.overflow_, allocator), size_(other.size_),
+              text_(other.text_, allocator), known_(other.known_) {}
+
+    HttpHeaders(HttpHeaders &&other) noexcept = default;
+
+    HttpHeaders(HttpHeaders &&other, const allocator_type &allocator)
+            : inline_(other.inline_), overflow_(std::move(other.overflow_), allocator), size_(other.size_),
+              text_(std::move(other.text_), allocator), known_(other.known_) {}
+
+    HttpHeaders &operator=(const HttpHeaders &other) = default;
+
+    HttpHeaders &operator=(HttpHeaders &&other) = default;
+
+    /**
+     * 设置头字段：替换第一个同名字段的值，并移除其余同名字段；不存在时加入到最后
+     */
+    void put(std::string_view header, std::string_view attribute) {
+        size_t index = find(header);
+        if (index == NOT_FOUND) {
+            add(header, attribute);
+            return;
+        }
+        Entry &entry = at(index);
+        if (attribute.size() <= entry.valueLength) { // 原位覆盖，否则追加到末尾
+            text_.replace(entry.valueOffset, attribute.size(), attribute);
+        } else {
+            entry.valueOffset = static_cast<uint32_t>(text_.size());
+            text_.append(attribute);
+        }
+        entry.valueLength = static_cast<uint32_t>(attribute.size());
+        removeFrom(index + 1, header);
+    }
+
+    /**
+     * 加入一个字段（已有同名字段时成为它的又一个值）
+     */
+    void add(std::string_view header, std::string_view attribute) {
+        Entry entry{};
+        entry.nameOffset = static_cast<uint32_t>(text_.size());
+        entry.nameLength = static_cast<uint32_t>(header.size());
+        text_.append(header);
+        entry.valueOffset = static_cast<uint32_t>(text_.size());
+        entry.valueLength = static_cast<uint32_t>(attribute.size());
+        text_.append(attribute);
+        entry.id = HeaderNames::lookup(header);
+
+        if (size_ < INLINE_CAPACITY) {
+            inline_[size_] = entry;
+        } else {
+            overflow_.push_back(entry);
+        }
+        if (entry.id != KnownHeader::UNKNOWN && known_[static_cast<size_t>(entry.id)] == NO_INDEX)
+            known_[static_cast<size_t>(entry.id)] = static_cast<uint16_t>(size_);
+        ++size_;
+    }
+
+    /**
+     * 根据头字段的名字（不区分大小写）获得第一个值
+     *
+     * @param header 头字段的名字
+     * @return 头字段的值，不存在时为空（不会插入新的头字段）；在修改头字段之前有效
+     */
+    std::string_view get(std::string_view header) const {
+        return getOrDefault(header, {});
+    }
+
+    std::string_view get(KnownHeader header) const {
+        size_t index = known_[static_cast<size_t>(header)];
+        return index == NO_INDEX ? std::string_view() : value(at(index));
+    }
+
+    /**
+     * 根据头字段的名字获得值，不存在时返回默认值（不会插入新的头字段）
+     *
+     * @param header 头字段的名字
+     * @param defaultValue 默认值
+     * @return 头字段的值
+     */
+    std::string_view getOrDefault(std::string_view header, std::string_view defaultValue) const {
+        size_t index = find(header);
+        return index == NOT_FOUND ? defaultValue : value(at(index));
+    }
+
+    /**
+     * 是否存在指定的头字段
+     *
+     * @param header 头字段的名字
+     * @return 是否存在
+     */
+    bool contains(std::string_view header) const {
+        return find(header) != NOT_FOUND;
+    }
+
+    bool contains(KnownHeader header) const {
+        return known_[static_cast<size_t>(header)] != NO_INDEX;
+    }
+
+    /**
+     * 同名字段的个数
+     */
+    size_t count(std::string_view header) const {
+        size_t result = 0;
+        forEachValue(header, [&result](std::string_view) { ++result; });
+        return result;
+    }
+
+    /**
+     * 按加入的顺序遍历同名字段的每个值
+     */
+    template<typename Visitor>
+    void forEachValue(std::string_view header, Visitor &&visitor) const {
+        KnownHeader id = HeaderNames::lookup(header);
+        for (size_t i = firstCandidate(id); i < size_; ++i) {
+            const Entry &entry = at(i);
+            if (matches(entry, id, header))
+                visitor(value(entry));
+        }
+    }
+
+    /**
+     * 移除全部同名字段
+     *
+     * @return 是否移除了字段
+     */
+    bool erase(std::string_view header) {
+        size_t index = find(header);
+        if (index == NOT_FOUND)
+            return false;
+        removeFrom(index, header);
+        return true;
+    }
+
+    /**
+     * 按加入的顺序遍历所有头字段（不复制）
+     *
+     * @param visitor 以头字段的名字与值（std::string_view）为参数的函数
+     */
+    template<typename Visitor>
+    void forEach(Visitor &&visitor) const {
+        for (size_t i = 0; i < size_; ++i) {
+            const Entry &entry = at(i);
+            visitor(name(entry), value(entry));
+        }
+    }
+
+    /**
+     * 字段的个数（同名字段分别计数）
+     */
+    size_t size() const {
+        return size_;
+    }
+
+    allocator_type get_allocator() const {
+        return text_.get_allocator();
+    }
+
+    /**
+     * 返回不包含任何头字段的 HttpHeaders
+     *
+     * @return 不包含任何头字段的 HttpHeaders
+     */
+    static HttpHeaders empty() {
+        return {};
+    }
+
+private:
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    static constexpr uint16_t NO_INDEX = 0xFFFF;
+
+    struct Entry {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t valueOffset;
+        uint32_t valueLength;
+        KnownHeader id;
+    };
+
+    Entry &at(size_t index) {
+        return index < INLINE_CAPACITY ? inline_[index] : overflow_[index - INLINE_CAPACITY];
+    }
+
+    const Entry &at(size_t index) const {
+        return index < INLINE_CAPACITY ? inline_[index] : overflow_[index - INLINE_CAPACITY];
+    }
+
+    std::string_view name(const Entry &entry) const {
+        return std::string_view(text_).substr(entry.nameOffset, entry.nameLength);
+    }
+
+    std::string_view value(const Entry &entry) const {
+        return std::string_view(text_).substr(entry.valueOffset, entry.valueLength);
+    }
+
+    /**
+     * 常见头字段从索引处开始（之前不会有同名字段），其他字段从头开始
+     */
+    size_t firstCandidate(KnownHeader id) const {
+        return id == KnownHeader::UNKNOWN ? 0 : std::min<size_t>(known_[static_cast<size_t>(id)], size_);
+    }
+
+    bool matches(const Entry &entry, KnownHeader id, std::string_view header) const {
+        if (id != KnownHeader::UNKNOWN)
+            return entry.id == id;
+        return entry.id == KnownHeader::UNKNOWN && equalsIgnoreCase(name(entry), header);
+    }
+
+    size_t find(std::string_view header) const {
+        KnownHeader id = HeaderNames::lookup(header);
+        if (id != KnownHeader::UNKNOWN) {
+            size_t index = known_[static_cast<size_t>(id)];
+            return index == NO_INDEX ? NOT_FOUND : index;
+        }
+        for (size_t i = 0; i < size_; ++i) {
+            if (matches(at(i), id, header))
+                return i;
+        }
+        return NOT_FOUND;
+    }
+
+    /**
+     * 移除从 from 开始的全部同名字段，其余字段保持顺序；字符串中的字节不回收
+     */
+    void removeFrom(size_t from, std::string_view header) {
+        KnownHeader id = HeaderNames::lookup(header);
+        size_t kept = from;
+        for (size_t i = from; i < size_; ++i) {
+            if (!matches(at(i), id, header))
+                at(kept++) = at(i);
+        }
+        if (kept == size_)
+            return;
+        size_ = kept;
+        overflow_.resize(size_ > INLINE_CAPACITY ? size_ - INLINE_CAPACITY : 0);
+        reindex();
+    }
+
+    void reindex() {
+        known_.fill(NO_INDEX);
+        for (size_t i = size_; i-- > 0;) {
+            KnownHeader id = at(i).id;
+            if (id != KnownHeader::UNKNOWN)
+                known_[static_cast<size_t>(id)] = static_cast<uint16_t>(i);
+        }
+    }
+
+    std::array<Entry, INLINE_CAPACITY> inline_{};
+
+    std::pmr::vector<Entry> overflow_; // 超过 INLINE_CAPACITY 的字段
+
+    size_t size_ = 0;
+
+    std::pmr::string text_; // 依次保存每个字段的名字与值
+
+    std::array<uint16_t, HeaderNames::COUNT> known_ = emptyIndex(); // 每个常见头字段第一次出现的位置
+
+    static constexpr std::array<uint16_t, HeaderNames::COUNT> emptyIndex() {
+        std::array<uint16_t, HeaderNames::COUNT> index{};
+        index.fill(NO_INDEX);
+        return index;
+    }
+};
+
+#endif //WEBSERVER_HTTP_HEADERS_HPP
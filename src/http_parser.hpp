@@ -0,0 +1,382 @@
+#ifndef WEBSERVER_HTTP_PARSER_HPP
+#define WEBSERVER_HTTP_PARSER_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <src/http_headers.hpp>
+#include <src/simd_scanner.hpp>
+#include <string_view>
+
+/**
+ * 头字段的视图（指向读缓冲区，不持有数据）
+ */
+struct HttpHeaderView {
+    std::string_view name;
+    std::string_view value;
+};
+
+/**
+ * 请求的视图，所有字段都指向连接的读缓冲区
+ *
+ * 读缓冲区被修改或释放后视图失效；缓冲区被移动到别处时可以用 rebased() 重新定位
+ */
+class HttpRequestView {
+public:
+    static constexpr size_t MAX_HEADERS = 64;
+
+    /**
+     * 根据头字段的名字（不区分大小写）获得值
+     *
+     * 常见头字段直接从索引定位，其他字段依次比较
+     *
+     * @param name 头字段的名字
+     * @return 头字段的值（同名字段有多个时为第一个），不存在时为空视图
+     */
+    std::string_view header(std::string_view name) const {
+        if (KnownHeader known = HeaderNames::lookup(name); known != KnownHeader::UNKNOWN)
+            return header(known);
+        for (size_t i = 0; i < headerCount; ++i) {
+            if (equalsIgnoreCase(headers[i].name, name))
+                return headers[i].value;
+        }
+        return {};
+    }
+
+    std::string_view header(KnownHeader name) const {
+        uint8_t index = knownHeaders[static_cast<size_t>(name)];
+        return index == NO_HEADER ? std::string_view() : headers[index].value;
+    }
+
+    bool hasHeader(std::string_view name) const {
+        if (KnownHeader known = HeaderNames::lookup(name); known != KnownHeader::UNKNOWN)
+            return hasHeader(known);
+        for (size_t i = 0; i < headerCount; ++i) {
+            if (equalsIgnoreCase(headers[i].name, name))
+                return true;
+        }
+        return false;
+    }
+
+    bool hasHeader(KnownHeader name) const {
+        return knownHeaders[static_cast<size_t>(name)] != NO_HEADER;
+    }
+
+    /**
+     * 将所有视图从 from 开始的缓冲区平移到 to 开始的缓冲区（两者内容相同）
+     */
+    HttpRequestView rebased(const char *from, const char *to) const {
+        HttpRequestView result = *this;
+        auto shift = [from, to](std::string_view view) -> std::string_view {
+            return view.data() == nullptr ? view : std::string_view(to + (view.data() - from), view.size());
+        };
+        result.method = shift(method);
+        result.url = shift(url);
+        result.version = shift(version);
+        result.body = shift(body);
+        for (size_t i = 0; i < headerCount; ++i) {
+            result.headers[i].name = shift(headers[i].name);
+            result.headers[i].value = shift(headers[i].value);
+        }
+        return result;
+    }
+
+    std::string_view method;
+    std::string_view url;
+    std::string_view version;
+    std::array<HttpHeaderView, MAX_HEADERS> headers;
+    size_t headerCount = 0;
+    std::string_view body;
+
+    static constexpr uint8_t NO_HEADER = 0xFF;
+
+    std::array<uint8_t, HeaderNames::COUNT> knownHeaders{}; // 每个常见头字段第一次出现的位置，不存在时为 NO_HEADER
+};
+
+/**
+ * 解析结果
+ */
+enum class ParseResult {
+    NEED_MORE, // 数据不完整，需要继续接收
+    COMPLETE,  // 已解析出一个完整的请求
+    MALFORMED, // 请求格式错误
+};
+
+/**
+ * 可恢复的增量式 HTTP 请求解析器（状态机）
+ *
+ * 每次收到新数据后用「从请求起始处开始的全部数据」调用 parse()，解析器从上次停下的位置继续；
+ * 解析过程中只记录偏移量，不复制数据也不分配堆内存
+ */
+class HttpParser {
+public:
+    static constexpr size_t MAX_BODY_SIZE = 1024 * 1024;
+
+    /**
+     * 继续解析
+     *
+     * @param buffer 从请求起始处开始的数据（之前传入的部分不能改变）
+     * @return 解析结果
+     */
+    ParseResult parse(std::string_view buffer) {
+        while (true) {
+            switch (state_) {
+                case State::REQUEST_LINE:
+                case State::HEADERS: {
+                    size_t end = findLineEnd(buffer);
+                    if (state_ == State::ERROR)
+                        return ParseResult::MALFORMED;
+                    if (end == std::string_view::npos)
+                        return ParseResult::NEED_MORE;
+
+                    bool ok;
+                    if (state_ == State::REQUEST_LINE) {
+                        ok = parseRequestLine(buffer, end);
+                        state_ = State::HEADERS;
+                    } else if (end == lineStart_) { // 空行，头部结束
+                        bodyStart_ = end + 2;
+                        ok = resolveContentLength(buffer);
+                        state_ = State::BODY;
+                    } else {
+                        ok = parseHeaderLine(buffer, end);
+                    }
+                    if (!ok) {
+                        state_ = State::ERROR;
+                        return ParseResult::MALFORMED;
+                    }
+                    lineStart_ = offset_ = end + 2;
+                    break;
+                }
+                case State::BODY:
+                    if (buffer.size() - bodyStart_ < contentLength_)
+                        return ParseResult::NEED_MORE;
+                    state_ = State::DONE;
+                    break;
+                case State::DONE:
+                    materialize(buffer);
+                    return ParseResult::COMPLETE;
+                case State::ERROR:
+                    return ParseResult::MALFORMED;
+            }
+        }
+    }
+
+    /**
+     * 解析完成的请求（仅在 parse() 返回 COMPLETE 后有效）
+     */
+    const HttpRequestView &request() const {
+        return request_;
+    }
+
+    /**
+     * 完整请求（含请求体）占用的字节数，流水线中的下一个请求从这里开始
+     */
+    size_t consumed() const {
+        return bodyStart_ + contentLength_;
+    }
+
+    /**
+     * 重置状态以解析下一个请求
+     */
+    void reset() {
+        state_ = State::REQUEST_LINE;
+        offset_ = lineStart_ = bodyStart_ = contentLength_ = headerCount_ = 0;
+        request_.headerCount = 0;
+    }
+
+private:
+    enum class State {
+        REQUEST_LINE,
+        HEADERS,
+        BODY,
+        DONE,
+        ERROR,
+    };
+
+    struct Span {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+
+        std::string_view in(std::string_view buffer) const {
+            return buffer.substr(offset, length);
+        }
+    };
+
+    /**
+     * 从 offset_ 开始寻找 CRLF，同时校验行内没有控制字符
+     *
+     * @return '\r' 的位置，数据不完整时返回 npos（遇到 '\r' 以外的控制字符或孤立的 '\r' 时进入 ERROR 状态）
+     */
+    size_t findLineEnd(std::string_view buffer) {
+        if (offset_ >= buffer.size())
+            return std::string_view::npos;
+
+        size_t pos = offset_ + SimdScanner::findControl(buffer.data() + offset_, buffer.size() - offset_);
+        if (pos == buffer.size()) {
+            offset_ = buffer.size();
+            return std::string_view::npos;
+        }
+        if (buffer[pos] != '\r') {
+            state_ = State::ERROR;
+            return std::string_view::npos;
+        }
+        if (pos + 1 == buffer.size()) { // '\n' 还没到，下次从 '\r' 处继续
+            offset_ = pos;
+            return std::string_view::npos;
+        }
+        if (buffer[pos + 1] != '\n') {
+            state_ = State::ERROR;
+            return std::string_view::npos;
+        }
+        return pos;
+    }
+
+    static size_t find(std::string_view s, char c, size_t from = 0) {
+        size_t pos = from + SimdScanner::findChar(s.data() + from, s.size() - from, c);
+        return pos == s.size() ? std::string_view::npos : pos;
+    }
+
+    static constexpr std::array<bool, 256> TOKEN_CHARS = []() {
+        std::array<bool, 256> table{};
+        for (int c = '0'; c <= '9'; ++c)
+            table[c] = true;
+        for (int c = 'a'; c <= 'z'; ++c)
+            table[c] = table[c - 'a' + 'A'] = true;
+        for (char c: std::string_view("!#$%&'*+-.^_`|~"))
+            table[static_cast<unsigned char>(c)] = true;
+        return table;
+    }();
+
+    static bool isTokenChar(char c) {
+        return TOKEN_CHARS[static_cast<unsigned char>(c)];
+    }
+
+    static bool isToken(std::string_view s) {
+        if (s.empty())
+            return false;
+        for (char c: s) {
+            if (!isTokenChar(c))
+                return false;
+        }
+        return true;
+    }
+
+    static Span span(size_t offset, size_t length) {
+        return {static_cast<uint32_t>(offset), static_cast<uint32_t>(length)};
+    }
+
+    // Method SP Request-URI SP HTTP-Version
+    bool parseRequestLine(std::string_view buffer, size_t end) {
+        std::string_view line = buffer.substr(lineStart_, end - lineStart_);
+
+        size_t firstSpace = find(line, ' ');
+        if (firstSpace == std::string_view::npos)
+            return false;
+        size_t secondSpace = find(line, ' ', firstSpace + 1);
+        if (secondSpace == std::string_view::npos)
+            return false;
+
+        std::string_view method = line.substr(0, firstSpace);
+        std::string_view url = line.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+        std::string_view version = line.substr(secondSpace + 1);
+
+        // 行内的控制字符已由 findLineEnd() 排除
+        if (!isToken(method) || url.empty() || url.find('\t') != std::string_view::npos)
+            return false;
+        if (version.size() != 8 || version.substr(0, 7) != "HTTP/1." || version[7] < '0' || version[7] > '9')
+            return false;
+
+        method_ = span(lineStart_, method.size());
+        url_ = span(lineStart_ + firstSpace + 1, url.size());
+        version_ = span(lineStart_ + secondSpace + 1, version.size());
+        return true;
+    }
+
+    // field-name ":" OWS field-value OWS
+    bool parseHeaderLine(std::string_view buffer, size_t end) {
+        if (headerCount_ == HttpRequestView::MAX_HEADERS)
+            return false;
+
+        std::string_view line = buffer.substr(lineStart_, end - lineStart_);
+        size_t colon = find(line, ':');
+        if (colon == std::string_view::npos || !isToken(line.substr(0, colon)))
+            return false;
+
+        size_t valueBegin = colon + 1, valueEnd = line.size();
+        while (valueBegin < valueEnd && (line[valueBegin] == ' ' || line[valueBegin] == '\t'))
+            ++valueBegin;
+        while (valueEnd > valueBegin && (line[valueEnd - 1] == ' ' || line[valueEnd - 1] == '\t'))
+            --valueEnd;
+
+        headerIds_[headerCount_] = HeaderNames::lookup(line.substr(0, colon));
+        headerNames_[headerCount_] = span(lineStart_, colon);
+        headerValues_[headerCount_] = span(lineStart_ + valueBegin, valueEnd - valueBegin);
+        ++headerCount_;
+        return true;
+    }
+
+    bool resolveContentLength(std::string_view buffer) {
+        bool found = false;
+        for (size_t i = 0; i < headerCount_; ++i) {
+            if (headerIds_[i] == KnownHeader::TRANSFER_ENCODING) // 暂不支持分块传输
+                return false;
+            if (headerIds_[i] != KnownHeader::CONTENT_LENGTH)
+                continue;
+
+            std::string_view value = headerValues_[i].in(buffer);
+            if (value.empty())
+                return false;
+            size_t length = 0;
+            for (char c: value) {
+                if (c < '0' || c > '9')
+                    return false;
+                length = length * 10 + (c - '0');
+                if (length > MAX_BODY_SIZE)
+                    return false;
+            }
+            if (found && length != contentLength_) // 多个不一致的 Content-Length
+                return false;
+            found = true;
+            contentLength_ = length;
+        }
+        return true;
+    }
+
+    void materialize(std::string_view buffer) {
+        request_.method = method_.in(buffer);
+        request_.url = url_.in(buffer);
+        request_.version = version_.in(buffer);
+        request_.headerCount = headerCount_;
+        request_.knownHeaders.fill(HttpRequestView::NO_HEADER);
+        for (size_t i = headerCount_; i-- > 0;) {
+            request_.headers[i] = {headerNames_[i].in(buffer), headerValues_[i].in(buffer)};
+            if (headerIds_[i] != KnownHeader::UNKNOWN)
+                request_.knownHeaders[static_cast<size_t>(headerIds_[i])] = static_cast<uint8_t>(i);
+        }
+        request_.body = buffer.substr(bodyStart_, contentLength_);
+    }
+
+    State state_ = State::REQUEST_LINE;
+
+    size_t offset_ = 0; // 下一次扫描的起始位置
+
+    size_t lineStart_ = 0; // 当前行的起始位置
+
+    size_t bodyStart_ = 0;
+
+    size_t contentLength_ = 0;
+
+    Span method_, url_, version_;
+
+    std::array<Span, HttpRequestView::MAX_HEADERS> headerNames_;
+
+    std::array<Span, HttpRequestView::MAX_HEADERS> headerValues_;
+
+    std::array<KnownHeader, HttpRequestView::MAX_HEADERS> headerIds_{}; // 解析头字段时顺便识别常见名字
+
+    size_t headerCount_ = 0;
+
+    HttpRequestView request_;
+};
+
+#endif //WEBSERVER_HTTP_PARSER_HPP
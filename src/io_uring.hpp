@@ -0,0 +1,449 @@
+#ifndef WEBSERVER_IO_URING_HPP
+#define WEBSERVER_IO_URING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <initializer_list>
+#include <linux/io_uring.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+/**
+ * io_uring 提交/完成队列的最小封装（直接使用系统调用，不依赖 liburing）
+ *
+ * 只能由一个线程使用：准备好的请求先留在提交队列中，由 submitAndWait() 一次 io_uring_enter 全部提交并等待完成，
+ * 一轮事件处理中产生的所有 I/O 因此合并为一次系统调用
+ */
+class IoUring {
+public:
+    /**
+     * @param entries 提交队列长度（完成队列是它的 4 倍，多次触发的请求会产生大量完成事件）
+     */
+    explicit IoUring(unsigned entries = 256) {
+        io_uring_params params{};
+        params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN |
+                       IORING_SETUP_SINGLE_ISSUER;
+        params.cq_entries = entries * 4;
+        ringFd_ = setup(entries, params);
+        if (ringFd_ < 0 && errno == EINVAL) { // 较旧的内核不支持部分标志
+            params = {};
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = entries * 4;
+            ringFd_ = setup(entries, params);
+        }
+        if (ringFd_ < 0) {
+            throw std::runtime_error(std::string("Fail to create io_uring: ") + strerror(errno));
+        }
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+            ::close(ringFd_);
+            throw std::runtime_error("io_uring lacks required features");
+        }
+
+        ringSize_ = std::max(params.sq_off.array + params.sq_entries * sizeof(uint32_t),
+                             params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        ring_ = mmap(nullptr, ringSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+                     IORING_OFF_SQ_RING);
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe *>(mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                                                 MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES));
+        if (ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+            unmap();
+            ::close(ringFd_);
+            throw std::runtime_error("Fail to map io_uring");
+        }
+
+        auto *base = static_cast<char *>(ring_);
+        sqHead_ = reinterpret_cast<unsigned *>(base + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned *>(base + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned *>(base + params.sq_off.ring_mask);
+        sqEntries_ = params.sq_entries;
+        cqHead_ = reinterpret_cast<unsigned *>(base + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned *>(base + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned *>(base + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(base + params.cq_off.cqes);
+
+        // 请求总是按顺序填入，提交数组固定为恒等映射
+        auto *array = reinterpret_cast<unsigned *>(base + params.sq_off.array);
+        for (unsigned i = 0; i < sqEntries_; ++i) {
+            array[i] = i;
+        }
+        sqeTail_ = *sqTail_;
+    }
+
+    IoUring(const IoUring &) = delete;
+
+    IoUring &operator=(const IoUring &) = delete;
+
+    ~IoUring() {
+        unmap();
+        ::close(ringFd_);
+    }
+
+    /**
+     * 内核是否支持本服务器用到的全部特性：多次触发的 accept/recv（6.0）、提供缓冲区环、稀疏注册文件表等
+     */
+    static bool isSupported() {
+        struct utsname name{};
+        int major = 0, minor = 0;
+        if (uname(&name) != 0 || sscanf(name.release, "%d.%d", &major, &minor) != 2 || major < 6)
+            return false;
+        try {
+            IoUring ring(8);
+            return ring.registerSparseFiles(1) && ring.probe({IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SENDMSG,
+                                                              IORING_OP_READ, IORING_OP_CLOSE,
+                                                              IORING_OP_ASYNC_CANCEL, IORING_OP_POLL_ADD});
+        } catch (const std::exception &) {
+            return false;
+        }
+    }
+
+    /**
+     * 取得下一个空闲的提交项（已清零），提交队列满时先提交已准备的请求
+     */
+    io_uring_sqe *sqe() {
+        if (sqeTail_ - std::atomic_ref<unsigned>(*sqHead_).load(std::memory_order_acquire) == sqEntries_) {
+            submitAndWait(0, -1);
+        }
+        io_uring_sqe *sqe = &sqes_[sqeTail_ & sqMask_];
+        memset(sqe, 0, sizeof(*sqe));
+        ++sqeTail_;
+        return sqe;
+    }
+
+    /**
+     * 提交全部已准备的请求，并等待至少 waitNr 个完成事件
+     *
+     * @param timeoutMs 等待的超时（毫秒），-1 表示不限
+     * @return 提交的请求数，失败时为 -errno（超时与被信号中断不算失败）
+     */
+    int submitAndWait(unsigned waitNr, int timeoutMs) {
+        unsigned toSubmit = sqeTail_ - submitted_;
+        std::atomic_ref<unsigned>(*sqTail_).store(sqeTail_, std::memory_order_release);
+
+        unsigned flags = waitNr > 0 ? IORING_ENTER_GETEVENTS : 0;
+        __kernel_timespec ts{};
+        io_uring_getevents_arg arg{};
+        if (waitNr > 0 && timeoutMs >= 0) {
+            ts.tv_sec = timeoutMs / 1000;
+            ts.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000;
+            arg.sigmask_sz = _NSIG / 8;
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+            flags |= IORING_ENTER_EXT_ARG;
+        }
+        if (toSubmit == 0 && waitNr == 0)
+            return 0;
+
+        long ret = syscall(__NR_io_uring_enter, ringFd_, toSubmit, waitNr, flags,
+                           (flags & IORING_ENTER_EXT_ARG) ? static_cast<void *>(&arg) : nullptr,
+                           (flags & IORING_ENTER_EXT_ARG) ? sizeof(arg) : _NSIG / 8);
+        if (ret < 0) {
+            if (errno == ETIME || errno == EINTR)
+                return 0;
+            return -errno;
+        }
+        submitted_ += static_cast<unsigned>(ret);
+        return static_cast<int>(ret);
+    }
+
+    /**
+     * 依次处理完成队列中的全部事件
+     *
+     * @param handler 形如 void(const io_uring_cqe &) 的处理函数，其中可以继续准备新的请求
+     * @return 处理的事件数
+     */
+    template<typename Handler>
+    unsigned forEachCompletion(Handler &&handler) {
+        unsigned count = 0;
+        while (true) {
+            unsigned head = *cqHead_;
+            unsigned tail = std::atomic_ref<unsigned>(*cqTail_).load(std::memory_order_acquire);
+            if (head == tail)
+                return count;
+            for (; head != tail; ++head, ++count) {
+                handler(cqes_[head & cqMask_]);
+                std::atomic_ref<unsigned>(*cqHead_).store(head + 1, std::memory_order_release);
+            }
+        }
+    }
+
+    /**
+     * 多次触发的 accept：一次提交，每个新连接产生一个完成事件（res 为新连接的文件描述符）
+     */
+    void acceptMultishot(int fd, uint64_t userData) {
+        io_uring_sqe *s = prepare(IORING_OP_ACCEPT, fd, userData);
+        s->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        s->ioprio = IORING_ACCEPT_MULTISHOT;
+    }
+
+    /**
+     * 多次触发的 recv，每次收到数据时从 group 指定的缓冲区环中取一个缓冲区
+     */
+    void recvMultishot(int fd, uint16_t group, uint64_t userData) {
+        io_uring_sqe *s = prepare(IORING_OP_RECV, fd, userData);
+        s->flags |= IOSQE_BUFFER_SELECT;
+        s->buf_group = group;
+        s->ioprio = IORING_RECV_MULTISHOT;
+    }
+
+    /**
+     * 发送 msghdr 描述的全部数据（MSG_WAITALL：内核负责部分写入后的重试，结果不足时断开链接）
+     *
+     * @param link 是否与下一个请求链接（本请求成功后才执行下一个）
+     */
+    void sendmsg(int fd, const msghdr *message, uint64_t userData, bool link = false) {
+        io_uring_sqe *s = prepare(IORING_OP_SENDMSG, fd, userData);
+        s->addr = reinterpret_cast<uint64_t>(message);
+        s->len = 1;
+        s->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        if (link)
+            s->flags |= IOSQE_IO_LINK;
+    }
+
+    /**
+     * 从文件读取
+     *
+     * @param fixed fd 是否为注册文件表中的下标
+     */
+    void read(int fd, bool fixed, void *buffer, unsigned length, uint64_t offset, uint64_t userData) {
+        io_uring_sqe *s = prepare(IORING_OP_READ, fd, userData);
+        s->addr = reinterpret_cast<uint64_t>(buffer);
+        s->len = length;
+        s->off = offset;
+        if (fixed)
+            s->flags |= IOSQE_FIXED_FILE;
+    }
+
+    void close(int fd, uint64_t userData) {
+        prepare(IORING_OP_CLOSE, fd, userData);
+    }
+
+    /**
+     * 取消该文件描述符上的全部请求
+     *
+     * @param hardLink 无论取消结果如何都执行下一个请求
+     */
+    void cancelFd(int fd, uint64_t userData, bool hardLink = false) {
+        io_uring_sqe *s = prepare(IORING_OP_ASYNC_CANCEL, fd, userData);
+        s->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        if (hardLink)
+            s->flags |= IOSQE_IO_HARDLINK;
+    }
+
+    /**
+     * 多次触发的 poll（每次就绪产生一个完成事件）
+     */
+    void pollMultishot(int fd, uint32_t events, uint64_t userData) {
+        io_uring_sqe *s = prepare(IORING_OP_POLL_ADD, fd, userData);
+        s->poll32_events = events;
+        s->len = IORING_POLL_ADD_MULTI;
+    }
+
+    /**
+     * 注册一张空的文件表，之后用 updateFile() 填入
+     */
+    bool registerSparseFiles(unsigned count) {
+        io_uring_rsrc_register reg{};
+        reg.nr = count;
+        reg.flags = IORING_RSRC_REGISTER_SPARSE;
+        return doRegister(IORING_REGISTER_FILES2, &reg, sizeof(reg)) == 0;
+    }
+
+    /**
+     * 把文件描述符放入注册文件表的 slot 处（替换原有的文件）；
+     * 表中保存的是文件本身的引用，之后原描述符被关闭或复用都不影响已注册的文件
+     */
+    bool updateFile(unsigned slot, int fd) {
+        io_uring_files_update update{};
+        update.offset = slot;
+        update.fds = reinterpret_cast<uint64_t>(&fd);
+        return doRegister(IORING_REGISTER_FILES_UPDATE, &update, 1) == 1;
+    }
+
+    int doRegister(unsigned opcode, void *arg, unsigned count) {
+        return static_cast<int>(syscall(__NR_io_uring_register, ringFd_, opcode, arg, count));
+    }
+
+    int fd() const {
+        return ringFd_;
+    }
+
+private:
+    static int setup(unsigned entries, io_uring_params &params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    }
+
+    io_uring_sqe *prepare(uint8_t opcode, int fd, uint64_t userData) {
+        io_uring_sqe *s = sqe();
+        s->opcode = opcode;
+        s->fd = fd;
+        s->user_data = userData;
+        return s;
+    }
+
+    bool probe(std::initializer_list<uint8_t> opcodes) {
+        constexpr unsigned OPS = 256;
+        alignas(io_uring_probe) char buffer[sizeof(io_uring_probe) + OPS * sizeof(io_uring_probe_op)]{};
+        auto *p = reinterpret_cast<io_uring_probe *>(buffer);
+        if (doRegister(IORING_REGISTER_PROBE, p, OPS) != 0)
+            return false;
+        for (uint8_t op: opcodes) {
+            if (op > p->last_op || !(p->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        }
+        return true;
+    }
+
+    void unmap() {
+        if (ring_ != MAP_FAILED)
+            munmap(ring_, ringSize_);
+        if (sqes_ != MAP_FAILED)
+            munmap(sqes_, sqesSize_);
+    }
+
+    int ringFd_;
+
+    void *ring_ = MAP_FAILED;
+
+    size_t ringSize_ = 0;
+
+    io_uring_sqe *sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+
+    size_t sqesSize_ = 0;
+
+    unsigned *sqHead_ = nullptr;
+
+    unsigned *sqTail_ = nullptr;
+
+    unsigned sqMask_ = 0;
+
+    unsigned sqEntries_ = 0;
+
+    unsigned sqeTail_ = 0; // 已准备的请求（尚未对内核可见）
+
+    unsigned submitted_ = 0;
+
+    unsigned *cqHead_ = nullptr;
+
+    unsigned *cqTail_ = nullptr;
+
+    unsigned cqMask_ = 0;
+
+    io_uring_cqe *cqes_ = nullptr;
+};
+
+/**
+ * 提供给内核的接收缓冲区环（IORING_REGISTER_PBUF_RING）
+ *
+ * 多次触发的 recv 收到数据时由内核从环中挑选缓冲区，完成事件中带回缓冲区编号；
+ * 连接不必各自预留接收缓冲区，数据取走后立即归还
+ */
+class BufferRing {
+public:
+    /**
+     * @param count 缓冲区个数（2 的幂）
+     * @param size 每个缓冲区的大小
+     */
+    BufferRing(IoUring &ring, uint16_t group, unsigned count, unsigned size)
+            : ring_(ring), group_(group), count_(count), size_(size) {
+        ringSize_ = count * sizeof(io_uring_buf);
+        entries_ = static_cast<io_uring_buf_ring *>(mmap(nullptr, ringSize_, PROT_READ | PROT_WRITE,
+                                                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (entries_ == MAP_FAILED) {
+            throw std::runtime_error("Fail to allocate buffer ring");
+        }
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<uint64_t>(entries_);
+        reg.ring_entries = count;
+        reg.bgid = group;
+        if (ring_.doRegister(IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+            munmap(entries_, ringSize_);
+            throw std::runtime_error("Fail to register buffer ring");
+        }
+
+        storage_.reset(new char[static_cast<size_t>(count) * size]);
+        for (unsigned i = 0; i < count; ++i) {
+            add(static_cast<uint16_t>(i), i);
+        }
+        publish(count);
+    }
+
+    BufferRing(const BufferRing &) = delete;
+
+    BufferRing &operator=(const BufferRing &) = delete;
+
+    ~BufferRing() {
+        io_uring_buf_reg reg{};
+        reg.bgid = group_;
+        ring_.doRegister(IORING_UNREGISTER_PBUF_RING, &reg, 1);
+        munmap(entries_, ringSize_);
+    }
+
+    /**
+     * 完成事件中的缓冲区编号
+     */
+    static uint16_t bufferId(uint32_t cqeFlags) {
+        return static_cast<uint16_t>(cqeFlags >> IORING_CQE_BUFFER_SHIFT);
+    }
+
+    std::string_view data(uint16_t id, size_t length) const {
+        return {storage_.get() + static_cast<size_t>(id) * size_, length};
+    }
+
+    /**
+     * 归还缓冲区，内核可以再次使用
+     */
+    void recycle(uint16_t id) {
+        add(id, 0);
+        publish(1);
+    }
+
+    uint16_t group() const {
+        return group_;
+    }
+
+private:
+    void add(uint16_t id, unsigned offset) {
+        // 头文件中的 bufs 是联合体里的柔性数组，按 C++ 规则编译时偏移量不为 0，这里直接按数组访问
+        io_uring_buf &buf = reinterpret_cast<io_uring_buf *>(entries_)[(tail_ + offset) & (count_ - 1)];
+        buf.addr = reinterpret_cast<uint64_t>(storage_.get() + static_cast<size_t>(id) * size_);
+        buf.len = size_;
+        buf.bid = id;
+    }
+
+    void publish(unsigned added) {
+        tail_ += added;
+        std::atomic_ref<uint16_t>(entries_->tail).store(tail_, std::memory_order_release);
+    }
+
+    IoUring &ring_;
+
+    uint16_t group_;
+
+    unsigned count_;
+
+    unsigned size_;
+
+    io_uring_buf_ring *entries_;
+
+    size_t ringSize_;
+
+    std::unique_ptr<char[]> storage_;
+
+    uint16_t tail_ = 0;
+};
+
+#endif //WEBSERVER_IO_URING_HPP
@@ -5,15 +5,37 @@
 #ifndef WEBSERVER_LOG_HPP
 #define WEBSERVER_LOG_HPP
 
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
 #include <fmt/chrono.h>
 #include <fmt/core.h>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <src/clock.hpp>
+#include <src/ring_buffer.hpp>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
+/**
+ * 编译期的最低日志等级（0 为 DEBUG），低于该等级的日志调用在编译时被完全移除
+ *
+ * Release 构建默认定义为 1，去掉所有 DEBUG 日志
+ */
+#ifndef WEBSERVER_LOG_MIN_LEVEL
+#define WEBSERVER_LOG_MIN_LEVEL 0
+#endif
+
 /**
  * 日志等级（DEBUG 最低，FATAL 最高）
  */
@@ -37,6 +59,157 @@ public:
     std::string content_;
 };
 
+template<typename ...Args>
+class LogFormat;
+
+/**
+ * 二进制日志记录
+ *
+ * 生产者只保存格式串（必须是字符串字面量）与原始参数：算术类型按字节复制，字符串复制内容，
+ * 其他类型先格式化为字符串；真正的格式化推迟到 formatContent()，通常在后台线程中进行；
+ * 参数不超过 INLINE_SIZE 字节时不分配堆内存
+ */
+class LogRecord {
+public:
+    static constexpr size_t INLINE_SIZE = 192;
+
+    LogRecord() = default;
+
+    /**
+     * 捕获一条日志
+     *
+     * @param format 格式串，必须在记录被格式化之前一直有效（字符串字面量）
+     */
+    template<typename ...Args>
+    static LogRecord capture(LogLevel level, std::string_view format, const Args &... args) {
+        LogRecord record;
+        record.level = level;
+        record.time = CachedClock::now();
+        record.format_ = format;
+        record.formatter_ = &formatArgs<Stored<Args>...>;
+
+        auto prepared = std::make_tuple(prepare(args)...);
+        size_t size = std::apply([](const auto &... values) { return (size_t(0) + ... + encodedSize(values)); },
+                                 prepared);
+        char *data = record.data_;
+        if (size > INLINE_SIZE) {
+            record.overflow_.resize(size);
+            data = record.overflow_.data();
+        }
+        std::apply([&data](const auto &... values) { (encode(data, values), ...); }, prepared);
+        return record;
+    }
+
+    /**
+     * 不含格式的纯文本日志
+     */
+    static LogRecord text(LogLevel level, std::string_view content) {
+        return capture(level, "{}", content);
+    }
+
+    /**
+     * 把日志内容（不含时间与等级）追加到 out 末尾
+     */
+    void formatContent(std::string &out) const {
+        if (formatter_ != nullptr)
+            formatter_(out, format_, overflow_.empty() ? data_ : overflow_.data());
+    }
+
+    std::string content() const {
+        std::string out;
+        formatContent(out);
+        return out;
+    }
+
+    LogLevel level = LogLevel::DEBUG;
+
+    std::time_t time = 0;
+
+private:
+    // 按字节保存的参数类型，其余类型都以字符串保存
+    template<typename T>
+    static constexpr bool isTrivial = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+    template<typename T>
+    using Stored = std::conditional_t<isTrivial<std::decay_t<T>>, std::decay_t<T>, std::string_view>;
+
+    template<typename T>
+    static auto prepare(const T &value) {
+        if constexpr (isTrivial<T>) {
+            return value;
+        } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+            return std::string_view(value);
+        } else {
+            return fmt::format("{}", value);
+        }
+    }
+
+    template<typename T>
+    static size_t encodedSize(const T &value) {
+        if constexpr (isTrivial<T>) {
+            return sizeof(T);
+        } else {
+            return sizeof(uint32_t) + value.size();
+        }
+    }
+
+    template<typename T>
+    static void encode(char *&data, const T &value) {
+        if constexpr (isTrivial<T>) {
+            std::memcpy(data, &value, sizeof(T));
+            data += sizeof(T);
+        } else {
+            auto size = static_cast<uint32_t>(value.size());
+            std::memcpy(data, &size, sizeof(size));
+            std::memcpy(data + sizeof(size), value.data(), size);
+            data += sizeof(size) + size;
+        }
+    }
+
+    template<typename T>
+    static T decode(const char *&data) {
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            uint32_t size;
+            std::memcpy(&size, data, sizeof(size));
+            std::string_view value(data + sizeof(size), size);
+            data += sizeof(size) + size;
+            return value;
+        } else {
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+            data += sizeof(T);
+            return value;
+        }
+    }
+
+    template<typename ...Stored>
+    static void formatArgs(std::string &out, std::string_view format, const char *data) {
+        // 花括号初始化保证从左到右依次解码
+        std::tuple<Stored...> values{decode<Stored>(data)...};
+        size_t size = out.size();
+        try {
+            std::apply([&out, format](const auto &... args) {
+                fmt::vformat_to(std::back_inserter(out), format, fmt::make_format_args(args...));
+            }, values);
+        } catch (const fmt::format_error &e) {
+            // 通常在后台线程中，不能让异常终止进程：丢掉已写出的部分，原样输出格式串
+            out.resize(size);
+            out.append("<format error: ").append(e.what()).append("> ").append(format);
+        }
+    }
+
+    template<typename ...Args>
+    friend class LogFormat;
+
+    std::string_view format_;
+
+    void (*formatter_)(std::string &, std::string_view, const char *) = nullptr;
+
+    alignas(8) char data_[INLINE_SIZE];
+
+    std::string overflow_; // 参数放不下时使用
+};
+
 /**
  * 将 LogEvent 格式化为「可打印」的日志信息
  */
@@ -45,29 +218,45 @@ public:
     explicit LogFormatter(LogLevel level) : level_(level) {}
 
     std::string format(LogLevel level, std::shared_ptr<LogEvent> logEvent) {
-        std::stringstream ss;
+        std::string line;
+        formatTo(line, level, logEvent->content_, CachedClock::now());
+        return line;
+    }
+
+    /**
+     * 把一条日志追加到 out 末尾（不含换行），批量格式化时复用同一个缓冲区
+     *
+     * @param time 日志产生的时间
+     */
+    void formatTo(std::string &out, LogLevel level, std::string_view content, std::time_t time) {
+        formatPrefix(out, level, time);
+        out.append(content);
+    }
+
+    void formatTo(std::string &out, const LogRecord &record) {
+        formatPrefix(out, record.level, record.time);
+        record.formatContent(out);
+    }
 
-        ss << fmt::format("{:%Y-%m-%d %H:%M:%S}. [", fmt::localtime(std::time(nullptr)));
+    static void formatPrefix(std::string &out, LogLevel level, std::time_t time) {
+        // 时间戳每秒只格式化一次
+        out.append(CachedClock::logTimestamp(time)).append(". [").append(levelName(level)).append("] : ");
+    }
+
+    static std::string_view levelName(LogLevel level) {
         switch (level) {
             case LogLevel::DEBUG:
-                ss << "DEBUG  ";
-                break;
+                return "DEBUG  ";
             case LogLevel::INFO:
-                ss << "INFO   ";
-                break;
+                return "INFO   ";
             case LogLevel::WARNING:
-                ss << "WARNING";
-                break;
+                return "WARNING";
             case LogLevel::ERROR:
-                ss << "ERROR  ";
-                break;
+                return "ERROR  ";
             case LogLevel::FATAL:
-                ss << "FATAL  ";
-                break;
+                return "FATAL  ";
         }
-        ss << "] : " << logEvent->content_;
-
-        return ss.str();
+        return "";
     }
 
 private:
@@ -88,6 +277,33 @@ public:
 
     virtual void log(LogLevel level, std::shared_ptr<LogEvent> logEvent) = 0;
 
+    /**
+     * 输出二进制日志记录，默认在当前线程中格式化后立即写出并刷新
+     */
+    virtual void append(LogRecord &&record) {
+        if (record.level < level_) {
+            return;
+        }
+
+        std::string line;
+        formatter_->formatTo(line, record);
+        line.push_back('\n');
+        write(line);
+        flush();
+    }
+
+    /**
+     * 直接写出已格式化的文本（每行以换行结尾），不做等级过滤，也不立即刷新，需要时由调用方调用 flush()
+     *
+     * 默认实现丢弃文本
+     */
+    virtual void write(std::string_view /*text*/) {}
+
+    /**
+     * 刷新输出缓冲区
+     */
+    virtual void flush() {}
+
 protected:
     LogLevel level_;
     std::shared_ptr<LogFormatter> formatter_;
@@ -109,6 +325,14 @@ public:
         std::cout << formatter_->format(level, logEvent) << std::endl;
     }
 
+    void write(std::string_view text) override {
+        std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    void flush() override {
+        std::cout.flush();
+    }
+
     ~TerminalLogAppender() override = default;
 };
 
@@ -128,6 +352,14 @@ public:
         file_ << formatter_->format(level, logEvent) << std::endl;
     }
 
+    void write(std::string_view text) override {
+        file_.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    void flush() override {
+        file_.flush();
+    }
+
     ~FileLogAppender() override {
         file_.close();
     }
@@ -137,31 +369,247 @@ private:
     std::ofstream file_;
 };
 
+/**
+ * 队列满时的处理策略
+ */
+enum class LogOverflowPolicy {
+    DROP,  // 丢弃新日志并计数，生产者从不等待
+    BLOCK, // 等待后台线程腾出空间
+};
+
+/**
+ * 异步日志输出器
+ *
+ * 生产者只把日志事件放进无锁环形队列（不格式化、不做 I/O），由后台线程批量取出，
+ * 格式化到同一个缓冲区后一次写给下游输出器，队列空闲时才刷新；
+ * 生产者只在后台线程休眠时才去唤醒它
+ */
+class AsyncLogAppender : public LogAppender {
+public:
+    /**
+     * @param sink 实际写出日志的输出器（只在后台线程中使用）
+     * @param capacity 队列容量（条）
+     * @param policy 队列满时的处理策略
+     */
+    AsyncLogAppender(std::shared_ptr<LogFormatter> formatter, LogLevel level, std::shared_ptr<LogAppender> sink,
+                     size_t capacity = 4096, LogOverflowPolicy policy = LogOverflowPolicy::DROP)
+            : LogAppender(std::move(formatter), level), sink_(std::move(sink)), queue_(capacity), policy_(policy) {
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~AsyncLogAppender() override {
+        {
+            const std::lock_guard<std::mutex> lockGuard(mutex_);
+            isStopped_ = true;
+        }
+        wakeup_.notify_one();
+        thread_.join();
+    }
+
+    void log(LogLevel level, std::shared_ptr<LogEvent> logEvent) override {
+        if (level < level_) {
+            return;
+        }
+
+        append(LogRecord::text(level, logEvent->content_));
+    }
+
+    void append(LogRecord &&record) override {
+        if (record.level < level_) {
+            return;
+        }
+
+        while (!queue_.tryPush(std::move(record))) {
+            if (policy_ == LogOverflowPolicy::DROP) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            notify();
+            std::this_thread::yield();
+        }
+        notify();
+    }
+
+    /**
+     * 等待调用前提交的日志全部写出并刷新
+     */
+    void flush() override {
+        size_t target = queue_.pushed();
+        std::unique_lock<std::mutex> lock(mutex_);
+        flushRequested_ = true;
+        wakeup_.notify_one();
+        flushed_.wait(lock, [this, target]() { return written_ >= target; });
+    }
+
+    /**
+     * 因队列满而丢弃的日志条数
+     */
+    size_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t MAX_BATCH_BYTES = 64 * 1024;
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!isSleeping_.load(std::memory_order_seq_cst))
+            return;
+        {
+            const std::lock_guard<std::mutex> lockGuard(mutex_);
+            isSleeping_.store(false, std::memory_order_relaxed);
+        }
+        wakeup_.notify_one();
+    }
+
+    void run() {
+        std::string batch;
+        LogRecord record;
+        size_t count = 0; // 已写出的条数（只在本线程中修改）
+
+        while (true) {
+            // 批量取出并格式化，攒够一批再写，减少系统调用次数
+            while (queue_.tryPop(record)) {
+                formatter_->formatTo(batch, record);
+                batch.push_back('\n');
+                ++count;
+                if (batch.size() >= MAX_BATCH_BYTES) {
+                    sink_->write(batch);
+                    batch.clear();
+                }
+            }
+            if (!batch.empty()) {
+                sink_->write(batch);
+                batch.clear();
+            }
+            // 队列已空，刷新一次
+            sink_->flush();
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            written_ = count;
+            flushRequested_ = false;
+            flushed_.notify_all();
+            if (isStopped_ && queue_.empty())
+                return;
+
+            isSleeping_.store(true, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // 登记休眠后再检查一次队列，与生产者先入队再检查 isSleeping_ 的顺序配合；超时兜底
+            if (queue_.empty() && !flushRequested_) {
+                wakeup_.wait_for(lock, std::chrono::milliseconds(100), [this]() {
+                    return !isSleeping_.load(std::memory_order_relaxed) || isStopped_ || flushRequested_;
+                });
+            }
+            isSleeping_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    std::shared_ptr<LogAppender> sink_;
+
+    RingBuffer<LogRecord> queue_;
+
+    LogOverflowPolicy policy_;
+
+    std::atomic<size_t> dropped_{0};
+
+    std::mutex mutex_;
+
+    std::condition_variable wakeup_;
+
+    std::condition_variable flushed_;
+
+    std::atomic<bool> isSleeping_{false};
+
+    bool isStopped_ = false;
+
+    bool flushRequested_ = false;
+
+    size_t written_ = 0; // 由 mutex_ 保护
+
+    std::thread thread_;
+};
+
+/**
+ * Logger 的格式串
+ *
+ * 只能由字符串字面量构造，fmt::runtime() 与 std::string 都不行：LogRecord 只保存格式串的视图，
+ * 格式化时运行期的字符串可能已经被释放。格式串在编译期按参数实际保存的类型校验，
+ * 非算术类型的参数在捕获时已格式化为字符串，只对原类型有效的格式说明（如 {:%H:%M}）因此在编译时报错
+ */
+template<typename ...Args>
+class LogFormat {
+public:
+    template<size_t N>
+    consteval LogFormat(const char (&format)[N]) : format_(format) { // NOLINT(google-explicit-constructor)
+        [[maybe_unused]] fmt::format_string<LogRecord::Stored<Args>...> check(format);
+    }
+
+    std::string_view get() const {
+        return format_;
+    }
+
+private:
+    std::string_view format_;
+};
+
 /**
  * 日志类
+ *
+ * 先检查等级再捕获参数，被过滤的日志不做任何格式化；格式串在编译期校验，见 LogFormat
  */
 class Logger {
 public:
     Logger(LogLevel level, std::shared_ptr<LogAppender> appender) : level_(level), appender_(std::move(appender)) {}
 
-    void debug(const std::string &content) {
-        appender_->log(LogLevel::DEBUG, std::make_shared<LogEvent>(content));
+    template<typename ...Args>
+    void debug(LogFormat<std::type_identity_t<Args>...> format, const Args &... args) {
+        write<LogLevel::DEBUG>(format.get(), args...);
     }
 
-    void info(const std::string &content) {
-        appender_->log(LogLevel::INFO, std::make_shared<LogEvent>(content));
+    template<typename ...Args>
+    void info(LogFormat<std::type_identity_t<Args>...> format, const Args &... args) {
+        write<LogLevel::INFO>(format.get(), args...);
     }
 
-    void warning(const std::string &content) {
-        appender_->log(LogLevel::WARNING, std::make_shared<LogEvent>(content));
+    template<typename ...Args>
+    void warning(LogFormat<std::type_identity_t<Args>...> format, const Args &... args) {
+        write<LogLevel::WARNING>(format.get(), args...);
     }
 
-    void error(const std::string &content) {
-        appender_->log(LogLevel::ERROR, std::make_shared<LogEvent>(content));
+    template<typename ...Args>
+    void error(LogFormat<std::type_identity_t<Args>...> format, const Args &... args) {
+        write<LogLevel::ERROR>(format.get(), args...);
     }
 
-    void fatal(const std::string &content) {
-        appender_->log(LogLevel::FATAL, std::make_shared<LogEvent>(content));
+    template<typename ...Args>
+    void fatal(LogFormat<std::type_identity_t<Args>...> format, const Args &... args) {
+        write<LogLevel::FATAL>(format.get(), args...);
+    }
+
+    // 运行期拼接好的文本按原样输出（不解析其中的花括号）
+
+    void debug(std::string_view content) {
+        write<LogLevel::DEBUG>("{}", content);
+    }
+
+    void info(std::string_view content) {
+        write<LogLevel::INFO>("{}", content);
+    }
+
+    void warning(std::string_view content) {
+        write<LogLevel::WARNING>("{}", content);
+    }
+
+    void error(std::string_view content) {
+        write<LogLevel::ERROR>("{}", content);
+    }
+
+    void fatal(std::string_view content) {
+        write<LogLevel::FATAL>("{}", content);
+    }
+
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= WEBSERVER_LOG_MIN_LEVEL && level >= level_;
     }
 
     LogLevel getLogLevel() const {
@@ -169,8 +617,34 @@ public:
     }
 
 private:
+    template<LogLevel level, typename ...Args>
+    void write(std::string_view format, const Args &... args) {
+        if constexpr (static_cast<int>(level) >= WEBSERVER_LOG_MIN_LEVEL) {
+            if (level < level_)
+                return;
+            appender_->append(LogRecord::capture(level, format, args...));
+        }
+    }
+
     LogLevel level_;
     std::shared_ptr<LogAppender> appender_;
 };
 
+/**
+ * 日志宏：等级不够时连参数都不求值，低于 WEBSERVER_LOG_MIN_LEVEL 的调用在编译时被移除
+ */
+#define WEBSERVER_LOG(logger, level, method, ...)                                         \
+    do {                                                                                  \
+        if constexpr (static_cast<int>(LogLevel::level) >= WEBSERVER_LOG_MIN_LEVEL) {     \
+            if ((logger).isEnabled(LogLevel::level))                                      \
+                (logger).method(__VA_ARGS__);                                             \
+        }                                                                                 \
+    } while (false)
+
+#define LOG_DEBUG(logger, ...) WEBSERVER_LOG(logger, DEBUG, debug, __VA_ARGS__)
+#define LOG_INFO(logger, ...) WEBSERVER_LOG(logger, INFO, info, __VA_ARGS__)
+#define LOG_WARNING(logger, ...) WEBSERVER_LOG(logger, WARNING, warning, __VA_ARGS__)
+#define LOG_ERROR(logger, ...) WEBSERVER_LOG(logger, ERROR, error, __VA_ARGS__)
+#define LOG_FATAL(logger, ...) WEBSERVER_LOG(logger, FATAL, fatal, __VA_ARGS__)
+
 #endif //WEBSERVER_LOG_HPP
@@ -1,11 +1,34 @@
 #include <src/server.hpp>
 
-int main() {
+#include <cstdlib>
+#include <string_view>
+
+/**
+ * 用法：WebServer [--io-uring] [--asset-pack FILE] [--pack-assets] [--max-connections N]
+ *
+ * --asset-pack 从 pack_assets 生成的资源包提供静态资源；--pack-assets 在启动时打包 statics/（指定了 --asset-pack 时写入该文件）
+ * --max-connections 同时打开的连接数上限，超过时以 503 回应新连接
+ */
+int main(int argc, char *argv[]) {
     LogLevel level = LogLevel::INFO;
     auto logFormatter = std::make_shared<LogFormatter>(level);
-    auto logAppender = std::make_shared<TerminalLogAppender>(logFormatter, level);
+    auto terminalAppender = std::make_shared<TerminalLogAppender>(logFormatter, level);
+    auto logAppender = std::make_shared<AsyncLogAppender>(logFormatter, level, terminalAppender);
     Logger logger(level, logAppender);
 
-    Server server("127.0.0.1", 8080, logger);
+    ServerOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--io-uring") {
+            options.ioBackend = IoBackend::IO_URING;
+        } else if (arg == "--asset-pack" && i + 1 < argc) {
+            options.assetPack = argv[++i];
+        } else if (arg == "--pack-assets") {
+            options.packAssetsOnStartup = true;
+        } else if (arg == "--max-connections" && i + 1 < argc) {
+            options.maxConnections = std::strtoul(argv[++i], nullptr, 10);
+        }
+    }
+    Server server("127.0.0.1", 8080, logger, options);
     server.setup();
 }
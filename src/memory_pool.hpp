@@ -0,0 +1,312 @@
+#ifndef WEBSERVER_MEMORY_POOL_HPP
+#define WEBSERVER_MEMORY_POOL_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+/**
+ * 按大小分级的缓冲区池
+ *
+ * 请求的大小向上取整到 2 的幂（最小 MIN_BLOCK_SIZE），每一级保存一个空闲链表：释放的内存块进入链表，
+ * 之后同一级的分配直接取出。连接的读缓冲区、发送队列、连接对象等都从事件循环的缓冲区池分配，
+ * 连接关闭后内存块留给之后的连接使用，稳定运行时不再向堆申请内存。
+ * 超过 MAX_BLOCK_SIZE 或对齐要求超过 max_align_t 的请求直接交给上游；空闲块总量超过上限时多出的归还给上游
+ *
+ * 不是线程安全的，每个事件循环线程使用自己的缓冲区池
+ */
+class BufferPool : public std::pmr::memory_resource {
+public:
+    static constexpr size_t MIN_BLOCK_SIZE = 64;
+
+    static constexpr size_t MAX_BLOCK_SIZE = 1024 * 1024;
+
+    /**
+     * @param maxCachedBytes 空闲块的总字节数上限
+     * @param upstream 实际分配内存的上游
+     */
+    explicit BufferPool(size_t maxCachedBytes = 64 * 1024 * 1024,
+                        std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+            : maxCachedBytes_(maxCachedBytes), upstream_(upstream) {}
+
+    BufferPool(const BufferPool &) = delete;
+
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    ~BufferPool() override {
+        release();
+    }
+
+    /**
+     * 把全部空闲块归还给上游
+     */
+    void release() {
+        for (size_t i = 0; i < CLASSES; ++i) {
+            while (FreeBlock *block = heads_[i]) {
+                heads_[i] = block->next;
+                upstream_->deallocate(block, MIN_BLOCK_SIZE << i, alignof(std::max_align_t));
+            }
+        }
+        cachedBytes_ = 0;
+    }
+
+    /**
+     * 实际占用的内存块大小
+     */
+    static size_t blockSize(size_t bytes) {
+        return std::bit_ceil(std::max(bytes, MIN_BLOCK_SIZE));
+    }
+
+    /**
+     * 向上游申请内存的次数（预热之后应当不再增长）
+     */
+    size_t upstreamAllocations() const {
+        return upstreamAllocations_;
+    }
+
+    /**
+     * 空闲块的总字节数
+     */
+    size_t cachedBytes() const {
+        return cachedBytes_;
+    }
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        if (!isPooled(bytes, alignment)) {
+            ++upstreamAllocations_;
+            return upstream_->allocate(bytes, alignment);
+        }
+
+        size_t index = classOf(bytes);
+        if (FreeBlock *block = heads_[index]) {
+            heads_[index] = block->next;
+            cachedBytes_ -= MIN_BLOCK_SIZE << index;
+            return block;
+        }
+        ++upstreamAllocations_;
+        return upstream_->allocate(MIN_BLOCK_SIZE << index, alignof(std::max_align_t));
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+        if (!isPooled(bytes, alignment)) {
+            upstream_->deallocate(p, bytes, alignment);
+            return;
+        }
+        size_t index = classOf(bytes);
+        size_t size = MIN_BLOCK_SIZE << index;
+        if (cachedBytes_ + size > maxCachedBytes_) {
+            upstream_->deallocate(p, size, alignof(std::max_align_t));
+            return;
+        }
+        auto *block = static_cast<FreeBlock *>(p);
+        block->next = heads_[index];
+        heads_[index] = block;
+        cachedBytes_ += size;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    static constexpr size_t CLASSES = std::countr_zero(MAX_BLOCK_SIZE) - std::countr_zero(MIN_BLOCK_SIZE) + 1;
+
+    static bool isPooled(size_t bytes, size_t alignment) {
+        return bytes <= MAX_BLOCK_SIZE && alignment <= alignof(std::max_align_t);
+    }
+
+    static size_t classOf(size_t bytes) {
+        return std::countr_zero(blockSize(bytes)) - std::countr_zero(MIN_BLOCK_SIZE);
+    }
+
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    std::array<FreeBlock *, CLASSES> heads_{};
+
+    size_t cachedBytes_ = 0;
+
+    size_t maxCachedBytes_;
+
+    size_t upstreamAllocations_ = 0;
+
+    std::pmr::memory_resource *upstream_;
+};
+
+/**
+ * 单调分配的内存区域：分配只移动指针，释放单个对象什么也不做，reset() 时一次性丢弃全部对象
+ *
+ * 与 std::pmr::monotonic_buffer_resource 不同，reset() 保留已申请的内存块，之后的分配从第一块重新开始，
+ * 因此每个请求开始时重置、循环使用的区域在稳定运行时不会向上游申请内存；
+ * 大于一块的分配单独向上游申请，reset() 时归还，避免个别大请求让区域长期占用大量内存。不是线程安全的
+ */
+class Arena : public std::pmr::memory_resource {
+public:
+    /**
+     * @param upstream 内存块的来源（通常是事件循环的缓冲区池）
+     * @param blockSize 每个内存块的大小（包括块头）
+     */
+    explicit Arena(std::pmr::memory_resource *upstream = std::pmr::get_default_resource(), size_t blockSize = 4096)
+            : upstream_(upstream), blockSize_(std::max(blockSize, sizeof(Block) * 2)) {}
+
+    Arena(const Arena &) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+
+    ~Arena() override {
+        release();
+    }
+
+    /**
+     * 丢弃全部已分配的对象：保留普通内存块供之后复用，归还单独申请的大块
+     */
+    void reset() {
+        freeBlocks(std::exchange(large_, nullptr));
+        current_ = blocks_;
+        cursor_ = current_ ? current_->begin() : nullptr;
+    }
+
+    /**
+     * 丢弃全部已分配的对象，并把全部内存块归还给上游
+     */
+    void release() {
+        freeBlocks(std::exchange(large_, nullptr));
+        freeBlocks(std::exchange(blocks_, nullptr));
+        current_ = nullptr;
+        cursor_ = nullptr;
+    }
+
+    /**
+     * 保留的普通内存块数
+     */
+    size_t blockCount() const {
+        size_t count = 0;
+        for (Block *block = blocks_; block; block = block->next) {
+            ++count;
+        }
+        return count;
+    }
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        if (void *p = bump(bytes, alignment))
+            return p;
+
+        // 放不进一个普通块的分配单独申请
+        if (bytes + alignment > blockSize_ - sizeof(Block)) {
+            Block *block = newBlock(sizeof(Block) + bytes + alignment);
+            block->next = large_;
+            large_ = block;
+            return align(block->begin(), alignment);
+        }
+
+        // 使用下一个保留的块，没有时申请新块接在当前块之后
+        if (!current_ || !current_->next) {
+            Block *block = newBlock(blockSize_);
+            if (current_) {
+                current_->next = block;
+            } else {
+                blocks_ = block;
+            }
+        }
+        current_ = current_ ? current_->next : blocks_;
+        cursor_ = current_->begin();
+        return bump(bytes, alignment);
+    }
+
+    void do_deallocate(void *, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    struct alignas(std::max_align_t) Block {
+        Block *next;
+
+        size_t size; // 包括块头
+
+        char *begin() {
+            return reinterpret_cast<char *>(this + 1);
+        }
+
+        char *end() {
+            return reinterpret_cast<char *>(this) + size;
+        }
+    };
+
+    static char *align(char *p, size_t alignment) {
+        auto address = reinterpret_cast<uintptr_t>(p);
+        return p + ((alignment - address % alignment) % alignment);
+    }
+
+    void *bump(size_t bytes, size_t alignment) {
+        if (!current_)
+            return nullptr;
+        char *p = align(cursor_, alignment);
+        if (p > current_->end() || static_cast<size_t>(current_->end() - p) < bytes)
+            return nullptr;
+        cursor_ = p + bytes;
+        return p;
+    }
+
+    Block *newBlock(size_t size) {
+        auto *block = static_cast<Block *>(upstream_->allocate(size, alignof(Block)));
+        block->next = nullptr;
+        block->size = size;
+        return block;
+    }
+
+    void freeBlocks(Block *block) {
+        while (block) {
+            Block *next = block->next;
+            upstream_->deallocate(block, block->size, alignof(Block));
+            block = next;
+        }
+    }
+
+    std::pmr::memory_resource *upstream_;
+
+    size_t blockSize_;
+
+    Block *blocks_ = nullptr; // 普通内存块，reset() 后保留
+
+    Block *large_ = nullptr; // 单独申请的大块，reset() 时归还
+
+    Block *current_ = nullptr; // 正在分配的普通块
+
+    char *cursor_ = nullptr; // 当前块中下一次分配的位置
+};
+
+/**
+ * 把对象归还给分配它的内存资源，与 std::unique_ptr 一起使用
+ */
+template<typename T>
+struct PooledDelete {
+    std::pmr::memory_resource *resource;
+
+    void operator()(T *p) const {
+        std::pmr::polymorphic_allocator<T>(resource).delete_object(p);
+    }
+};
+
+template<typename T>
+using PooledPtr = std::unique_ptr<T, PooledDelete<T>>;
+
+/**
+ * 从内存资源分配并构造对象
+ */
+template<typename T, typename... Args>
+PooledPtr<T> makePooled(std::pmr::memory_resource *resource, Args &&...args) {
+    std::pmr::polymorphic_allocator<T> allocator(resource);
+    return PooledPtr<T>(allocator.template new_object<T>(std::forward<Args>(args)...), PooledDelete<T>{resource});
+}
+
+#endif //WEBSERVER_MEMORY_POOL_HPP
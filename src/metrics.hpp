@@ -0,0 +1,291 @@
+#ifndef WEBSERVER_METRICS_HPP
+#define WEBSERVER_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fmt/core.h>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <src/histogram.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * 指标分片
+ *
+ * 每个线程第一次记录时分到一个固定的分片，之后只修改自己分片上的原子变量（relaxed），
+ * 不同线程之间没有缓存行争用；只在抓取时把所有分片加起来
+ */
+class MetricShards {
+public:
+    static constexpr size_t SHARDS = 16;
+
+    static size_t current() {
+        static std::atomic<size_t> next(0);
+        thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+        return index;
+    }
+};
+
+/**
+ * 单调递增的计数器
+ */
+class Counter {
+public:
+    void add(uint64_t n = 1) {
+        shards_[MetricShards::current()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const {
+        uint64_t sum = 0;
+        for (auto &shard: shards_) {
+            sum += shard.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+
+    std::array<Shard, MetricShards::SHARDS> shards_;
+};
+
+/**
+ * 可增可减的瞬时值（如活跃连接数），增减可以发生在不同的线程上
+ */
+class Gauge {
+public:
+    void add(int64_t n = 1) {
+        shards_[MetricShards::current()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void sub(int64_t n = 1) {
+        add(-n);
+    }
+
+    int64_t value() const {
+        int64_t sum = 0;
+        for (auto &shard: shards_) {
+            sum += shard.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<int64_t> value{0};
+    };
+
+    std::array<Shard, MetricShards::SHARDS> shards_;
+};
+
+/**
+ * 延迟直方图（纳秒）
+ *
+ * 对数-线性分桶，相对误差不超过 1/8；每个分片各有一组原子桶，记录只是一次 relaxed 自增
+ */
+class LatencyHistogram {
+public:
+    using Scale = LogLinearScale<4>;
+
+    static constexpr uint64_t HIGHEST_NANOS = uint64_t(1) << 36; // 约 68 秒，更大的值按该值记录
+
+    static constexpr size_t BUCKETS = Scale::indexOf(HIGHEST_NANOS) + 1;
+
+    void observe(std::chrono::nanoseconds duration) {
+        auto nanos = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+        nanos = std::min(nanos, HIGHEST_NANOS);
+        Shard &shard = shards_[MetricShards::current()];
+        shard.buckets[Scale::indexOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(nanos, std::memory_order_relaxed);
+    }
+
+    /**
+     * 记录从 start 到现在的时间
+     */
+    void observeSince(std::chrono::steady_clock::time_point start) {
+        observe(std::chrono::steady_clock::now() - start);
+    }
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> buckets{};
+        uint64_t count = 0;
+        uint64_t sumNanos = 0;
+
+        /**
+         * 小于 nanos 的记录数（nanos 为 2 的幂时恰好落在桶的边界上）
+         */
+        uint64_t countBelow(uint64_t nanos) const {
+            uint64_t result = 0;
+            for (size_t i = 0; i < BUCKETS && i < Scale::indexOf(nanos); ++i) {
+                result += buckets[i];
+            }
+            return result;
+        }
+    };
+
+    Snapshot snapshot() const {
+        Snapshot result;
+        for (auto &shard: shards_) {
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                uint64_t n = shard.buckets[i].load(std::memory_order_relaxed);
+                result.buckets[i] += n;
+                result.count += n;
+            }
+            result.sumNanos += shard.sum.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+        std::atomic<uint64_t> sum{0};
+    };
+
+    std::array<Shard, MetricShards::SHARDS> shards_;
+};
+
+/**
+ * 指标注册表
+ *
+ * 指标在启动时注册，之后由各线程直接通过引用更新；render() 在抓取时汇总所有分片并生成 Prometheus 文本格式
+ */
+class MetricsRegistry {
+public:
+    /**
+     * 注册计数器
+     *
+     * @param labels Prometheus 标签，如 status="200"，同名指标的不同标签属于同一个指标族
+     */
+    Counter &counter(const std::string &name, const std::string &help, const std::string &labels = "") {
+        const std::lock_guard<std::mutex> lockGuard(mutex_);
+        Counter &counter = counters_.emplace_back();
+        family(name, help, "counter").samples.push_back({labels, [&counter](std::string &out, const Sample &sample,
+                                                                             const std::string &name) {
+            appendSample(out, name, sample.labels, counter.value());
+        }});
+        return counter;
+    }
+
+    Gauge &gauge(const std::string &name, const std::string &help, const std::string &labels = "") {
+        const std::lock_guard<std::mutex> lockGuard(mutex_);
+        Gauge &gauge = gauges_.emplace_back();
+        family(name, help, "gauge").samples.push_back({labels, [&gauge](std::string &out, const Sample &sample,
+                                                                         const std::string &name) {
+            appendSample(out, name, sample.labels, gauge.value());
+        }});
+        return gauge;
+    }
+
+    /**
+     * 注册延迟直方图，以秒为单位输出
+     */
+    LatencyHistogram &histogram(const std::string &name, const std::string &help, const std::string &labels = "") {
+        const std::lock_guard<std::mutex> lockGuard(mutex_);
+        LatencyHistogram &histogram = histograms_.emplace_back();
+        family(name, help, "histogram").samples.push_back({labels, [&histogram](std::string &out,
+                                                                                 const Sample &sample,
+                                                                                 const std::string &name) {
+            appendHistogram(out, name, sample.labels, histogram.snapshot());
+        }});
+        return histogram;
+    }
+
+    /**
+     * 注册在抓取时才读取的指标（如线程池队列长度、缓存命中数）
+     *
+     * @param type "counter" 或 "gauge"
+     */
+    void callback(const std::string &name, const std::string &help, const std::string &type,
+                  std::function<double()> read, const std::string &labels = "") {
+        const std::lock_guard<std::mutex> lockGuard(mutex_);
+        family(name, help, type).samples.push_back({labels, [read = std::move(read)](std::string &out,
+                                                                                      const Sample &sample,
+                                                                                      const std::string &name) {
+            appendSample(out, name, sample.labels, read());
+        }});
+    }
+
+    /**
+     * 生成 Prometheus 文本格式（version 0.0.4）
+     */
+    std::string render() const {
+        const std::lock_guard<std::mutex> lockGuard(mutex_);
+        std::string out;
+        out.reserve(8192);
+        for (auto &family: families_) {
+            out.append("# HELP ").append(family.name).append(" ").append(family.help).append("\n");
+            out.append("# TYPE ").append(family.name).append(" ").append(family.type).append("\n");
+            for (auto &sample: family.samples) {
+                sample.render(out, sample, family.name);
+            }
+        }
+        return out;
+    }
+
+    static constexpr std::string_view CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8";
+
+private:
+    struct Sample {
+        std::string labels;
+        std::function<void(std::string &, const Sample &, const std::string &)> render;
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        std::string type;
+        std::vector<Sample> samples;
+    };
+
+    Family &family(const std::string &name, const std::string &help, const std::string &type) {
+        for (auto &family: families_) {
+            if (family.name == name)
+                return family;
+        }
+        return families_.emplace_back(Family{name, help, type, {}});
+    }
+
+    template<typename T>
+    static void appendSample(std::string &out, std::string_view name, std::string_view labels, T value) {
+        out.append(name);
+        if (!labels.empty())
+            out.append("{").append(labels).append("}");
+        fmt::format_to(std::back_inserter(out), " {}\n", value);
+    }
+
+    static void appendHistogram(std::string &out, const std::string &name, const std::string &labels,
+                                const LatencyHistogram::Snapshot &snapshot) {
+        std::string prefix = labels.empty() ? "" : labels + ",";
+        // 以 2 的幂（纳秒）为边界输出累计计数，从约 1 微秒到约 68 秒
+        for (int exponent = 10; exponent <= 36; exponent += 2) {
+            uint64_t bound = uint64_t(1) << exponent;
+            fmt::format_to(std::back_inserter(out), "{}_bucket{{{}le=\"{:.9g}\"}} {}\n", name, prefix,
+                           static_cast<double>(bound) / 1e9, snapshot.countBelow(bound));
+        }
+        fmt::format_to(std::back_inserter(out), "{}_bucket{{{}le=\"+Inf\"}} {}\n", name, prefix, snapshot.count);
+        appendSample(out, name + "_sum", labels, static_cast<double>(snapshot.sumNanos) / 1e9);
+        appendSample(out, name + "_count", labels, snapshot.count);
+    }
+
+    mutable std::mutex mutex_; // 只保护注册与抓取，记录不加锁
+
+    std::deque<Counter> counters_;
+
+    std::deque<Gauge> gauges_;
+
+    std::deque<LatencyHistogram> histograms_;
+
+    std::vector<Family> families_;
+};
+
+#endif //WEBSERVER_METRICS_HPP
@@ -0,0 +1,106 @@
+#ifndef WEBSERVER_PERFECT_HASH_HPP
+#define WEBSERVER_PERFECT_HASH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * 运行时构建的最小完美哈希（hash-and-displace）
+ *
+ * 键的 64 位哈希先决定桶，每个桶在构建时找到一个种子，使桶中的全部键与种子混合后落在尚未占用的槽位上；
+ * n 个键恰好占满 n 个槽位。查找只需计算一次哈希、读一个种子，不在键集合中的键也会落在某个槽位上，
+ * 调用方需要比较槽位中的键
+ *
+ * 种子可以原样保存到文件中（见 src/asset_pack.hpp），哈希函数与槽位的计算方式因此不能改变
+ */
+class PerfectHash {
+public:
+    static uint64_t hashOf(std::string_view key) {
+        // FNV-1a
+        uint64_t hash = 0xcbf29ce484222325;
+        for (char c: key) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+        }
+        return hash;
+    }
+
+    static uint32_t slotOf(uint64_t hash, uint32_t seed, size_t slots) {
+        // splitmix64 的终结函数，把种子的影响扩散到全部位
+        uint64_t x = hash + (seed + 1) * 0x9e3779b97f4a7c15;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+        x ^= x >> 31;
+        return static_cast<uint32_t>(x % slots);
+    }
+
+    /**
+     * 键所在的槽位（seeds 与 slots 均不能为空）
+     */
+    static uint32_t slotOf(std::string_view key, const std::vector<uint32_t> &seeds, size_t slots) {
+        uint64_t hash = hashOf(key);
+        return slotOf(hash, seeds[hash % seeds.size()], slots);
+    }
+
+    /**
+     * 为每个桶找到种子，使全部键落在不同的槽位上；大的桶先放，此时空闲的槽位多，容易找到种子
+     *
+     * @param slots 每个键（按 keys 的顺序）的槽位
+     * @return 是否成功（存在哈希完全相同的键时失败）
+     */
+    static bool build(const std::vector<std::string_view> &keys, std::vector<uint32_t> &seeds,
+                      std::vector<uint32_t> &slots) {
+        static constexpr uint32_t MAX_ATTEMPTS = 1 << 24;
+        size_t count = keys.size();
+        size_t bucketCount = std::max<size_t>(count / 4, 1); // 平均每个桶 4 个键
+        std::vector<std::vector<size_t>> buckets(bucketCount);
+        std::vector<uint64_t> hashes(count);
+        for (size_t i = 0; i < count; ++i) {
+            hashes[i] = hashOf(keys[i]);
+            buckets[hashes[i] % bucketCount].push_back(i);
+        }
+        std::vector<size_t> order(bucketCount);
+        for (size_t i = 0; i < bucketCount; ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&buckets](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+        seeds.assign(bucketCount, 0);
+        slots.assign(count, 0);
+        std::vector<bool> isUsed(count);
+        std::vector<uint32_t> candidate;
+        for (size_t bucket: order) {
+            const std::vector<size_t> &members = buckets[bucket];
+            if (members.empty())
+                break;
+            uint32_t seed = 0;
+            for (; seed < MAX_ATTEMPTS; ++seed) {
+                candidate.clear();
+                bool isFree = true;
+                for (size_t key: members) {
+                    uint32_t slot = slotOf(hashes[key], seed, count);
+                    if (isUsed[slot] || std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) {
+                        isFree = false;
+                        break;
+                    }
+                    candidate.push_back(slot);
+                }
+                if (isFree)
+                    break;
+            }
+            if (seed == MAX_ATTEMPTS)
+                return false;
+            seeds[bucket] = seed;
+            for (size_t i = 0; i < members.size(); ++i) {
+                isUsed[candidate[i]] = true;
+                slots[members[i]] = candidate[i];
+            }
+        }
+        return true;
+    }
+};
+
+#endif //WEBSERVER_PERFECT_HASH_HPP
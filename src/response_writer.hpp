@@ -0,0 +1,203 @@
+#ifndef WEBSERVER_RESPONSE_WRITER_HPP
+#define WEBSERVER_RESPONSE_WRITER_HPP
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <src/clock.hpp>
+#include <string>
+#include <string_view>
+
+/**
+ * 常用的响应状态
+ */
+enum class HttpStatus {
+    OK,
+    PARTIAL_CONTENT,
+    NOT_MODIFIED,
+    BAD_REQUEST,
+    NOT_FOUND,
+    METHOD_NOT_ALLOWED,
+    RANGE_NOT_SATISFIABLE,
+    INTERNAL_SERVER_ERROR,
+    SERVICE_UNAVAILABLE,
+};
+
+/**
+ * 常用的头字段名
+ */
+enum class HttpHeader {
+    CONNECTION,
+    CONTENT_LENGTH,
+    CONTENT_TYPE,
+    CONTENT_ENCODING,
+    CONTENT_RANGE,
+    DATE,
+    ETAG,
+    LAST_MODIFIED,
+    ACCEPT_RANGES,
+    VARY,
+    RETRY_AFTER,
+    ALLOW,
+};
+
+/**
+ * 编译期生成的状态行与头字段名（头字段名已带上 ": "），写入时只需一次复制
+ */
+class HttpStrings {
+public:
+    static constexpr std::string_view statusLine(HttpStatus status) {
+        return STATUS_LINES[static_cast<size_t>(status)];
+    }
+
+    /**
+     * 三位数字的状态码，如 "200"
+     */
+    static constexpr std::string_view statusCode(HttpStatus status) {
+        return statusLine(status).substr(9, 3);
+    }
+
+    static constexpr size_t STATUS_COUNT = 9;
+
+    static constexpr std::string_view headerPrefix(HttpHeader header) {
+        return HEADER_PREFIXES[static_cast<size_t>(header)];
+    }
+
+    static constexpr std::string_view CRLF = "\r\n";
+
+private:
+    static constexpr std::array<std::string_view, STATUS_COUNT> STATUS_LINES = {
+            "HTTP/1.1 200 OK\r\n",
+            "HTTP/1.1 206 Partial Content\r\n",
+            "HTTP/1.1 304 Not Modified\r\n",
+            "HTTP/1.1 400 Bad Request\r\n",
+            "HTTP/1.1 404 Not Found\r\n",
+            "HTTP/1.1 405 Method Not Allowed\r\n",
+            "HTTP/1.1 416 Range Not Satisfiable\r\n",
+            "HTTP/1.1 500 Internal Server Error\r\n",
+            "HTTP/1.1 503 Service Unavailable\r\n",
+    };
+
+    static constexpr std::array<std::string_view, 12> HEADER_PREFIXES = {
+            "Connection: ",
+            "Content-Length: ",
+            "Content-Type: ",
+            "Content-Encoding: ",
+            "Content-Range: ",
+            "Date: ",
+            "ETag: ",
+            "Last-Modified: ",
+            "Accept-Ranges: ",
+            "Vary: ",
+            "Retry-After: ",
+            "Allow: ",
+    };
+};
+
+/**
+ * 响应头写入器
+ *
+ * 把状态行与头字段依次追加到调用方提供的缓冲区中（通常是连接上循环使用的缓冲区，清空后容量保留），
+ * 响应体不经过这里，发送时与响应头作为独立的 iovec
+ *
+ * @tparam String 缓冲区的类型，如 std::string 或从内存区域分配的 std::pmr::string
+ */
+template<typename String>
+class BasicResponseWriter {
+public:
+    explicit BasicResponseWriter(String &buffer) : buffer_(buffer) {
+        buffer_.clear();
+    }
+
+    BasicResponseWriter &status(HttpStatus status) {
+        buffer_.append(HttpStrings::statusLine(status));
+        return *this;
+    }
+
+    BasicResponseWriter &status(std::string_view version, std::string_view code, std::string_view message) {
+        buffer_.append(version).append(" ").append(code).append(" ").append(message).append(HttpStrings::CRLF);
+        return *this;
+    }
+
+    BasicResponseWriter &header(HttpHeader header, std::string_view value) {
+        buffer_.append(HttpStrings::headerPrefix(header)).append(value).append(HttpStrings::CRLF);
+        return *this;
+    }
+
+    BasicResponseWriter &header(HttpHeader header, size_t value) {
+        char digits[24];
+        auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+        return this->header(header, std::string_view(digits, end - digits));
+    }
+
+    BasicResponseWriter &header(std::string_view name, std::string_view value) {
+        buffer_.append(name).append(": ").append(value).append(HttpStrings::CRLF);
+        return *this;
+    }
+
+    BasicResponseWriter &connection(bool keepAlive) {
+        return header(HttpHeader::CONNECTION, keepAlive ? "keep-alive" : "close");
+    }
+
+    /**
+     * 追加当前时间的 Date 头（每秒只格式化一次）
+     */
+    BasicResponseWriter &date() {
+        return header(HttpHeader::DATE, CachedClock::httpDate());
+    }
+
+    /**
+     * 追加 Content-Range 头，如 "bytes 0-499/1234"
+     */
+    BasicResponseWriter &contentRange(size_t first, size_t last, size_t size) {
+        buffer_.append(HttpStrings::headerPrefix(HttpHeader::CONTENT_RANGE)).append("bytes ");
+        appendNumber(first);
+        buffer_.append("-");
+        appendNumber(last);
+        buffer_.append("/");
+        appendNumber(size);
+        buffer_.append(HttpStrings::CRLF);
+        return *this;
+    }
+
+    /**
+     * 追加范围不可满足时（416）的 Content-Range 头，起始与结束位置为 "*"，只有资源大小
+     */
+    BasicResponseWriter &contentRange(size_t size) {
+        buffer_.append(HttpStrings::headerPrefix(HttpHeader::CONTENT_RANGE)).append("bytes */");
+        appendNumber(size);
+        buffer_.append(HttpStrings::CRLF);
+        return *this;
+    }
+
+    /**
+     * 追加预先生成的头字段（每个字段都以 CRLF 结尾）
+     */
+    BasicResponseWriter &fields(std::string_view fields) {
+        buffer_.append(fields);
+        return *this;
+    }
+
+    /**
+     * 结束响应头（追加空行）
+     *
+     * @return 完整的响应头
+     */
+    std::string_view end() {
+        buffer_.append(HttpStrings::CRLF);
+        return buffer_;
+    }
+
+private:
+    void appendNumber(size_t value) {
+        char digits[24];
+        auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer_.append(digits, end - digits);
+    }
+
+    String &buffer_;
+};
+
+using ResponseWriter = BasicResponseWriter<std::string>;
+
+#endif //WEBSERVER_RESPONSE_WRITER_HPP
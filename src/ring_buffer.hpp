@@ -0,0 +1,135 @@
+#ifndef WEBSERVER_RING_BUFFER_HPP
+#define WEBSERVER_RING_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * 有界无锁环形队列（Vyukov 算法）
+ *
+ * 支持多个生产者与多个消费者；每个槽位带一个序号，生产者与消费者只在各自的位置计数器上 CAS，
+ * 不同槽位之间没有竞争；容量在构造时确定（向上取整为 2 的幂），队列满时 tryPush() 失败而不是扩容
+ */
+template<typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity) : mask_(roundUp(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(const RingBuffer &) = delete;
+
+    RingBuffer &operator=(const RingBuffer &) = delete;
+
+    /**
+     * 入队
+     *
+     * @return 队列已满时返回 false，value 保持不变
+     */
+    bool tryPush(T &&value) {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) { // 槽位空闲，尝试占用
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) { // 槽位中的数据还没被取走，队列已满
+                return false;
+            } else { // 其他生产者已占用，重新读取位置
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 出队
+     *
+     * @return 队列为空时返回 false
+     */
+    bool tryPop(T &value) {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) { // 队列为空
+                return false;
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    /**
+     * 近似的元素个数（并发修改时只作参考）
+     */
+    size_t size() const {
+        size_t enqueued = enqueuePos_.load(std::memory_order_relaxed);
+        size_t dequeued = dequeuePos_.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * 已入队的元素总数（单调递增，可用来等待某个位置之前的元素被取走）
+     */
+    size_t pushed() const {
+        return enqueuePos_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * 已出队的元素总数
+     */
+    size_t popped() const {
+        return dequeuePos_.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUp(size_t capacity) {
+        size_t result = 2;
+        while (result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t mask_;
+
+    std::unique_ptr<Cell[]> cells_;
+
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+
+    alignas(64) std::atomic<size_t> dequeuePos_{0};
+};
+
+#endif //WEBSERVER_RING_BUFFER_HPP
@@ -0,0 +1,349 @@
+#ifndef WEBSERVER_ROUTER_HPP
+#define WEBSERVER_ROUTER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <src/perfect_hash.hpp>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * 一次匹配得到的参数：参数化路由中各个 {name} 对应的路径段，以及目录挂载中挂载点之后的路径
+ *
+ * 都是请求 URL 与路由表中字符串的视图（参数值是未解码的原文），不分配内存
+ */
+class RouteParams {
+public:
+    static constexpr size_t MAX_PARAMS = 8;
+
+    /**
+     * 名为 name 的参数，不存在时为空
+     */
+    std::string_view get(std::string_view name) const {
+        for (size_t i = 0; i < size_; ++i) {
+            if (params_[i].first == name)
+                return params_[i].second;
+        }
+        return {};
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    /**
+     * 目录挂载中挂载点之后的路径（以 '/' 开头，请求的正好是挂载点时为空），如挂载在 /static 时
+     * /static/css/a.css 的 "/css/a.css"
+     */
+    std::string_view rest() const {
+        return rest_;
+    }
+
+private:
+    template<typename Handler>
+    friend class Router;
+
+    std::array<std::pair<std::string_view, std::string_view>, MAX_PARAMS> params_;
+
+    size_t size_ = 0;
+
+    std::string_view rest_;
+};
+
+/**
+ * 编译后的路由表
+ *
+ * 可以注册三种路由，匹配时按以下顺序：
+ * 1. 精确路由（如 /metrics）：注册完成后生成最小完美哈希，一次哈希探测加一次比较；
+ * 2. 参数化路由（如 /news/{id}）：按路径段组织成基数树，字面量段优先于参数段，不匹配时回溯；
+ * 3. 目录挂载（如 /static）：同一棵树上前缀最长的挂载点，剩下的路径交给处理器（如在静态资源目录中查找）
+ *
+ * 匹配的是请求 URL 中查询串与片段之前的部分，不解码、不规范化，也不分配内存。
+ * 全部路由注册之后调用 compile()，之后路由表只读，可被多个线程同时匹配
+ *
+ * @tparam Handler 处理器的类型，匹配结果是指向它的指针
+ */
+template<typename Handler>
+class Router {
+public:
+    Router() : root_(std::make_unique<Node>()) {}
+
+    /**
+     * 注册精确路由或参数化路由，参数段写作整段的 {name}
+     *
+     * @throw std::invalid_argument 不以 '/' 开头、参数段格式错误、参数过多或路由重复
+     */
+    Router &route(std::string_view pattern, Handler handler) {
+        checkPattern(pattern);
+        if (pattern.find('{') == std::string_view::npos) {
+            for (const auto &[path, index]: exact_) {
+                if (path == pattern)
+                    throw std::invalid_argument("Duplicate route " + std::string(pattern));
+            }
+            exact_.emplace_back(std::string(pattern), add(std::move(handler)));
+            isCompiled_ = false;
+            return *this;
+        }
+
+        Node *node = root_.get();
+        size_t params = 0;
+        for (std::string_view segment: segments(pattern)) {
+            if (!isParameter(segment)) {
+                if (segment.find_first_of("{}") != std::string_view::npos)
+                    throw std::invalid_argument("Parameter must be a whole segment in route " + std::string(pattern));
+                node = literalChild(*node, segment);
+                continue;
+            }
+            std::string_view name = segment.substr(1, segment.size() - 2);
+            if (name.empty() || name.find_first_of("{}") != std::string_view::npos ||
+                ++params > RouteParams::MAX_PARAMS)
+                throw std::invalid_argument("Invalid parameter in route " + std::string(pattern));
+            if (!node->parameter) {
+                node->parameter = std::make_unique<Node>();
+                node->parameterName = name;
+            } else if (node->parameterName != name) { // 同一位置的参数名不同，参数的视图无法对应
+                throw std::invalid_argument("Conflicting parameter name in route " + std::string(pattern));
+            }
+            node = node->parameter.get();
+        }
+        if (node->route != NONE)
+            throw std::invalid_argument("Duplicate route " + std::string(pattern));
+        node->route = add(std::move(handler));
+        return *this;
+    }
+
+    /**
+     * 挂载目录：以 prefix 为前缀（按整段比较）的路径在没有更具体的路由时交给 handler，"/" 匹配全部路径
+     *
+     * @throw std::invalid_argument 不以 '/' 开头、包含参数段或重复挂载
+     */
+    Router &mount(std::string_view prefix, Handler handler) {
+        checkPattern(prefix);
+        Node *node = root_.get();
+        for (std::string_view segment: segments(prefix)) {
+            if (isParameter(segment))
+                throw std::invalid_argument("Mount point cannot have parameters: " + std::string(prefix));
+            if (!segment.empty()) // 忽略末尾的 '/'
+                node = literalChild(*node, segment);
+        }
+        if (node->mount != NONE)
+            throw std::invalid_argument("Duplicate mount point " + std::string(prefix));
+        node->mount = add(std::move(handler));
+        return *this;
+    }
+
+    /**
+     * 生成精确路由的完美哈希表，并按段排序基数树中每个节点的子节点
+     */
+    void compile() {
+        std::vector<std::string_view> keys;
+        keys.reserve(exact_.size());
+        for (const auto &[path, index]: exact_) {
+            keys.push_back(path);
+        }
+        std::vector<uint32_t> slots;
+        if (!keys.empty() && !PerfectHash::build(keys, seeds_, slots))
+            throw std::invalid_argument("No perfect hash for the exact routes");
+        table_.assign(exact_.size(), {});
+        for (size_t i = 0; i < exact_.size(); ++i) {
+            table_[slots[i]] = {exact_[i].first, exact_[i].second};
+        }
+        sort(*root_);
+        isCompiled_ = true;
+    }
+
+    /**
+     * 匹配请求 URL（未调用 compile() 时不匹配精确路由）
+     *
+     * @param url 请求行中的 URL，如 /news/12?from=index
+     * @param params 匹配到的参数
+     * @return 处理器，没有匹配的路由时为空
+     */
+    const Handler *match(std::string_view url, RouteParams &params) const {
+        std::string_view path = url.substr(0, url.find_first_of("?#"));
+        params.size_ = 0;
+        params.rest_ = {};
+        if (path.empty() || path.front() != '/')
+            return nullptr;
+
+        if (isCompiled_ && !table_.empty()) {
+            const Slot &slot = table_[PerfectHash::slotOf(path, seeds_, table_.size())];
+            if (slot.path == path)
+                return &handlers_[slot.handler];
+        }
+
+        Mount mount;
+        size_t route = matchNode(*root_, path, 0, params, mount);
+        if (route != NONE)
+            return &handlers_[route];
+        if (mount.handler != NONE) {
+            params.size_ = 0;
+            params.rest_ = mount.rest;
+            return &handlers_[mount.handler];
+        }
+        return nullptr;
+    }
+
+private:
+    static constexpr size_t NONE = SIZE_MAX;
+
+    /**
+     * 基数树的节点，每条边是一个完整的路径段
+     */
+    struct Node {
+        std::vector<std::pair<std::string, std::unique_ptr<Node>>> children; // 字面量段（编译后按段排序）
+
+        std::unique_ptr<Node> parameter; // 参数段
+
+        std::string parameterName;
+
+        size_t route = NONE; // 在此结束的参数化路由
+
+        size_t mount = NONE; // 挂载在此的目录
+    };
+
+    struct Slot {
+        std::string_view path;
+        size_t handler = NONE;
+    };
+
+    struct Mount {
+        size_t handler = NONE;
+        std::string_view rest;
+    };
+
+    /**
+     * 路径的各段："/" 没有段，"/a/" 是 "a" 与 ""
+     */
+    class Segments {
+    public:
+        class Iterator {
+        public:
+            Iterator(std::string_view path, size_t position) : path_(path), position_(position) {}
+
+            std::string_view operator*() const {
+                size_t end = std::min(path_.find('/', position_ + 1), path_.size());
+                return path_.substr(position_ + 1, end - position_ - 1);
+            }
+
+            Iterator &operator++() {
+                position_ = std::min(path_.find('/', position_ + 1), path_.size());
+                return *this;
+            }
+
+            bool operator!=(const Iterator &other) const {
+                return position_ != other.position_;
+            }
+
+        private:
+            std::string_view path_;
+            size_t position_; // 当前段之前的 '/' 的位置
+        };
+
+        explicit Segments(std::string_view path) : path_(path) {}
+
+        Iterator begin() const {
+            return {path_, path_.size() <= 1 ? path_.size() : 0};
+        }
+
+        Iterator end() const {
+            return {path_, path_.size()};
+        }
+
+    private:
+        std::string_view path_;
+    };
+
+    static Segments segments(std::string_view path) {
+        return Segments(path);
+    }
+
+    static bool isParameter(std::string_view segment) {
+        return segment.size() >= 2 && segment.front() == '{' && segment.back() == '}';
+    }
+
+    static void checkPattern(std::string_view pattern) {
+        if (pattern.empty() || pattern.front() != '/' || pattern.find_first_of("?#") != std::string_view::npos)
+            throw std::invalid_argument("Route must be a path starting with '/': " + std::string(pattern));
+    }
+
+    size_t add(Handler handler) {
+        handlers_.push_back(std::move(handler));
+        return handlers_.size() - 1;
+    }
+
+    Node *literalChild(Node &node, std::string_view segment) {
+        for (auto &[name, child]: node.children) {
+            if (name == segment)
+                return child.get();
+        }
+        isCompiled_ = false;
+        return node.children.emplace_back(std::string(segment), std::make_unique<Node>()).second.get();
+    }
+
+    static void sort(Node &node) {
+        std::sort(node.children.begin(), node.children.end(),
+                  [](const auto &a, const auto &b) { return a.first < b.first; });
+        for (auto &[name, child]: node.children) {
+            sort(*child);
+        }
+        if (node.parameter)
+            sort(*node.parameter);
+    }
+
+    /**
+     * 从 node 开始匹配 path 中 position 之后的部分（position 是下一段之前的 '/' 的位置，或路径末尾）
+     *
+     * 沿途记录前缀最长的挂载点；挂载点只在字面量段上，回溯到参数段时不会被更短的覆盖
+     *
+     * @return 参数化路由的处理器下标，不匹配时为 NONE
+     */
+    size_t matchNode(const Node &node, std::string_view path, size_t position, RouteParams &params,
+                     Mount &mount) const {
+        if (node.mount != NONE)
+            mount = {node.mount, path.substr(position)};
+        if (position == path.size() || (position == 0 && path.size() == 1)) // "/" 没有段
+            return node.route;
+
+        size_t end = std::min(path.find('/', position + 1), path.size());
+        std::string_view segment = path.substr(position + 1, end - position - 1);
+
+        auto it = std::lower_bound(node.children.begin(), node.children.end(), segment,
+                                   [](const auto &child, std::string_view key) { return child.first < key; });
+        if (it != node.children.end() && it->first == segment) {
+            size_t route = matchNode(*it->second, path, end, params, mount);
+            if (route != NONE)
+                return route;
+        }
+
+        if (node.parameter && !segment.empty()) {
+            size_t index = params.size_++;
+            params.params_[index] = {node.parameterName, segment};
+            size_t route = matchNode(*node.parameter, path, end, params, mount);
+            if (route != NONE)
+                return route;
+            params.size_ = index;
+        }
+        return NONE;
+    }
+
+    std::vector<Handler> handlers_;
+
+    std::vector<std::pair<std::string, size_t>> exact_; // 精确路由的路径与处理器下标（按注册顺序）
+
+    std::vector<uint32_t> seeds_; // 精确路由完美哈希的种子
+
+    std::vector<Slot> table_; // 按槽位排列的精确路由
+
+    std::unique_ptr<Node> root_;
+
+    bool isCompiled_ = false;
+};
+
+#endif //WEBSERVER_ROUTER_HPP
@@ -7,23 +7,229 @@
 
 #include <arpa/inet.h>
 #include <atomic>
-#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <coroutine>
 #include <cstring>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <src/admission_control.hpp>
+#include <src/asset_cache.hpp>
+#include <src/asset_pack.hpp>
+#include <src/async_io.hpp>
+#include <src/conditional_request.hpp>
+#include <src/connection.hpp>
+#include <src/coroutine.hpp>
+#include <src/event_loop.hpp>
 #include <src/file_util.hpp>
 #include <src/http_handler.hpp>
+#include <src/io_uring.hpp>
 #include <src/log.hpp>
+#include <src/memory_pool.hpp>
+#include <src/metrics.hpp>
+#include <src/response_writer.hpp>
+#include <src/router.hpp>
 #include <src/thread_pool.hpp>
 #include <string>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <thread>
 #include <unistd.h>
+#include <unordered_map>
+#include <vector>
 
+/**
+ * 网络 I/O 的实现方式
+ */
+enum class IoBackend {
+    EPOLL, // epoll 就绪通知 + recv/sendmsg/sendfile/close 系统调用
+    IO_URING, // io_uring 完成通知，每轮事件处理中的全部 I/O 合并为一次 io_uring_enter；内核不支持时退回 epoll
+};
 
-class Server {
+/**
+ * 服务器配置
+ */
+struct ServerOptions {
+    int keepAliveTimeoutSeconds = 15; // 持久连接的空闲超时（秒）
+
+    int requestTimeoutSeconds = 10; // 从连接建立或收到请求的第一个字节起，收到完整请求的期限（秒）
+
+    int writeTimeoutSeconds = 30; // 发送没有任何进展的最长时间（秒）
+
+    size_t maxKeepAliveRequests = 100; // 单个持久连接上最多处理的请求数
+
+    size_t assetCacheCapacity = 64 * 1024 * 1024; // 静态资源缓存的内存上限（字节，多个事件循环平分）
+
+    size_t sendfileThreshold = 256 * 1024; // 不小于该大小的文件不读入内存，用 sendfile 发送
+
+    std::string staticRoot = "statics/"; // 静态资源根目录
+
+    bool compressAssets = true; // 在线程池中把文本资源压缩为 gzip / brotli 并缓存（预压缩的 .gz / .br 文件总是使用）
+
+    std::string assetPack; // 非空时从该资源包文件（见 AssetPack）提供静态资源，不再访问 staticRoot
+
+    bool packAssetsOnStartup = false; // 启动时把 staticRoot 打包到 assetPack（为空时使用临时文件）再映射
+
+    int backlog = SOMAXCONN; // 已完成握手、等待 accept 的连接队列长度（受内核 somaxconn 限制）
+
+    size_t eventLoops = 1; // 事件循环线程数，大于 1 时每个线程用 SO_REUSEPORT 各自监听
+
+    bool pinEventLoops = false; // 将第 i 个事件循环线程绑定到第 i 个 CPU
+
+    bool handleInLoop = false; // 在事件循环线程中直接处理请求，不经过线程池
+
+    bool tcpNoDelay = false; // 对连接设置 TCP_NODELAY
+
+    int deferAcceptSeconds = 0; // 大于 0 时设置 TCP_DEFER_ACCEPT：收到数据（或超时）后才唤醒 accept
+
+    size_t maxConnections = 0; // 同时打开的连接数上限（多个事件循环平分），超过时以 503 回应新连接，0 表示不限制
+
+    size_t maxInFlightRequests = 1024; // 交给线程池（排队与执行中）的请求数上限（多个事件循环平分），0 表示不限制
+
+    int targetQueueWaitMs = 20; // 请求在线程池中排队时间的目标，超过时按 AIMD 降低并发上限，0 表示上限固定
+
+    int retryAfterSeconds = 1; // 过载时 503 响应中的 Retry-After（秒）
+
+    std::string metricsPath = "/metrics"; // 以 Prometheus 文本格式输出运行指标的路径，为空时不提供
+
+    IoBackend ioBackend = IoBackend::EPOLL;
+};
+
+/**
+ * 服务器的运行指标，所有分片共享；更新只修改当前线程的分片，抓取时才汇总
+ */
+struct ServerMetrics {
+    explicit ServerMetrics(MetricsRegistry &registry)
+            : registry(registry),
+              acceptedConnections(registry.counter("webserver_connections_accepted_total",
+                                                   "Connections accepted")),
+              activeConnections(registry.gauge("webserver_connections_active", "Connections currently open")),
+              sentBytes(registry.counter("webserver_sent_bytes_total", "Bytes written to sockets")),
+              parseErrors(registry.counter("webserver_parse_errors_total", "Malformed requests")),
+              shedRequests(registry.counter("webserver_requests_shed_total",
+                                            "Requests answered with 503 because the thread pool is overloaded")),
+              shedConnections(registry.counter("webserver_connections_shed_total",
+                                               "Connections answered with 503 because of the connection limit")),
+              taskWait(registry.histogram("webserver_thread_pool_task_wait_seconds",
+                                          "Time requests wait in the thread pool queue")),
+              acceptLatency(stage(registry, "accept")),
+              parseLatency(stage(registry, "parse")),
+              handleLatency(stage(registry, "handle")),
+              sendLatency(stage(registry, "send")) {
+        for (size_t i = 0; i < HttpStrings::STATUS_COUNT; ++i) {
+            std::string code(HttpStrings::statusCode(static_cast<HttpStatus>(i)));
+            responses[i] = &registry.counter("webserver_responses_total", "Responses by status code",
+                                             "code=\"" + code + "\"");
+        }
+        for (auto kind: {ConnectionTimeout::REQUEST, ConnectionTimeout::IDLE, ConnectionTimeout::WRITE}) {
+            timeouts[static_cast<size_t>(kind)] = &registry.counter("webserver_connection_timeouts_total",
+                                                                    "Connections closed by a timeout",
+                                                                    "kind=\"" + std::string(timeoutName(kind)) + "\"");
+        }
+    }
+
+    void response(HttpStatus status) {
+        responses[static_cast<size_t>(status)]->add();
+    }
+
+    void timeout(ConnectionTimeout kind) {
+        if (Counter *counter = timeouts[static_cast<size_t>(kind)])
+            counter->add();
+    }
+
+    static std::string_view timeoutName(ConnectionTimeout kind) {
+        switch (kind) {
+            case ConnectionTimeout::REQUEST:
+                return "request";
+            case ConnectionTimeout::IDLE:
+                return "idle";
+            case ConnectionTimeout::WRITE:
+                return "write";
+            default:
+                return "none";
+        }
+    }
+
+    MetricsRegistry &registry;
+
+    Counter &acceptedConnections;
+
+    Gauge &activeConnections;
+
+    std::array<Counter *, HttpStrings::STATUS_COUNT> responses{};
+
+    std::array<Counter *, 4> timeouts{}; // 按 ConnectionTimeout 分类
+
+    Counter &sentBytes;
+
+    Counter &parseErrors;
+
+    Counter &shedRequests; // 并发上限或线程池队列已满时拒绝的请求
+
+    Counter &shedConnections; // 连接数达到上限时拒绝的连接
+
+    LatencyHistogram &taskWait; // 从提交到线程池到开始执行
+
+    LatencyHistogram &acceptLatency; // accept 返回后连接的初始化
+
+    LatencyHistogram &parseLatency; // 解析出完整请求（或发现格式错误）的那一次解析
+
+    LatencyHistogram &handleLatency; // 生成响应
+
+    LatencyHistogram &sendLatency; // 从加入发送队列到全部写入 socket
+
+private:
+    static LatencyHistogram &stage(MetricsRegistry &registry, const std::string &name) {
+        return registry.histogram("webserver_stage_duration_seconds", "Time spent in each request stage",
+                                  "stage=\"" + name + "\"");
+    }
+};
+
+/**
+ * 一个事件循环及其拥有的全部状态：监听 socket、连接、缓冲区与静态资源缓存
+ *
+ * 多个分片之间不共享任何可变状态，每个分片只在自己的事件循环线程中运行
+ */
+class ServerShard {
 public:
-    Server(const std::string &address, int port, Logger logger, int backup = 5) : isShutdown(false),
-                                                                                  log(std::move(logger)) {
-        socketFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    /**
+     * @param reusePort 是否设置 SO_REUSEPORT，由内核在监听同一端口的多个 socket 之间分配连接
+     */
+    ServerShard(const std::string &address, int port, Logger logger, const ServerOptions &options, bool reusePort,
+                ServerMetrics &metrics, std::shared_ptr<const AssetPack> assetPack = nullptr)
+            : socketFd(socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP)),
+              listener(socketFd),
+              isShutdown(false),
+              log(std::move(logger)),
+              options(options),
+              metrics(metrics),
+              assetCache(options.staticRoot, options.assetCacheCapacity / std::max<size_t>(options.eventLoops, 1),
+                         std::chrono::seconds(1), options.sendfileThreshold, compressor(options)),
+              assetPack(std::move(assetPack)),
+              admission(perLoop(options.maxInFlightRequests, options.eventLoops),
+                        std::chrono::milliseconds(options.targetQueueWaitMs), getThreadPool().size()),
+              connectionLimit(perLoop(options.maxConnections, options.eventLoops)) {
+        // 服务器主动关闭的连接处于 TIME_WAIT 时也允许重新绑定端口
+        int enable = 1;
+        setsockopt(socketFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        if (reusePort && setsockopt(socketFd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0) {
+            log.error("Fail to set SO_REUSEPORT");
+            exit(1);
+        }
+        if (options.deferAcceptSeconds > 0) {
+            setsockopt(socketFd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &options.deferAcceptSeconds,
+                       sizeof(options.deferAcceptSeconds));
+        }
 
         // bind：把一个地址族中的特定地址赋给 socket
         memset(&serverAddress, 0, sizeof(serverAddress));
@@ -32,93 +238,1391 @@ public:
         serverAddress.sin_port = htons(port);
         int bindResult = bind(socketFd, (struct sockaddr *) &serverAddress, sizeof(serverAddress));
         if (bindResult != 0) {
-            log.error(fmt::format("Fail to bind socket fd {}:{}", address, port));
+            log.error("Fail to bind socket fd {}:{}", address, port);
             exit(1);
         }
 
         // listen：将 socket 变为被动类型的，等待客户的连接请求
-        if (listen(socketFd, backup) == -1) {
-            log.error(fmt::format("Fail to listen socket fd {}:{}", address, port));
+        if (listen(socketFd, options.backlog) == -1) {
+            log.error("Fail to listen socket fd {}:{}", address, port);
             exit(2);
         }
+
+        // 监听 socket 交给事件循环，边缘触发下每次就绪都要 accept 到 EAGAIN 为止
+        loop.add(socketFd, EPOLLIN | EPOLLET);
+
+        setupRoutes();
+        ResponseWriter(overloadResponse)
+                .status(HttpStatus::SERVICE_UNAVAILABLE)
+                .header(HttpHeader::RETRY_AFTER, static_cast<size_t>(std::max(options.retryAfterSeconds, 0)))
+                .header(HttpHeader::CONTENT_LENGTH, size_t(0))
+                .connection(false)
+                .end();
     }
 
-    ~Server() {
+    ~ServerShard() {
         isShutdown = true;
+        loop.quit();
+        // 线程池中的任务引用着分片与协程中的等待体，等它们全部结束；它们投递回来的恢复不再执行
+        {
+            std::unique_lock<std::mutex> lock(poolTasksMutex);
+            poolTasksDone.wait(lock, [this]() { return poolTasks == 0; });
+        }
+        loop.discardPendingTasks();
+        // 再销毁仍在挂起的协程，它们引用着连接与分片
+        if (acceptor)
+            acceptor.destroy();
+        for (auto &[fd, connection]: connections) {
+            if (connection->handler)
+                connection->handler.destroy();
+        }
+        for (auto &[fd, connection]: connections) {
+            if (!connection->isCloseSubmitted) // io_uring 后端中已提交的关闭可能已经完成，描述符可能已被复用
+                close(fd);
+        }
+        metrics.activeConnections.sub(static_cast<int64_t>(connections.size()));
         close(socketFd);
     }
 
     /**
-     * 启动服务器
+     * 在当前线程中运行事件循环，直到 shutdown() 被调用
+     *
+     * 每个连接由一个协程驱动，事件循环线程负责 accept 以及所有连接的读写，只把解析好的请求派发给线程池（或直接处理）
      */
-    void setup() {
-        int connection;
-        char clientIP[INET_ADDRSTRLEN] = "";
+    void run() {
+        if (options.ioBackend == IoBackend::IO_URING && setupRing()) {
+            runRing();
+            return;
+        }
+        spawn(acceptor, acceptConnections());
+        loop.loop([this](int fd, uint32_t events) {
+            if (fd == socketFd) {
+                listener.notify(events);
+                return;
+            }
+            auto it = connections.find(fd);
+            if (it != connections.end())
+                it->second->io.notify(events);
+        });
+    }
+
+    bool shutdown() {
+        isShutdown = true;
+        loop.quit();
+        return true;
+    }
+
+    /**
+     * 已接受的连接数
+     */
+    size_t acceptedConnections() const {
+        return accepted.load(std::memory_order_relaxed);
+    }
+
+    const AssetCache &cache() const {
+        return assetCache;
+    }
+
+    const AdmissionController &admissionController() const {
+        return admission;
+    }
+
+private:
+    /**
+     * 启动独立运行的协程，slot 保存它的 handle，分片析构时销毁仍在挂起的协程
+     */
+    static void spawn(std::coroutine_handle<> &slot, Detached task) {
+        slot = task.handle();
+        task.start();
+    }
+
+    /**
+     * 接受连接（epoll 后端）：没有已完成握手的连接时挂起，直到监听 socket 再次可读
+     */
+    Detached acceptConnections() {
         struct sockaddr_in clientAddr{};
-        socklen_t clientAddrLen = sizeof(clientAddr);
 
-        log.info("Already setup and ready to accept requests.");
+        while (true) {
+            auto fd = static_cast<int>(co_await listener.accept(&clientAddr));
+            if (fd < 0) {
+                if (fd != -ECONNABORTED) {
+                    // 如文件描述符用尽：等到下一个连接到来时再重试
+                    log.warning("Fail to accept a new connection: {}", strerror(-fd));
+                    co_await listener.wait(EPOLLIN);
+                }
+                continue;
+            }
 
-        while (!isShutdown) {
-            connection = accept(socketFd, (struct sockaddr *) &clientAddr, &clientAddrLen);
-            if (connection < 0) {
-                log.warning("Fail to accept a new connection");
+            if (isAtConnectionLimit()) {
+                rejectConnection(fd);
+                continue;
+            }
+            auto start = std::chrono::steady_clock::now();
+            Connection &connection = addConnection(fd, peerName(clientAddr));
+            // 读写事件一次注册，边缘触发下 EPOLLOUT 只在发送缓冲区由满变为可写时通知
+            if (!loop.add(fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET)) {
+                log.warning("Fail to register connection {}", fd);
+                closeConnection(fd);
                 continue;
             }
+            metrics.acceptLatency.observeSince(start);
+            startHandler(connection);
+        }
+    }
+
+    Connection &addConnection(int fd, std::string peer) {
+        accepted.fetch_add(1, std::memory_order_relaxed);
+        metrics.acceptedConnections.add();
+        if (options.tcpNoDelay) {
+            int enable = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        }
+        log.info("Connection built: {}", peer);
+
+        auto connection = makePooled<Connection>(&bufferPool, fd, nextConnectionId++, std::move(peer), &bufferPool);
+        Connection &result = *connection;
+        result.timeout.setCallback([this, &result]() { onTimeout(result); });
+        setTimeout(result, ConnectionTimeout::REQUEST);
+        connections.emplace(fd, std::move(connection));
+        metrics.activeConnections.add();
+        return result;
+    }
+
+    bool isAtConnectionLimit() const {
+        return connectionLimit > 0 && connections.size() >= connectionLimit;
+    }
+
+    /**
+     * 连接数达到上限：尽力发送预先生成的 503 后立即关闭，不为它建立连接对象
+     *
+     * 先读走已经到达的请求：关闭时接收缓冲区中还有数据，内核会发送 RST，客户端可能来不及读到 503
+     */
+    void rejectConnection(int fd) {
+        metrics.shedConnections.add();
+        metrics.response(HttpStatus::SERVICE_UNAVAILABLE);
+        recv(fd, receiveBuffer.data(), receiveBuffer.size(), MSG_DONTWAIT);
+        send(fd, overloadResponse.data(), overloadResponse.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        close(fd);
+    }
+
+    /**
+     * 过载时的响应：预先生成的 503，发送后关闭连接，请求不进入线程池
+     */
+    OutgoingMessage overloaded(Connection &connection) {
+        metrics.shedRequests.add();
+        metrics.response(HttpStatus::SERVICE_UNAVAILABLE);
+        connection.isCloseAfterWrite = true;
+        return OutgoingMessage(std::string(), overloadResponse);
+    }
+
+    static std::string peerName(const sockaddr_in &address) {
+        char ip[INET_ADDRSTRLEN] = "";
+        inet_ntop(AF_INET, &address.sin_addr, ip, INET_ADDRSTRLEN);
+        return std::string(ip) + ":" + std::to_string(ntohs(address.sin_port));
+    }
 
-            inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
-            log.info("Connection built: " + std::string(clientIP) + ":" +
-                     std::to_string(ntohs(clientAddr.sin_port)));
-
-            // 使用线程池进行 HTTP 解析任务的派发
-            log.info("Submit to Thread Pool");
-            getThreadPool().submit([this, connection]() {
-                char buf[8192];
-                memset(buf, 0, sizeof(buf));
-                long len = recv(connection, buf, sizeof(buf), 0);
-                assert(len >= 0);
-
-                HttpRequest request = HttpHandler::resolveRequest(buf);
-                log.info(fmt::format("{} request for {}", request.method, request.url));
-
-                if (request.url == "/" || request.url == "/index") { // 首页
-                    if (auto result = FileUtil::getStaticResource("index.html"); result.second) {
-                        HttpResponse httpResponse("HTTP/1.1", "200", "OK", HttpHeaders::empty(), result.first);
-                        std::string response = HttpHandler::serializeResponse(std::move(httpResponse));
-                        send(connection, response.c_str(), response.size(), 0);
-                    } else {
-                        log.error("Cannot get file index.html");
-                    }
-                } else if (auto result = FileUtil::getStaticResource(request.url.substr(1)); result.second) {
-                    HttpResponse httpResponse("HTTP/1.1", "200", "OK", HttpHeaders::empty(), result.first);
-                    std::string response = HttpHandler::serializeResponse(std::move(httpResponse));
-                    send(connection, response.c_str(), response.size(), 0);
-                } else if (result = FileUtil::getStaticResource("404.html"); result.second) { // 404
-                    HttpResponse httpResponse("HTTP/1.1", "404", "Not Found", HttpHeaders::empty(), result.first);
-                    std::string response = HttpHandler::serializeResponse(std::move(httpResponse));
-                    send(connection, response.c_str(), response.size(), 0);
+    /**
+     * 取出一个循环使用的响应头缓冲区（清空但保留容量），由分片的全部连接共用
+     */
+    std::string takeHeadBuffer() {
+        if (spareHeadBuffers.empty())
+            return {};
+        std::string buffer = std::move(spareHeadBuffers.back());
+        spareHeadBuffers.pop_back();
+        buffer.clear();
+        return buffer;
+    }
+
+    /**
+     * 响应发送完后归还响应头缓冲区
+     */
+    void recycleHeadBuffer(std::string &&buffer) {
+        if (spareHeadBuffers.size() < MAX_SPARE_HEAD_BUFFERS && buffer.capacity() > 0)
+            spareHeadBuffers.push_back(std::move(buffer));
+    }
+
+    /**
+     * 启动驱动连接的协程（返回时连接可能已被关闭）
+     */
+    void startHandler(Connection &connection) {
+        Detached task = handleConnection(connection);
+        connection.handler = task.handle();
+        task.start();
+    }
+
+    /**
+     * 驱动一个连接的协程：读取请求、处理、发送响应，直到连接关闭
+     *
+     * 在事件循环线程中处理时，先依次处理读缓冲区中流水线的全部请求，再把响应合并发送；
+     * 交给线程池处理时，每个响应生成后立即发送。同一连接上的请求依次处理，响应总是按请求顺序返回
+     */
+    Detached handleConnection(Connection &connection) {
+        while (true) {
+            ParseResult result = parse(connection);
+            if (result == ParseResult::COMPLETE) {
+                clearTimeout(connection); // 处理请求期间不计时
+                const HttpRequestView &request = connection.parser.request();
+                bool keepAlive = HttpHandler::isKeepAlive(request) &&
+                                 ++connection.requestCount < options.maxKeepAliveRequests;
+                OutgoingMessage response;
+                if (options.handleInLoop) {
+                    response = handleRequest(request, keepAlive, takeHeadBuffer());
+                    connection.readBuffer.erase(0, connection.parser.consumed());
+                    connection.parser.reset();
+                } else if (!admission.tryAcquire()) { // 超过并发上限：不排队，立即拒绝
+                    response = overloaded(connection);
+                    connection.readBuffer.erase(0, connection.parser.consumed());
+                    connection.parser.reset();
                 } else {
-                    assert(0);
+                    response = co_await HandleInPool(*this, connection, keepAlive);
+                }
+                if (response.empty())
+                    break;
+                if (!keepAlive) {
+                    connection.isCloseAfterWrite = true;
                 }
+                response.queuedAt = std::chrono::steady_clock::now();
+                enqueue(connection, std::move(response));
+                if (options.handleInLoop && !connection.isCloseAfterWrite &&
+                    connection.outgoing.size() < MAX_BATCHED_RESPONSES)
+                    continue;
+            }
+
+            if (!connection.outgoing.empty()) {
+                setTimeout(connection, ConnectionTimeout::WRITE); // 每次有进展时推迟（见 advance()）
+                bool isFlushed = co_await flush(connection);
+                clearTimeout(connection);
+                if (!isFlushed)
+                    break;
+            }
+            if (connection.isCloseAfterWrite)
+                break;
+            if (result == ParseResult::NEED_MORE) {
+                armReceiveTimeout(connection);
+                if (!co_await receive(connection))
+                    break;
+            }
+        }
+        finish(connection);
+    }
+
+    /**
+     * 协程结束时关闭连接：先清除保存的协程 handle，关闭后连接可能已被销毁
+     */
+    void finish(Connection &connection) {
+        connection.handler = {};
+        clearTimeout(connection);
+        closeConnection(connection.fd);
+    }
 
-                close(connection);
+    /**
+     * 把解析好的请求交给线程池处理，响应生成后回到事件循环线程恢复连接的协程
+     *
+     * 处理期间连接的协程挂起，不会再解析读缓冲区，工作线程可以直接读取解析器中的请求视图
+     */
+    class HandleInPool {
+    public:
+        HandleInPool(ServerShard &shard, Connection &connection, bool keepAlive)
+                : shard_(shard), connection_(connection), keepAlive_(keepAlive) {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        /**
+         * @return 是否挂起，线程池队列已满时不挂起，直接以 503 回应
+         */
+        bool await_suspend(std::coroutine_handle<> handle) {
+            // 把请求占用的字节复制给工作线程（io_uring 后端中读缓冲区在处理期间仍会追加数据），请求视图随之重新定位；
+            // 副本放在连接的内存区域中（上一个请求已处理完，可以重置），读缓冲区保留容量，都不分配堆内存
+            size_t consumed = connection_.parser.consumed();
+            base_ = connection_.readBuffer.data();
+            connection_.arena.reset();
+            auto *raw = static_cast<char *>(connection_.arena.allocate(consumed, 1));
+            std::memcpy(raw, base_, consumed);
+            raw_ = std::string_view(raw, consumed);
+            connection_.readBuffer.erase(0, consumed);
+            head_ = shard_.takeHeadBuffer();
+            handle_ = handle;
+            postedAt_ = std::chrono::steady_clock::now();
+
+            // 使用线程池进行请求处理任务的派发，任务只捕获 this，不分配堆内存；排队时间驱动准入控制
+            LOG_DEBUG(shard_.log, "Post to Thread Pool");
+            {
+                const std::lock_guard<std::mutex> lockGuard(shard_.poolTasksMutex);
+                ++shard_.poolTasks;
+            }
+            bool isPosted = getThreadPool().tryPost([this]() {
+                ServerShard &shard = shard_; // 投递恢复之后协程可能已继续运行，等待体随时失效
+                std::chrono::nanoseconds wait = std::chrono::steady_clock::now() - postedAt_;
+                shard.metrics.taskWait.observe(wait);
+                HttpRequestView request = connection_.parser.request().rebased(base_, raw_.data());
+                response_ = shard.handleRequest(request, keepAlive_, std::move(head_));
+                shard.admission.release(wait);
+                shard.loop.runInLoop([this]() { handle_.resume(); });
+                // 最后一次访问分片：持有锁时通知，分片析构要等这里释放锁之后才能继续
+                const std::lock_guard<std::mutex> lockGuard(shard.poolTasksMutex);
+                if (--shard.poolTasks == 0)
+                    shard.poolTasksDone.notify_all();
             });
+            if (!isPosted) { // 队列已满与排队过久一样是拥塞，降低并发上限
+                {
+                    const std::lock_guard<std::mutex> lockGuard(shard_.poolTasksMutex);
+                    --shard_.poolTasks;
+                }
+                shard_.admission.release(std::chrono::nanoseconds::max());
+                shard_.recycleHeadBuffer(std::move(head_));
+                response_ = shard_.overloaded(connection_);
+            }
+            return isPosted;
+        }
+
+        OutgoingMessage await_resume() {
+            connection_.parser.reset();
+            return std::move(response_);
+        }
+
+    private:
+        ServerShard &shard_;
+
+        Connection &connection_;
+
+        bool keepAlive_;
+
+        const char *base_ = nullptr;
+
+        std::string_view raw_;
+
+        std::string head_;
+
+        OutgoingMessage response_;
+
+        std::coroutine_handle<> handle_;
+
+        std::chrono::steady_clock::time_point postedAt_;
+    };
+
+    /**
+     * 响应加入发送队列，分段的响应展开为依次发送的多个消息
+     */
+    static void enqueue(Connection &connection, OutgoingMessage &&response) {
+        std::vector<OutgoingMessage> parts = std::move(response.continuation);
+        auto queuedAt = response.queuedAt;
+        connection.outgoing.push_back(std::move(response));
+        for (OutgoingMessage &part: parts) {
+            part.queuedAt = queuedAt;
+            connection.outgoing.push_back(std::move(part));
         }
     }
 
-    bool shutdown() {
-        isShutdown = true;
+    /**
+     * 解析读缓冲区起始处的请求；请求格式错误时加入 400 响应，之后不会再有完整请求时标记发送后关闭
+     */
+    ParseResult parse(Connection &connection) {
+        auto start = std::chrono::steady_clock::now();
+        ParseResult result = connection.parser.parse(connection.readBuffer);
+        if (result != ParseResult::NEED_MORE) {
+            metrics.parseLatency.observeSince(start);
+        }
+        if (result == ParseResult::MALFORMED) {
+            log.warning("Malformed request from {}", connection.peer);
+            metrics.parseErrors.add();
+            metrics.response(HttpStatus::BAD_REQUEST);
+            connection.outgoing.emplace_back(std::string(), BAD_REQUEST_RESPONSE).queuedAt = start;
+            connection.isCloseAfterWrite = true;
+        } else if (result == ParseResult::NEED_MORE && connection.isPeerClosed) {
+            // 对端已关闭且不会再有完整请求
+            connection.isCloseAfterWrite = true;
+        }
+        return result;
+    }
+
+    /**
+     * 等待并读取更多数据
+     *
+     * @return 连接是否仍然可用（对端关闭时也可用，由 isPeerClosed 标记）
+     */
+    Coroutine<bool> receive(Connection &connection) {
+        return ring ? receiveRing(connection) : receiveSocket(connection);
+    }
+
+    Coroutine<bool> receiveSocket(Connection &connection) {
+        ssize_t len = co_await connection.io.read(receiveBuffer.data(), receiveBuffer.size());
+        if (len < 0)
+            co_return false;
+        if (len == 0) {
+            connection.isPeerClosed = true;
+        } else {
+            connection.readBuffer.append(receiveBuffer.data(), len);
+        }
+        co_return checkReceived(connection);
+    }
+
+    /**
+     * io_uring 后端中多次触发的 recv 在 onReceived() 里把数据追加到读缓冲区，这里只等待它的通知
+     */
+    Coroutine<bool> receiveRing(Connection &connection) {
+        int result = co_await connection.received.wait();
+        co_return result >= 0 && checkReceived(connection);
+    }
+
+    bool checkReceived(Connection &connection) {
+        // 空闲的持久连接收到下一个请求的开头，改为等待完整请求的期限
+        if (connection.timeoutKind == ConnectionTimeout::IDLE && !connection.readBuffer.empty())
+            setTimeout(connection, ConnectionTimeout::REQUEST);
+        if (connection.readBuffer.size() > MAX_REQUEST_SIZE) {
+            log.warning("Request from {} is too large", connection.peer);
+            return false;
+        }
         return true;
     }
 
-private:
+    /**
+     * 发送队列中的全部响应
+     *
+     * @return 是否全部发送成功
+     */
+    Coroutine<bool> flush(Connection &connection) {
+        return ring ? flushRing(connection) : flushSocket(connection);
+    }
+
+    /**
+     * 收集发送队列开头的内存部分，遇到带文件部分的消息时停止（文件部分必须按顺序发送）
+     *
+     * @return 使用的 iovec 个数，以及是否停在了文件部分之前
+     */
+    static std::pair<int, bool> gather(Connection &connection, iovec *iov) {
+        int count = 0;
+        for (auto it = connection.outgoing.begin();
+             it != connection.outgoing.end() && count + 2 <= static_cast<int>(Connection::MAX_IOV); ++it) {
+            count += it->fill(iov + count);
+            if (it->hasFile())
+                return {count, true};
+        }
+        return {count, false};
+    }
+
+    /**
+     * 发送了 sent 字节：逐个推进已发送完的响应
+     */
+    void advance(Connection &connection, size_t sent) {
+        metrics.sentBytes.add(sent);
+        if (sent > 0) // 发送有进展，推迟发送超时
+            setTimeout(connection, ConnectionTimeout::WRITE);
+        while (sent > 0 && !connection.outgoing.empty()) {
+            OutgoingMessage &message = connection.outgoing.front();
+            size_t step = std::min(sent, message.remaining());
+            message.sent += step;
+            sent -= step;
+            if (message.remaining() == 0) {
+                metrics.sendLatency.observeSince(message.queuedAt);
+                recycleHeadBuffer(std::move(message.head));
+                connection.outgoing.pop_front();
+            }
+        }
+    }
+
+    /**
+     * 直接调用系统调用发送，发送缓冲区满时挂起，等 socket 可写后从中断处继续
+     *
+     * 响应头与内存中的响应体作为独立的 iovec 一次 writev（多个流水线响应合并发送），
+     * 文件部分用 sendfile 直接从页缓存发送
+     */
+    Coroutine<bool> flushSocket(Connection &connection) {
+        while (!connection.outgoing.empty()) {
+            OutgoingMessage &front = connection.outgoing.front();
+            ssize_t len;
+
+            if (front.isSendingFile()) {
+                off_t offset = front.fileOffset + static_cast<off_t>(front.sent - front.memorySize());
+                len = co_await connection.io.sendfile(front.fileFd, offset, front.remaining());
+                if (len == 0) { // 文件在发送期间被截断，响应无法完整发送
+                    log.warning("File truncated while sending to {}", connection.peer);
+                    co_return false;
+                }
+            } else {
+                auto [count, moreToCome] = gather(connection, connection.iov.data());
+                connection.message = {};
+                connection.message.msg_iov = connection.iov.data();
+                connection.message.msg_iovlen = count;
+                // 后面紧跟文件部分时提示内核暂缓发送，让响应头与文件开头合并到同一个报文
+                len = co_await connection.io.write(&connection.message, moreToCome ? MSG_MORE : 0);
+            }
+            if (len < 0)
+                co_return false;
+
+            // 部分写入：逐个推进已发送完的响应
+            advance(connection, static_cast<size_t>(len));
+        }
+        co_return true;
+    }
+
+    /**
+     * 在事件循环的时间轮上布置连接的超时（重新布置时替换原来的到期时间）
+     */
+    void setTimeout(Connection &connection, ConnectionTimeout kind) {
+        int seconds = kind == ConnectionTimeout::REQUEST ? options.requestTimeoutSeconds
+                    : kind == ConnectionTimeout::IDLE ? options.keepAliveTimeoutSeconds
+                    : options.writeTimeoutSeconds;
+        connection.timeoutKind = kind;
+        loop.timeouts().arm(connection.timeout, std::chrono::seconds(seconds));
+    }
+
+    static void clearTimeout(Connection &connection) {
+        connection.timeout.cancel();
+        connection.timeoutKind = ConnectionTimeout::NONE;
+    }
+
+    /**
+     * 等待读取之前：没有布置超时时，读缓冲区为空的持久连接等待空闲超时，否则等待完整请求的期限
+     */
+    void armReceiveTimeout(Connection &connection) {
+        if (connection.timeout.isArmed())
+            return;
+        bool isIdle = connection.readBuffer.empty() && connection.requestCount > 0;
+        setTimeout(connection, isIdle ? ConnectionTimeout::IDLE : ConnectionTimeout::REQUEST);
+    }
+
+    /**
+     * 超时到期：取消连接正在等待的 I/O，由协程自己关闭连接
+     *
+     * 之后连接可能已被销毁，不能再访问
+     */
+    void onTimeout(Connection &connection) {
+        ConnectionTimeout kind = std::exchange(connection.timeoutKind, ConnectionTimeout::NONE);
+        metrics.timeout(kind);
+        log.info("Connection {} timed out ({})", connection.peer, ServerMetrics::timeoutName(kind));
+        if (!ring) {
+            connection.io.cancel();
+        } else if (kind == ConnectionTimeout::WRITE) {
+            // 在途的发送被取消后以 -ECANCELED 完成
+            ring->cancelFd(connection.fd, tag(RingOp::CANCEL, connection.fd), true);
+        } else {
+            connection.received.notify(-ECANCELED);
+        }
+    }
+
+    void closeConnection(int fd) {
+        if (ring) {
+            closeRing(fd);
+            return;
+        }
+        loop.remove(fd);
+        close(fd);
+        if (connections.erase(fd) > 0) {
+            metrics.activeConnections.sub();
+        }
+    }
+
+    /**
+     * io_uring 请求的种类，与文件描述符一起编码在 user_data 中
+     *
+     * 连接的全部请求都在关闭请求之前完成，关闭完成后才从连接表中移除，因此文件描述符被复用时不会串号
+     */
+    enum class RingOp : uint8_t {
+        WAKEUP,
+        ACCEPT,
+        RECV,
+        SEND,
+        READ_FILE,
+        CANCEL,
+        CLOSE,
+    };
+
+    static uint64_t tag(RingOp op, int fd = 0) {
+        return static_cast<uint64_t>(op) << 32 | static_cast<uint32_t>(fd);
+    }
+
+    /**
+     * 在事件循环线程中创建 io_uring（只允许创建它的线程提交）、接收缓冲区环与注册文件表
+     *
+     * @return 是否可以使用 io_uring
+     */
+    bool setupRing() {
+        try {
+            ring = std::make_unique<IoUring>(RING_ENTRIES);
+            recvBuffers = std::make_unique<BufferRing>(*ring, 0, RECV_BUFFERS, RECV_BUFFER_SIZE);
+        } catch (const std::exception &e) {
+            log.warning("Fail to set up io_uring ({}), fall back to epoll", e.what());
+            recvBuffers.reset();
+            ring.reset();
+            return false;
+        }
+        if (ring->registerSparseFiles(FIXED_FILES)) {
+            fixedFiles.resize(FIXED_FILES);
+        }
+        return true;
+    }
+
+    /**
+     * io_uring 事件循环：一次 io_uring_enter 提交上一轮产生的全部请求并等待新的完成事件
+     *
+     * 监听 socket 使用多次触发的 accept，连接使用多次触发的 recv（数据放在接收缓冲区环中），
+     * 其他线程投递的任务通过对 eventfd 的多次触发 poll 唤醒；完成事件恢复等待它的连接协程
+     */
+    void runRing() {
+        ring->pollMultishot(loop.wakeupFd(), POLLIN, tag(RingOp::WAKEUP));
+        ring->acceptMultishot(socketFd, tag(RingOp::ACCEPT));
+
+        while (!loop.isQuit()) {
+            int result = ring->submitAndWait(1, loop.nextTimeoutMs());
+            if (result < 0 && result != -EBUSY && result != -EAGAIN) {
+                log.error("Fail to enter io_uring: {}", strerror(-result));
+                break;
+            }
+            ring->forEachCompletion([this](const io_uring_cqe &cqe) { onCompletion(cqe); });
+            loop.runExpiredTimers();
+        }
+    }
+
+    void onCompletion(const io_uring_cqe &cqe) {
+        auto op = static_cast<RingOp>(cqe.user_data >> 32);
+        auto fd = static_cast<int>(static_cast<uint32_t>(cqe.user_data));
+        bool more = cqe.flags & IORING_CQE_F_MORE; // 多次触发的请求仍然有效
+
+        switch (op) {
+            case RingOp::WAKEUP:
+                loop.handleWakeup();
+                if (!more)
+                    ring->pollMultishot(loop.wakeupFd(), POLLIN, tag(RingOp::WAKEUP));
+                break;
+            case RingOp::ACCEPT:
+                if (cqe.res >= 0) {
+                    onAccepted(cqe.res);
+                } else if (cqe.res != -EAGAIN && cqe.res != -EINTR && cqe.res != -ECONNABORTED) {
+                    log.warning("Fail to accept a new connection: {}", strerror(-cqe.res));
+                }
+                if (!more && !isShutdown)
+                    ring->acceptMultishot(socketFd, tag(RingOp::ACCEPT));
+                break;
+            case RingOp::RECV:
+                onReceived(fd, cqe);
+                break;
+            case RingOp::SEND:
+            case RingOp::READ_FILE:
+                if (auto it = connections.find(fd); it != connections.end()) {
+                    it->second->completed.notify(cqe.res);
+                }
+                break;
+            case RingOp::CANCEL:
+                break;
+            case RingOp::CLOSE:
+                if (cqe.res != -ECANCELED && connections.erase(fd) > 0) { // 被取消说明链接中的发送失败，由协程重新关闭
+                    metrics.activeConnections.sub();
+                }
+                break;
+        }
+    }
+
+    void onAccepted(int fd) {
+        if (isAtConnectionLimit()) {
+            rejectConnection(fd);
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::string peer;
+        // 对端地址只用于日志，不输出 INFO 日志时省去一次 getpeername
+        struct sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        if (log.isEnabled(LogLevel::INFO) && getpeername(fd, (struct sockaddr *) &address, &length) == 0) {
+            peer = peerName(address);
+        } else {
+            peer = "fd " + std::to_string(fd);
+        }
+        Connection &connection = addConnection(fd, std::move(peer));
+        ring->recvMultishot(fd, recvBuffers->group(), tag(RingOp::RECV, fd));
+        metrics.acceptLatency.observeSince(start);
+        startHandler(connection);
+    }
+
+    void onReceived(int fd, const io_uring_cqe &cqe) {
+        bool hasBuffer = cqe.flags & IORING_CQE_F_BUFFER;
+        uint16_t bufferId = BufferRing::bufferId(cqe.flags);
+        auto it = connections.find(fd);
+        if (it == connections.end() || it->second->isCloseSubmitted) {
+            if (hasBuffer)
+                recvBuffers->recycle(bufferId);
+            return;
+        }
+        Connection &connection = *it->second;
+
+        if (cqe.res > 0) {
+            connection.readBuffer.append(recvBuffers->data(bufferId, cqe.res));
+            recvBuffers->recycle(bufferId);
+        } else if (cqe.res == 0) {
+            connection.isPeerClosed = true;
+        }
+        bool isFailed = cqe.res < 0 && cqe.res != -ENOBUFS; // 接收缓冲区暂时用完时重新提交即可
+        if (!(cqe.flags & IORING_CQE_F_MORE) && !connection.isPeerClosed && !isFailed) {
+            ring->recvMultishot(fd, recvBuffers->group(), tag(RingOp::RECV, fd));
+        }
+        if (cqe.res != -ENOBUFS) {
+            connection.received.notify(cqe.res);
+        }
+    }
+
+    /**
+     * 依次提交发送队列开头的数据并等待完成：内存部分一次 sendmsg，文件部分先读入连接的分块缓冲区再发送；
+     * 最后一次发送后需要关闭连接时，把关闭请求链接在发送之后，与发送一同提交
+     */
+    Coroutine<bool> flushRing(Connection &connection) {
+        while (!connection.outgoing.empty()) {
+            OutgoingMessage &front = connection.outgoing.front();
+            int iovCount;
+            size_t bytes = 0;
+            bool isLast;
+
+            if (front.isSendingFile()) {
+                readFileChunk(connection, front);
+                int result = co_await connection.completed.wait();
+                if (result <= 0) {
+                    log.warning("Fail to read file for {}", connection.peer);
+                    co_return false;
+                }
+                bytes = static_cast<size_t>(result);
+                connection.iov[0] = {connection.fileChunk.data(), bytes};
+                iovCount = 1;
+                isLast = connection.outgoing.size() == 1 && front.remaining() == bytes;
+            } else {
+                auto [count, moreToCome] = gather(connection, connection.iov.data());
+                for (int i = 0; i < count; ++i) {
+                    bytes += connection.iov[i].iov_len;
+                }
+                size_t total = 0;
+                for (auto &message: connection.outgoing) {
+                    total += message.remaining();
+                }
+                iovCount = count;
+                isLast = bytes == total && !moreToCome;
+            }
+
+            submitSend(connection, iovCount, isLast && connection.isCloseAfterWrite);
+            int result = co_await connection.completed.wait();
+            // MSG_WAITALL 下结果不足说明连接出错，链接在后面的关闭请求已被取消
+            if (result < 0 || static_cast<size_t>(result) < bytes) {
+                connection.isCloseSubmitted = false;
+                co_return false;
+            }
+            advance(connection, static_cast<size_t>(result));
+        }
+        co_return true;
+    }
+
+    /**
+     * @param closeAfter 是否在发送之后关闭连接
+     */
+    void submitSend(Connection &connection, int iovCount, bool closeAfter) {
+        connection.message = {};
+        connection.message.msg_iov = connection.iov.data();
+        connection.message.msg_iovlen = iovCount;
+
+        ring->sendmsg(connection.fd, &connection.message, tag(RingOp::SEND, connection.fd), closeAfter);
+        if (closeAfter) {
+            // 发送成功后取消连接上的 recv，然后关闭；发送失败时两者都被取消
+            ring->cancelFd(connection.fd, tag(RingOp::CANCEL, connection.fd), true);
+            ring->close(connection.fd, tag(RingOp::CLOSE, connection.fd));
+            connection.isCloseSubmitted = true;
+        }
+    }
+
+    void readFileChunk(Connection &connection, const OutgoingMessage &message) {
+        if (connection.fileChunk.empty())
+            connection.fileChunk.resize(FILE_CHUNK_SIZE);
+        size_t fileSent = message.sent - message.memorySize();
+        auto length = static_cast<unsigned>(std::min(message.remaining(), FILE_CHUNK_SIZE));
+        int slot = fixedFileSlot(message);
+        ring->read(slot >= 0 ? slot : message.fileFd, slot >= 0, connection.fileChunk.data(), length,
+                   message.fileOffset + fileSent, tag(RingOp::READ_FILE, connection.fd));
+    }
+
+    /**
+     * 关闭连接：取消 recv 并关闭（协程结束时没有在途的发送）；关闭完成后才从连接表中移除
+     */
+    void closeRing(int fd) {
+        auto it = connections.find(fd);
+        if (it == connections.end() || it->second->isCloseSubmitted)
+            return;
+        it->second->isCloseSubmitted = true;
+        ring->cancelFd(fd, tag(RingOp::CANCEL, fd), true);
+        ring->close(fd, tag(RingOp::CLOSE, fd));
+    }
+
+    /**
+     * 文件在注册文件表中的位置，未注册时替换一个槽位（按顺序轮换）
+     *
+     * 以响应的 owner（资源对象）判断是否为同一个文件：资源被替换后，原文件描述符可能已被关闭并复用
+     *
+     * @return 槽位，无法注册时为 -1
+     */
+    int fixedFileSlot(const OutgoingMessage &message) {
+        if (fixedFiles.empty())
+            return -1;
+        for (size_t i = 0; i < fixedFiles.size(); ++i) {
+            const FixedFile &file = fixedFiles[i];
+            if (file.fd == message.fileFd && !file.owner.owner_before(message.owner) &&
+                !message.owner.owner_before(file.owner))
+                return static_cast<int>(i);
+        }
+        unsigned slot = nextFixedFile++ % fixedFiles.size();
+        if (!ring->updateFile(slot, message.fileFd))
+            return -1;
+        fixedFiles[slot] = {message.fileFd, message.owner};
+        return static_cast<int>(slot);
+    }
+
+    /**
+     * 处理请求（在工作线程中执行）
+     *
+     * @param request 请求的视图
+     * @param keepAlive 响应后是否保持连接
+     * @param head 用于写入响应头的缓冲区
+     * @return 待发送的响应，为空表示无法生成响应
+     */
+    OutgoingMessage handleRequest(const HttpRequestView &request, bool keepAlive, std::string &&head) {
+        auto start = std::chrono::steady_clock::now();
+        OutgoingMessage response = generateResponse(request, keepAlive, std::move(head));
+        metrics.handleLatency.observeSince(start);
+        return response;
+    }
+
+    /**
+     * 只支持 GET 与 HEAD，其他方法返回 405；HEAD 的响应与 GET 相同（包括 Content-Length），只是不发送响应体
+     */
+    OutgoingMessage generateResponse(const HttpRequestView &request, bool keepAlive, std::string &&head) {
+        log.info("{} request for {}", request.method, request.url);
+
+        bool isHead = request.method == "HEAD";
+        if (!isHead && request.method != "GET")
+            return methodNotAllowedResponse(keepAlive, std::move(head));
+
+        RouteParams params;
+        const RouteHandler *handler = router.match(request.url, params);
+        OutgoingMessage response = handler != nullptr ? (*handler)(request, params, keepAlive, std::move(head))
+                                                      : notFoundResponse(request, keepAlive, std::move(head));
+        if (isHead) {
+            response.body = {};
+            response.fileFd = -1;
+            response.fileOffset = 0;
+            response.fileLength = 0;
+            response.continuation.clear();
+            response.owner = nullptr;
+        }
+        return response;
+    }
+
+    OutgoingMessage methodNotAllowedResponse(bool keepAlive, std::string &&head) {
+        metrics.response(HttpStatus::METHOD_NOT_ALLOWED);
+        ResponseWriter(head)
+                .status(HttpStatus::METHOD_NOT_ALLOWED)
+                .date()
+                .connection(keepAlive)
+                .header(HttpHeader::ALLOW, "GET, HEAD")
+                .header(HttpHeader::CONTENT_LENGTH, size_t(0))
+                .end();
+        return OutgoingMessage(std::move(head));
+    }
+
+    /**
+     * 注册路由：指标、首页，其余路径都在静态资源目录中查找
+     */
+    void setupRoutes() {
+        if (options.metricsPath.starts_with('/')) { // 为空时不提供，其他形式的路径不会出现在请求中
+            router.route(options.metricsPath,
+                         [this](const HttpRequestView &, const RouteParams &, bool keepAlive, std::string &&head) {
+                             return metricsResponse(keepAlive, std::move(head));
+                         });
+        }
+        for (std::string_view index: {"/", "/index"}) {
+            if (index == options.metricsPath)
+                continue;
+            router.route(index, [this](const HttpRequestView &request, const RouteParams &, bool keepAlive,
+                                       std::string &&head) {
+                return staticResponse(request, "index.html", keepAlive, std::move(head));
+            });
+        }
+        router.mount("/", [this](const HttpRequestView &request, const RouteParams &params, bool keepAlive,
+                                 std::string &&head) {
+            thread_local std::string path; // 每个线程循环使用的路径缓冲区
+            if (!FileUtil::normalizePath(params.rest(), path))
+                return notFoundResponse(request, keepAlive, std::move(head));
+            if (path.empty()) // 目录的首页
+                path = "index.html";
+            return staticResponse(request, path, keepAlive, std::move(head));
+        });
+        router.compile();
+    }
+
+    OutgoingMessage metricsResponse(bool keepAlive, std::string &&head) {
+        metrics.response(HttpStatus::OK);
+        auto body = std::make_shared<const std::string>(metrics.registry.render());
+        ResponseWriter(head)
+                .status(HttpStatus::OK)
+                .date()
+                .connection(keepAlive)
+                .header(HttpHeader::CONTENT_TYPE, MetricsRegistry::CONTENT_TYPE)
+                .header(HttpHeader::CONTENT_LENGTH, body->size())
+                .end();
+        std::string_view view = *body;
+        return OutgoingMessage(std::move(head), view, std::move(body));
+    }
+
+    /**
+     * 静态资源目录中的资源，不存在时返回 404 页面
+     *
+     * @param path 规范化后的路径
+     */
+    OutgoingMessage staticResponse(const HttpRequestView &request, const std::string &path, bool keepAlive,
+                                   std::string &&head) {
+        AcceptEncoding accept(request.header(KnownHeader::ACCEPT_ENCODING));
+        if (auto asset = findAsset(path, accept))
+            return assetResponse(request, asset, keepAlive, std::move(head));
+        return notFoundResponse(request, keepAlive, std::move(head));
+    }
+
+    OutgoingMessage notFoundResponse(const HttpRequestView &request, bool keepAlive, std::string &&head) {
+        AcceptEncoding accept(request.header(KnownHeader::ACCEPT_ENCODING));
+        if (auto notFound = findAsset("404.html", accept)) {
+            metrics.response(HttpStatus::NOT_FOUND);
+            ResponseWriter(head)
+                    .status(HttpStatus::NOT_FOUND)
+                    .date()
+                    .connection(keepAlive)
+                    .fields(notFound->headerFields)
+                    .end();
+            return OutgoingMessage(std::move(head), notFound->content(), notFound);
+        }
+        log.error("Cannot get file 404.html");
+        return {};
+    }
+
+    /**
+     * 使用资源包时只在资源包中查找，否则经过资源缓存
+     */
+    std::shared_ptr<const Asset> findAsset(const std::string &path, const AcceptEncoding &accept) {
+        if (assetPack)
+            return assetPack->get(path, accept);
+        return assetCache.get(path, accept);
+    }
+
+    /**
+     * 静态资源的响应：按条件请求与范围请求返回 200、304、206 或 416，响应体都直接引用缓存中的资源，不复制
+     */
+    OutgoingMessage assetResponse(const HttpRequestView &request, const std::shared_ptr<const Asset> &asset,
+                                  bool keepAlive, std::string &&head) {
+        ByteRanges ranges;
+        auto outcome = ConditionalRequest::evaluate(request, asset->etag, asset->modifiedTime.tv_sec, asset->size,
+                                                    ranges);
+        // 多段的响应体不能再整体标注内容编码，压缩版本只支持单段范围
+        if (outcome == ConditionalRequest::Outcome::PARTIAL && ranges.size() > 1 &&
+            asset->encoding != ContentEncoding::IDENTITY)
+            outcome = ConditionalRequest::Outcome::FULL;
+
+        switch (outcome) {
+            case ConditionalRequest::Outcome::NOT_MODIFIED: {
+                metrics.response(HttpStatus::NOT_MODIFIED);
+                ResponseWriter writer(head);
+                writer.status(HttpStatus::NOT_MODIFIED).date().connection(keepAlive).fields(asset->validatorFields);
+                if (asset->isNegotiable)
+                    writer.header(HttpHeader::VARY, "Accept-Encoding");
+                writer.end();
+                return OutgoingMessage(std::move(head));
+            }
+            case ConditionalRequest::Outcome::RANGE_NOT_SATISFIABLE:
+                metrics.response(HttpStatus::RANGE_NOT_SATISFIABLE);
+                ResponseWriter(head)
+                        .status(HttpStatus::RANGE_NOT_SATISFIABLE)
+                        .date()
+                        .connection(keepAlive)
+                        .contentRange(asset->size)
+                        .header(HttpHeader::CONTENT_LENGTH, size_t(0))
+                        .end();
+                return OutgoingMessage(std::move(head));
+            case ConditionalRequest::Outcome::PARTIAL:
+                metrics.response(HttpStatus::PARTIAL_CONTENT);
+                return ranges.size() == 1 ? singleRangeResponse(asset, ranges[0], keepAlive, std::move(head))
+                                          : multipartResponse(asset, ranges, keepAlive, std::move(head));
+            default:
+                break;
+        }
+
+        metrics.response(HttpStatus::OK);
+        ResponseWriter(head)
+                .status(HttpStatus::OK)
+                .date()
+                .connection(keepAlive)
+                .fields(asset->headerFields)
+                .fields(asset->validatorFields)
+                .end();
+        return slice(std::move(head), asset, 0, asset->size);
+    }
+
+    OutgoingMessage singleRangeResponse(const std::shared_ptr<const Asset> &asset, const ByteRange &range,
+                                        bool keepAlive, std::string &&head) {
+        ResponseWriter writer(head);
+        writer.status(HttpStatus::PARTIAL_CONTENT)
+                .date()
+                .connection(keepAlive)
+                .header(HttpHeader::CONTENT_TYPE, asset->contentType)
+                .header(HttpHeader::CONTENT_LENGTH, range.length)
+                .contentRange(range.offset, range.last(), asset->size);
+        if (asset->encoding != ContentEncoding::IDENTITY)
+            writer.header(HttpHeader::CONTENT_ENCODING, ContentCoding::name(asset->encoding));
+        if (asset->isNegotiable)
+            writer.header(HttpHeader::VARY, "Accept-Encoding");
+        writer.fields(asset->validatorFields).end();
+        return slice(std::move(head), asset, range.offset, range.length);
+    }
+
+    /**
+     * multipart/byteranges 响应：每一段的分隔行与头字段是一个小消息，段的内容仍直接引用资源，依次加入发送队列
+     */
+    OutgoingMessage multipartResponse(const std::shared_ptr<const Asset> &asset, const ByteRanges &ranges,
+                                      bool keepAlive, std::string &&head) {
+        char digits[16];
+        auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), std::hash<std::string>()(asset->etag), 16);
+        std::string boundary = "webserver-" + std::string(digits, end - digits);
+
+        std::vector<OutgoingMessage> parts;
+        parts.reserve(ranges.size() + 1);
+        size_t length = 0;
+        for (const ByteRange &range: ranges) {
+            std::string partHead;
+            ResponseWriter writer(partHead);
+            partHead.append(parts.empty() ? "--" : "\r\n--").append(boundary).append(HttpStrings::CRLF);
+            writer.header(HttpHeader::CONTENT_TYPE, asset->contentType)
+                    .contentRange(range.offset, range.last(), asset->size)
+                    .end();
+            length += partHead.size() + range.length;
+            parts.push_back(slice(std::move(partHead), asset, range.offset, range.length));
+        }
+        std::string tail = "\r\n--" + boundary + "--\r\n";
+        length += tail.size();
+        parts.emplace_back(std::move(tail));
+
+        ResponseWriter writer(head);
+        writer.status(HttpStatus::PARTIAL_CONTENT)
+                .date()
+                .connection(keepAlive)
+                .header(HttpHeader::CONTENT_TYPE, "multipart/byteranges; boundary=" + boundary)
+                .header(HttpHeader::CONTENT_LENGTH, length);
+        if (asset->isNegotiable)
+            writer.header(HttpHeader::VARY, "Accept-Encoding");
+        writer.fields(asset->validatorFields).end();
+        OutgoingMessage response(std::move(head));
+        response.continuation = std::move(parts);
+        return response;
+    }
+
+    /**
+     * 响应头加上资源中的一段（大文件通过 sendfile 发送）
+     */
+    static OutgoingMessage slice(std::string &&head, const std::shared_ptr<const Asset> &asset, size_t offset,
+                                 size_t length) {
+        if (asset->isFileBacked())
+            return OutgoingMessage::fromFile(std::move(head), asset->file->fd(), static_cast<off_t>(offset), length,
+                                             asset);
+        return OutgoingMessage(std::move(head), asset->content().substr(offset, length), asset);
+    }
+
+    /**
+     * 多个事件循环平分的上限（向上取整），0 表示不限制
+     */
+    static size_t perLoop(size_t total, size_t eventLoops) {
+        eventLoops = std::max<size_t>(eventLoops, 1);
+        return (total + eventLoops - 1) / eventLoops;
+    }
+
+    /**
+     * 静态资源的压缩任务提交到线程池
+     */
+    static AssetCache::Executor compressor(const ServerOptions &options) {
+        if (!options.compressAssets)
+            return nullptr;
+        return [](std::function<void()> task) { getThreadPool().post(std::move(task)); };
+    }
+
+    static constexpr size_t MAX_REQUEST_SIZE = HttpParser::MAX_BODY_SIZE + 64 * 1024;
+
+    static constexpr size_t MAX_BATCHED_RESPONSES = Connection::MAX_IOV / 2; // 合并发送的流水线响应数（每个占两个 iovec）
+
+    static constexpr unsigned RING_ENTRIES = 1024;
+
+    static constexpr unsigned RECV_BUFFERS = 512; // 接收缓冲区环中的缓冲区个数（2 的幂）
+
+    static constexpr unsigned RECV_BUFFER_SIZE = 8192;
+
+    static constexpr unsigned FIXED_FILES = 64; // 注册文件表的大小
+
+    static constexpr size_t FILE_CHUNK_SIZE = 128 * 1024;
+
+    static constexpr size_t MAX_SPARE_HEAD_BUFFERS = 1024;
+
+    static constexpr std::string_view BAD_REQUEST_RESPONSE =
+            "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
     int socketFd;
 
+    AsyncFd listener; // 监听 socket（epoll 后端）
+
     struct sockaddr_in serverAddress{};
 
     std::atomic<bool> isShutdown;
 
+    std::atomic<size_t> accepted{0};
+
     Logger log;
+
+    ServerOptions options;
+
+    ServerMetrics &metrics;
+
+    AssetCache assetCache;
+
+    std::shared_ptr<const AssetPack> assetPack; // 所有分片共享的只读资源包，为空时使用 assetCache
+
+    AdmissionController admission; // 交给线程池的请求的并发上限
+
+    std::mutex poolTasksMutex;
+
+    std::condition_variable poolTasksDone;
+
+    size_t poolTasks = 0; // 已交给线程池、尚未结束的请求处理任务数，分片析构前等待它们结束
+
+    size_t connectionLimit; // 本分片的连接数上限，0 表示不限制
+
+    std::string overloadResponse; // 预先生成的 503 响应（带 Retry-After，发送后关闭连接）
+
+    /**
+     * 路由的处理器（在工作线程中执行），参数与 handleRequest 相同，另有匹配到的路由参数
+     */
+    using RouteHandler = std::function<OutgoingMessage(const HttpRequestView &, const RouteParams &, bool,
+                                                       std::string &&)>;
+
+    Router<RouteHandler> router; // 构造时注册，之后只读
+
+    EventLoop loop;
+
+    BufferPool bufferPool; // 连接对象、连接表与连接的缓冲区都从这里分配，只在事件循环线程中使用
+
+    std::pmr::unordered_map<int, PooledPtr<Connection>> connections{&bufferPool};
+
+    std::vector<std::string> spareHeadBuffers; // 发送完的响应头缓冲区（工作线程写入，因此不从缓冲区池分配）
+
+    uint64_t nextConnectionId = 0;
+
+    std::coroutine_handle<> acceptor; // 接受连接的协程（epoll 后端）
+
+    std::array<char, 8192> receiveBuffer{}; // epoll 后端读取 socket 的缓冲区，读到的数据随即追加到连接的读缓冲区
+
+    std::unique_ptr<IoUring> ring; // 使用 io_uring 后端时非空
+
+    std::unique_ptr<BufferRing> recvBuffers;
+
+    struct FixedFile {
+        int fd = -1;
+        std::weak_ptr<const void> owner;
+    };
+
+    std::vector<FixedFile> fixedFiles; // 注册文件表中每个槽位对应的文件
+
+    unsigned nextFixedFile = 0;
+};
+
+/**
+ * HTTP 服务器
+ *
+ * 默认只有一个事件循环（在调用 setup() 的线程中运行），请求交给线程池处理；
+ * eventLoops 大于 1 时进入无共享模式：每个事件循环线程各自拥有一个 SO_REUSEPORT 监听 socket、连接与缓存，
+ * 由内核在它们之间分配新连接，线程之间不传递连接
+ */
+class Server {
+public:
+    Server(const std::string &address, int port, Logger logger, ServerOptions options = ServerOptions())
+            : log(logger), metrics(registry) {
+        if (options.ioBackend == IoBackend::IO_URING && !IoUring::isSupported()) {
+            log.warning("io_uring is not supported by the kernel, fall back to epoll");
+            options.ioBackend = IoBackend::EPOLL;
+        }
+        size_t eventLoops = std::max<size_t>(options.eventLoops, 1);
+        options.eventLoops = eventLoops;
+        pinEventLoops = options.pinEventLoops;
+        std::shared_ptr<const AssetPack> assetPack = openAssetPack(options);
+        for (size_t i = 0; i < eventLoops; ++i) {
+            shards.push_back(std::make_unique<ServerShard>(address, port, logger, options, eventLoops > 1, metrics,
+                                                           assetPack));
+        }
+        registerCallbacks();
+    }
+
+    ~Server() {
+        shutdown();
+        joinThreads();
+    }
+
+    /**
+     * 启动服务器
+     *
+     * 第一个事件循环在当前线程中运行，其余各占一个线程；所有事件循环退出后返回
+     */
+    void setup() {
+        log.info("Already setup and ready to accept requests with {} event loop(s).", shards.size());
+
+        for (size_t i = 1; i < shards.size(); ++i) {
+            threads.emplace_back([this, i]() {
+                pinToCpu(i);
+                shards[i]->run();
+            });
+        }
+        pinToCpu(0);
+        shards[0]->run();
+        joinThreads();
+    }
+
+    bool shutdown() {
+        for (auto &shard: shards) {
+            shard->shutdown();
+        }
+        return true;
+    }
+
+    /**
+     * Prometheus 文本格式的当前指标
+     */
+    std::string renderMetrics() const {
+        return registry.render();
+    }
+
+    /**
+     * 每个事件循环已接受的连接数
+     */
+    std::vector<size_t> acceptedConnections() const {
+        std::vector<size_t> result;
+        for (auto &shard: shards) {
+            result.push_back(shard->acceptedConnections());
+        }
+        return result;
+    }
+
+private:
+    /**
+     * 按配置打开（需要时先生成）资源包，失败时退回资源缓存
+     */
+    std::shared_ptr<const AssetPack> openAssetPack(const ServerOptions &options) {
+        if (options.assetPack.empty() && !options.packAssetsOnStartup)
+            return nullptr;
+        std::string path = options.assetPack;
+        bool isTemporary = path.empty();
+        if (isTemporary) {
+            char pattern[] = "/tmp/webserver_assets_XXXXXX";
+            int fd = mkstemp(pattern);
+            if (fd < 0) {
+                log.warning("Fail to create a temporary asset pack, fall back to the asset cache");
+                return nullptr;
+            }
+            close(fd);
+            path = pattern;
+        }
+        if (options.packAssetsOnStartup && !AssetPack::build(options.staticRoot, path, options.compressAssets)) {
+            log.warning("Fail to pack {} into {}, fall back to the asset cache", options.staticRoot, path);
+            if (isTemporary)
+                unlink(path.c_str());
+            return nullptr;
+        }
+        auto pack = AssetPack::open(path);
+        if (isTemporary)
+            unlink(path.c_str()); // 删除文件后映射仍然有效
+        if (!pack) {
+            log.warning("Fail to open asset pack {}, fall back to the asset cache", path);
+            return nullptr;
+        }
+        log.info("Serving {} assets from {} ({} bytes mapped)", pack->size(), path, pack->mappedBytes());
+        return pack;
+    }
+
+    /**
+     * 注册抓取时才读取的指标：线程池队列长度、各分片的并发上限与资源缓存的命中情况
+     */
+    void registerCallbacks() {
+        registry.callback("webserver_thread_pool_queue_depth", "Tasks waiting in the thread pool", "gauge",
+                          []() { return static_cast<double>(getThreadPool().queueDepth()); });
+        registry.callback("webserver_admission_concurrency_limit",
+                          "Requests allowed in the thread pool at once, adjusted by queue wait time", "gauge",
+                          [this]() {
+                              size_t limit = 0;
+                              for (auto &shard: shards) {
+                                  limit += shard->admissionController().limit();
+                              }
+                              return static_cast<double>(limit);
+                          });
+        registry.callback("webserver_requests_in_flight", "Requests queued or running in the thread pool", "gauge",
+                          [this]() {
+                              size_t inFlight = 0;
+                              for (auto &shard: shards) {
+                                  inFlight += shard->admissionController().inFlight();
+                              }
+                              return static_cast<double>(inFlight);
+                          });
+        registry.callback("webserver_asset_cache_hits_total", "Asset cache hits", "counter",
+                          [this]() { return static_cast<double>(cacheLookups().first); });
+        registry.callback("webserver_asset_cache_misses_total", "Asset cache misses", "counter",
+                          [this]() { return static_cast<double>(cacheLookups().second); });
+        registry.callback("webserver_asset_cache_negative_hits_total",
+                          "Lookups of missing assets answered without touching the file system", "counter",
+                          [this]() {
+                              size_t negativeHits = 0;
+                              for (auto &shard: shards) {
+                                  negativeHits += shard->cache().negativeHits();
+                              }
+                              return static_cast<double>(negativeHits);
+                          });
+        registry.callback("webserver_asset_cache_hit_ratio", "Asset cache hits divided by lookups", "gauge",
+                          [this]() {
+                              auto [hits, misses] = cacheLookups();
+                              return hits + misses == 0 ? 0.0 : static_cast<double>(hits) /
+                                                                static_cast<double>(hits + misses);
+                          });
+    }
+
+    std::pair<size_t, size_t> cacheLookups() const {
+        size_t hits = 0, misses = 0;
+        for (auto &shard: shards) {
+            hits += shard->cache().hits();
+            misses += shard->cache().misses();
+        }
+        return {hits, misses};
+    }
+
+    void pinToCpu(size_t index) {
+        if (!pinEventLoops)
+            return;
+        unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cpus, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            log.warning("Fail to pin event loop {} to CPU {}", index, index % cpus);
+        }
+    }
+
+    void joinThreads() {
+        for (auto &thread: threads) {
+            if (thread.joinable())
+                thread.join();
+        }
+        threads.clear();
+    }
+
+    Logger log;
+
+    MetricsRegistry registry; // 先于分片构造、后于分片析构
+
+    ServerMetrics metrics;
+
+    bool pinEventLoops;
+
+    std::vector<std::unique_ptr<ServerShard>> shards;
+
+    std::vector<std::thread> threads;
 };
 
 #endif //WEBSERVER_SERVER_HPP
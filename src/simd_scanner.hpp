@@ -0,0 +1,200 @@
+#ifndef WEBSERVER_SIMD_SCANNER_HPP
+#define WEBSERVER_SIMD_SCANNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define WEBSERVER_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * 指令集等级
+ */
+enum class SimdLevel {
+    SCALAR = 0,
+    SSE42 = 1,
+    AVX2 = 2,
+};
+
+/**
+ * 请求解析用的分隔符扫描器
+ *
+ * 按 16（SSE4.2）或 32（AVX2）字节一组查找分隔符与非法字符，启动时根据 CPU 支持的指令集选择实现，
+ * 不支持时退回逐字节扫描；各实现都只处理完整的分组，剩余的尾部逐字节处理，不会越界读取
+ */
+class SimdScanner {
+public:
+    /**
+     * 查找第一个控制字符（0x00-0x1F 与 0x7F，水平制表符除外）
+     *
+     * 行尾的 '\r' 也是控制字符，因此一次扫描即可同时找到行尾并校验行内没有非法字符
+     *
+     * @return 控制字符的下标，不存在时返回 len
+     */
+    static size_t findControl(const char *data, size_t len) {
+        return dispatch().findControl(data, len);
+    }
+
+    /**
+     * 查找第一个等于 c 的字节（如 ' ' 与 ':'）
+     *
+     * @return 下标，不存在时返回 len
+     */
+    static size_t findChar(const char *data, size_t len, char c) {
+        return dispatch().findChar(data, len, c);
+    }
+
+    /**
+     * 当前使用的指令集等级
+     */
+    static SimdLevel level() {
+        return dispatch().level;
+    }
+
+    /**
+     * 强制使用指定的指令集等级（用于测试与基准测试），CPU 不支持时返回 false 并保持不变
+     */
+    static bool setLevel(SimdLevel level) {
+        if (level > detectLevel())
+            return false;
+        dispatch() = implementation(level);
+        return true;
+    }
+
+    /**
+     * CPU 支持的最高指令集等级
+     */
+    static SimdLevel detectLevel() {
+#ifdef WEBSERVER_SIMD_X86
+        if (__builtin_cpu_supports("avx2"))
+            return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.2"))
+            return SimdLevel::SSE42;
+#endif
+        return SimdLevel::SCALAR;
+    }
+
+private:
+    struct Implementation {
+        SimdLevel level;
+
+        size_t (*findControl)(const char *, size_t);
+
+        size_t (*findChar)(const char *, size_t, char);
+    };
+
+    static Implementation &dispatch() {
+        static Implementation impl = implementation(detectLevel());
+        return impl;
+    }
+
+    static Implementation implementation(SimdLevel level) {
+        switch (level) {
+#ifdef WEBSERVER_SIMD_X86
+            case SimdLevel::AVX2:
+                return {SimdLevel::AVX2, findControlAvx2, findCharAvx2};
+            case SimdLevel::SSE42:
+                return {SimdLevel::SSE42, findControlSse42, findCharSse42};
+#endif
+            default:
+                return {SimdLevel::SCALAR, findControlScalar, findCharScalar};
+        }
+    }
+
+    static bool isControl(char c) {
+        auto u = static_cast<unsigned char>(c);
+        return (u < 0x20 && u != '\t') || u == 0x7f;
+    }
+
+    static size_t findControlScalar(const char *data, size_t len) {
+        return findControlTail(data, 0, len);
+    }
+
+    static size_t findCharScalar(const char *data, size_t len, char c) {
+        return findCharTail(data, 0, len, c);
+    }
+
+    static size_t findControlTail(const char *data, size_t i, size_t len) {
+        for (; i < len; ++i) {
+            if (isControl(data[i]))
+                return i;
+        }
+        return len;
+    }
+
+    static size_t findCharTail(const char *data, size_t i, size_t len, char c) {
+        for (; i < len; ++i) {
+            if (data[i] == c)
+                return i;
+        }
+        return len;
+    }
+
+#ifdef WEBSERVER_SIMD_X86
+
+    __attribute__((target("sse4.2")))
+    static size_t findControlSse42(const char *data, size_t len) {
+        // 三个闭区间：[0x00, 0x08]、[0x0A, 0x1F]、[0x7F, 0x7F]
+        const __m128i ranges = _mm_setr_epi8(0x00, 0x08, 0x0a, 0x1f, 0x7f, 0x7f, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        size_t i = 0;
+        for (; i + 16 <= len; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            int index = _mm_cmpestri(ranges, 6, block, 16,
+                                     _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+            if (index != 16)
+                return i + index;
+        }
+        return findControlTail(data, i, len);
+    }
+
+    __attribute__((target("sse4.2")))
+    static size_t findCharSse42(const char *data, size_t len, char c) {
+        const __m128i needle = _mm_set1_epi8(c);
+        size_t i = 0;
+        for (; i + 16 <= len; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+            if (mask != 0)
+                return i + __builtin_ctz(mask);
+        }
+        return findCharTail(data, i, len, c);
+    }
+
+    __attribute__((target("avx2")))
+    static size_t findControlAvx2(const char *data, size_t len) {
+        const __m256i limit = _mm256_set1_epi8(0x1f);
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i del = _mm256_set1_epi8(0x7f);
+        size_t i = 0;
+        for (; i + 32 <= len; i += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            // 无符号比较 block <= 0x1F 等价于 min(block, 0x1F) == block
+            __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(block, limit), block);
+            control = _mm256_andnot_si256(_mm256_cmpeq_epi8(block, tab), control);
+            control = _mm256_or_si256(control, _mm256_cmpeq_epi8(block, del));
+            auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(control));
+            if (mask != 0)
+                return i + __builtin_ctz(mask);
+        }
+        return findControlTail(data, i, len);
+    }
+
+    __attribute__((target("avx2")))
+    static size_t findCharAvx2(const char *data, size_t len, char c) {
+        const __m256i needle = _mm256_set1_epi8(c);
+        size_t i = 0;
+        for (; i + 32 <= len; i += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+            if (mask != 0)
+                return i + __builtin_ctz(mask);
+        }
+        return findCharTail(data, i, len, c);
+    }
+
+#endif
+};
+
+#endif //WEBSERVER_SIMD_SCANNER_HPP
@@ -0,0 +1,140 @@
+#ifndef WEBSERVER_TASK_HPP
+#define WEBSERVER_TASK_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * 只能移动的任务（可调用对象的类型擦除容器）
+ *
+ * 与 std::function 不同，可以保存只能移动的可调用对象（如 std::packaged_task、捕获了 std::unique_ptr 的 lambda）；
+ * 不超过 INLINE_SIZE 字节且可以无异常移动的可调用对象直接存放在内部缓冲区中，不分配堆内存
+ */
+class Task {
+public:
+    static constexpr size_t INLINE_SIZE = 64;
+
+    Task() noexcept = default;
+
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F &&f) { // NOLINT(google-explicit-constructor)
+        using Callable = std::decay_t<F>;
+        if constexpr (fitsInline<Callable>()) {
+            new(storage_) Callable(std::forward<F>(f));
+            ops_ = &INLINE_OPS<Callable>;
+        } else {
+            *reinterpret_cast<Callable **>(storage_) = new Callable(std::forward<F>(f));
+            ops_ = &HEAP_OPS<Callable>;
+        }
+    }
+
+    Task(Task &&other) noexcept {
+        moveFrom(other);
+    }
+
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    Task(const Task &) = delete;
+
+    Task &operator=(const Task &) = delete;
+
+    ~Task() {
+        reset();
+    }
+
+    void operator()() {
+        ops_->invoke(storage_);
+    }
+
+    explicit operator bool() const noexcept {
+        return ops_ != nullptr;
+    }
+
+    /**
+     * 销毁保存的可调用对象，任务变为空
+     */
+    void reset() noexcept {
+        if (ops_ != nullptr) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    /**
+     * 可调用对象是否存放在内部缓冲区中
+     */
+    bool isInline() const noexcept {
+        return ops_ != nullptr && ops_->isInline;
+    }
+
+    template<typename Callable>
+    static constexpr bool fitsInline() {
+        return sizeof(Callable) <= INLINE_SIZE && alignof(Callable) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Callable>;
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void *storage);
+
+        // 把 from 中的可调用对象移动到 to 中，并销毁 from 中的对象
+        void (*relocate)(void *from, void *to) noexcept;
+
+        void (*destroy)(void *storage) noexcept;
+
+        bool isInline;
+    };
+
+    template<typename Callable>
+    static constexpr Ops INLINE_OPS = {
+            [](void *storage) {
+                (*std::launder(reinterpret_cast<Callable *>(storage)))();
+            },
+            [](void *from, void *to) noexcept {
+                auto *callable = std::launder(reinterpret_cast<Callable *>(from));
+                new(to) Callable(std::move(*callable));
+                callable->~Callable();
+            },
+            [](void *storage) noexcept {
+                std::launder(reinterpret_cast<Callable *>(storage))->~Callable();
+            },
+            true,
+    };
+
+    // 放不下的可调用对象分配在堆上，缓冲区中只保存指针，移动时只移动指针
+    template<typename Callable>
+    static constexpr Ops HEAP_OPS = {
+            [](void *storage) {
+                (**reinterpret_cast<Callable **>(storage))();
+            },
+            [](void *from, void *to) noexcept {
+                *reinterpret_cast<Callable **>(to) = *reinterpret_cast<Callable **>(from);
+            },
+            [](void *storage) noexcept {
+                delete *reinterpret_cast<Callable **>(storage);
+            },
+            false,
+    };
+
+    void moveFrom(Task &other) noexcept {
+        if (other.ops_ != nullptr) {
+            other.ops_->relocate(other.storage_, storage_);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[INLINE_SIZE];
+
+    const Ops *ops_ = nullptr;
+};
+
+#endif //WEBSERVER_TASK_HPP
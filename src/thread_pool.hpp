@@ -5,19 +5,159 @@
 #ifndef WEBSERVER_THREAD_POOL_HPP
 #define WEBSERVER_THREAD_POOL_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
+#include <src/task.hpp>
 #include <thread>
 #include <vector>
-#include <functional>
 
+/**
+ * Chase-Lev 工作窃取双端队列
+ *
+ * 只有所属线程可以在底部 push()/pop()，其他线程只能从顶部 steal()；
+ * 元素必须可平凡复制（线程池中存放任务指针），扩容后旧数组保留到析构，窃取者不会读到已释放的内存
+ */
+template<typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(int64_t capacity = 256) : top_(0), bottom_(0) {
+        arrays_.push_back(std::make_unique<Array>(capacity));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    void push(T item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        Array *array = array_.load(std::memory_order_relaxed);
+        if (bottom - top > array->capacity - 1) {
+            array = grow(array, top, bottom);
+        }
+        array->put(bottom, item);
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    std::optional<T> pop() {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Array *array = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) { // 队列为空
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        T item = array->get(bottom);
+        if (top == bottom) { // 只剩最后一个元素，与窃取者竞争
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            if (!won)
+                return std::nullopt;
+        }
+        return item;
+    }
+
+    std::optional<T> steal() {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+            return std::nullopt;
+
+        Array *array = array_.load(std::memory_order_acquire);
+        T item = array->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return std::nullopt;
+        return item;
+    }
+
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * 近似的元素个数（其他线程读取时只是一个快照）
+     */
+    size_t size() const {
+        int64_t size = bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed);
+        return size > 0 ? static_cast<size_t>(size) : 0;
+    }
+
+private:
+    struct Array {
+        explicit Array(int64_t capacity) : capacity(capacity), items(new std::atomic<T>[capacity]) {}
+
+        T get(int64_t index) const {
+            return items[index & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t index, T item) {
+            items[index & (capacity - 1)].store(item, std::memory_order_relaxed);
+        }
+
+        int64_t capacity; // 必须是 2 的幂
+
+        std::unique_ptr<std::atomic<T>[]> items;
+    };
+
+    Array *grow(Array *array, int64_t top, int64_t bottom) {
+        arrays_.push_back(std::make_unique<Array>(array->capacity * 2));
+        Array *bigger = arrays_.back().get();
+        for (int64_t i = top; i < bottom; ++i) {
+            bigger->put(i, array->get(i));
+        }
+        array_.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    alignas(64) std::atomic<int64_t> top_;
+
+    alignas(64) std::atomic<int64_t> bottom_;
+
+    std::atomic<Array *> array_;
+
+    std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+/**
+ * 工作窃取线程池
+ *
+ * 每个工作线程有自己的 Chase-Lev 队列，工作线程内部提交的任务进入自己的队列；
+ * 外部线程（如事件循环）提交的任务进入全局注入队列；空闲的工作线程先取注入队列，再随机窃取其他线程的任务，
+ * 确实没有任务时才休眠；
+ * 队列中存放的是循环使用的 Task 节点，稳定运行后提交小任务不分配堆内存；
+ * 注入队列可以设置容量，通过 tryPost() 提交时队列已满则拒绝，由调用方决定如何处理过载
+ */
 class ThreadPool {
 public:
-    explicit ThreadPool(int numOfThreads) : workerThreads_(std::vector<std::thread>(numOfThreads)),
-                                            isShutdown_(false) {
+    static constexpr size_t UNBOUNDED = SIZE_MAX;
+
+    /**
+     * @param capacity 注入队列的容量（只限制 tryPost()）
+     */
+    explicit ThreadPool(int numOfThreads, size_t capacity = UNBOUNDED)
+            : isShutdown_(false), sleepers_(0), signals_(0), capacity_(capacity) {
+        numOfThreads = std::max(numOfThreads, 1);
+        for (int i = 0; i < numOfThreads; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        // 所有队列创建完成后再启动线程，窃取时不会访问到未构造的队列
         for (int i = 0; i < numOfThreads; ++i) {
-            workerThreads_[i] = std::thread(run);
+            workers_[i]->thread = std::thread([this, i]() { run(i); });
         }
     }
 
@@ -27,6 +167,14 @@ public:
 
     ~ThreadPool() {
         shutdown();
+        for (Task *node: freeNodes_) {
+            delete node;
+        }
+        for (auto &worker: workers_) {
+            for (Task *node: worker->spareNodes) {
+                delete node;
+            }
+        }
     }
 
     /**
@@ -38,103 +186,248 @@ public:
      */
     template<typename F, typename ...Args>
     auto submit(F &&f, Args &&... args) -> std::future<decltype(f(args...))> {
-        std::function<decltype(f(args...))()> func = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
-
-        auto taskPointer = std::make_shared<std::packaged_task<decltype(f(args...))()>>(func);
-
-        std::function<void()> wrapFunc = [taskPointer]() {
-            (*taskPointer)();
-        };
+        std::packaged_task<decltype(f(args...))()> task(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
 
-        taskQueue_.enqueue(wrapFunc);
-
-        workerThreadsConditionVariable_.notify_one();
+        auto future = task.get_future();
+        schedule(Task(std::move(task)));
+        return future;
+    }
 
-        return taskPointer->get_future();
+    /**
+     * 提交不需要结果的任务
+     *
+     * 不创建 future 与共享状态，可调用对象足够小时整个提交过程不分配堆内存
+     *
+     * @param f 可调用对象（可以只能移动）
+     */
+    template<typename F>
+    void post(F &&f) {
+        schedule(Task(std::forward<F>(f)));
     }
 
-private:
     /**
-     * 工作任务队列（线程安全）
+     * 注入队列未满时提交不需要结果的任务
+     *
+     * 只限制外部线程提交的任务；工作线程内部提交的任务来自已经接受的任务，总是接受。
+     * 多个外部线程同时提交时，注入队列可能短暂地超过容量几个任务
+     *
+     * @return 是否已提交，拒绝时不会移动 f
      */
-    template<typename T>
-    class TaskQueue {
-    public:
-        TaskQueue() = default;
+    template<typename F>
+    bool tryPost(F &&f) {
+        if (currentPool() != this && injectionSize_.load(std::memory_order_relaxed) >= capacity_)
+            return false;
+        post(std::forward<F>(f));
+        return true;
+    }
 
-        TaskQueue(TaskQueue &) = default;
+    size_t size() const {
+        return workers_.size();
+    }
 
-        ~TaskQueue() = default;
+    size_t capacity() const {
+        return capacity_;
+    }
 
-        bool empty() {
-            const std::lock_guard<std::mutex> lockGuard(taskQueueMutex);
-            return taskQueue.empty();
+    /**
+     * 等待执行的任务数（注入队列与各工作线程队列之和，近似值）
+     */
+    size_t queueDepth() const {
+        size_t depth = injectionSize_.load(std::memory_order_relaxed);
+        for (auto &worker: workers_) {
+            depth += worker->deque.size();
         }
+        return depth;
+    }
 
-        size_t size() {
-            const std::lock_guard<std::mutex> lockGuard(taskQueueMutex);
-            return taskQueue.size();
-        }
+private:
+    static constexpr size_t MAX_SPARE_NODES = 64;
 
-        void enqueue(T &task) {
-            const std::lock_guard<std::mutex> lockGuard(taskQueueMutex);
-            taskQueue.push(task);
+    struct Worker {
+        Worker() {
+            spareNodes.reserve(MAX_SPARE_NODES);
         }
 
-        std::pair<T, bool> dequeue() {
-            const std::lock_guard<std::mutex> lockGuard(taskQueueMutex);
+        WorkStealingDeque<Task *> deque;
 
-            if (taskQueue.empty()) {
-                return std::pair(T(), false);
-            }
+        std::vector<Task *> spareNodes; // 只由所属线程访问的空闲节点
 
-            T task = taskQueue.front();
-            taskQueue.pop();
-            return std::pair(task, true);
-        }
-
-    private:
-        std::mutex taskQueueMutex;
-
-        std::queue<T> taskQueue;
+        std::thread thread;
     };
 
-    TaskQueue<std::function<void()>> taskQueue_;
+    // 当前线程所属的线程池与工作线程编号（非工作线程为 nullptr）
+    static ThreadPool *&currentPool() {
+        thread_local ThreadPool *pool = nullptr;
+        return pool;
+    }
 
-    std::vector<std::thread> workerThreads_;
+    static size_t &currentIndex() {
+        thread_local size_t index = 0;
+        return index;
+    }
 
-    std::mutex workerThreadsMutex_;
+    void schedule(Task &&task) {
+        if (currentPool() == this) {
+            Worker &worker = *workers_[currentIndex()];
+            Task *node = acquireNode(worker);
+            *node = std::move(task);
+            worker.deque.push(node);
+        } else {
+            const std::lock_guard<std::mutex> lockGuard(injectionMutex_);
+            Task *node;
+            if (freeNodes_.empty()) {
+                node = new Task();
+            } else {
+                node = freeNodes_.back();
+                freeNodes_.pop_back();
+            }
+            *node = std::move(task);
+            pushInjection(node);
+        }
+        notify();
+    }
 
-    std::condition_variable workerThreadsConditionVariable_;
+    /**
+     * 工作线程获取空闲节点：先用自己的，不够时从全局空闲链表中取一批
+     */
+    Task *acquireNode(Worker &worker) {
+        if (worker.spareNodes.empty()) {
+            const std::lock_guard<std::mutex> lockGuard(injectionMutex_);
+            size_t n = std::min(freeNodes_.size(), MAX_SPARE_NODES / 2);
+            worker.spareNodes.insert(worker.spareNodes.end(), freeNodes_.end() - n, freeNodes_.end());
+            freeNodes_.resize(freeNodes_.size() - n);
+        }
+        if (worker.spareNodes.empty())
+            return new Task();
+        Task *node = worker.spareNodes.back();
+        worker.spareNodes.pop_back();
+        return node;
+    }
+
+    /**
+     * 工作线程归还执行完的节点，攒满后把一半还给全局空闲链表
+     */
+    void releaseNode(Worker &worker, Task *node) {
+        if (worker.spareNodes.size() == MAX_SPARE_NODES) {
+            const std::lock_guard<std::mutex> lockGuard(injectionMutex_);
+            freeNodes_.insert(freeNodes_.end(), worker.spareNodes.end() - MAX_SPARE_NODES / 2,
+                              worker.spareNodes.end());
+            worker.spareNodes.resize(MAX_SPARE_NODES / 2);
+        }
+        worker.spareNodes.push_back(node);
+    }
 
-    bool isShutdown_;
+    // 注入队列是环形缓冲区，只在满时扩容，稳定运行后不分配内存（调用方持有 injectionMutex_）
+    void pushInjection(Task *node) {
+        size_t size = injectionSize_.load(std::memory_order_relaxed);
+        if (size == injection_.size()) {
+            std::vector<Task *> bigger(std::max<size_t>(injection_.size() * 2, 64));
+            for (size_t i = 0; i < size; ++i) {
+                bigger[i] = injection_[(injectionHead_ + i) & (injection_.size() - 1)];
+            }
+            injection_.swap(bigger);
+            injectionHead_ = 0;
+        }
+        injection_[(injectionHead_ + size) & (injection_.size() - 1)] = node;
+        injectionSize_.fetch_add(1, std::memory_order_seq_cst);
+    }
 
-    // 线程池中的每个线程都要执行的任务代码
-    std::function<void()> run = [&]() -> void {
-        std::function<void()> func;
+    /**
+     * 有线程休眠时才加锁唤醒，没有空闲线程时提交任务不需要碰条件变量
+     */
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) == 0)
+            return;
+        {
+            const std::lock_guard<std::mutex> lockGuard(sleepMutex_);
+            ++signals_;
+        }
+        sleepCondition_.notify_one();
+    }
 
-        bool dequeued;
+    Task *popInjection(Worker &worker) {
+        if (injectionSize_.load(std::memory_order_acquire) == 0)
+            return nullptr;
+        const std::lock_guard<std::mutex> lockGuard(injectionMutex_);
+        // 注入队列的节点来自全局空闲链表，顺便把手里的空闲节点还回去供外部线程复用
+        freeNodes_.insert(freeNodes_.end(), worker.spareNodes.begin(), worker.spareNodes.end());
+        worker.spareNodes.clear();
+        if (injectionSize_.load(std::memory_order_relaxed) == 0)
+            return nullptr;
+        Task *task = injection_[injectionHead_];
+        injectionHead_ = (injectionHead_ + 1) & (injection_.size() - 1);
+        injectionSize_.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
 
-        while (!isShutdown_) {
-            dequeued = false;
-            {
-                std::unique_lock<std::mutex> lock(workerThreadsMutex_);
+    Task *stealFromOthers(size_t self, uint64_t &seed) {
+        size_t n = workers_.size();
+        // xorshift 随机选择起点，避免所有空闲线程都去窃取同一个队列
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        size_t start = seed % n;
+        for (size_t i = 0; i < n; ++i) {
+            size_t victim = (start + i) % n;
+            if (victim == self)
+                continue;
+            if (auto task = workers_[victim]->deque.steal())
+                return *task;
+        }
+        return nullptr;
+    }
 
-                workerThreadsConditionVariable_.wait(lock, [this]() -> bool {
-                    return !taskQueue_.empty() || isShutdown_;
-                });
+    bool hasWork() const {
+        if (injectionSize_.load(std::memory_order_seq_cst) > 0)
+            return true;
+        return std::any_of(workers_.begin(), workers_.end(), [](const std::unique_ptr<Worker> &worker) {
+            return !worker->deque.empty();
+        });
+    }
 
-                if (auto result = taskQueue_.dequeue(); result.second) {
-                    func = result.first;
-                    dequeued = result.second;
+    // 线程池中的每个线程都要执行的任务代码
+    void run(size_t index) {
+        currentPool() = this;
+        currentIndex() = index;
+        uint64_t seed = index * 0x9e3779b97f4a7c15ULL + 1;
+        Worker &worker = *workers_[index];
+        WorkStealingDeque<Task *> &deque = worker.deque;
+
+        while (true) {
+            Task *task = nullptr;
+            // 先自旋若干轮，短暂的空闲不必进入休眠
+            for (int spin = 0; spin < 64 && task == nullptr; ++spin) {
+                if (auto local = deque.pop()) {
+                    task = *local;
+                } else if ((task = popInjection(worker)) == nullptr) {
+                    task = stealFromOthers(index, seed);
                 }
+                if (task == nullptr && spin >= 16)
+                    std::this_thread::yield();
             }
 
-            if (dequeued) {
-                func();
+            if (task != nullptr) {
+                (*task)();
+                task->reset();
+                releaseNode(worker, task);
+                continue;
             }
+
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            // 登记休眠后再检查一次，与 notify() 中先放任务后检查 sleepers_ 的顺序配合，不会丢失唤醒
+            sleepCondition_.wait(lock, [this]() {
+                return signals_ > 0 || isShutdown_ || hasWork();
+            });
+            if (signals_ > 0)
+                --signals_;
+            sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+
+            if (isShutdown_ && !hasWork())
+                return;
         }
-    };
+    }
 
     /**
      * 关闭线程池
@@ -142,23 +435,50 @@ private:
      * 在所有线程的任务完成后，关闭线程池
      */
     void shutdown() {
-        isShutdown_ = true;
-        workerThreadsConditionVariable_.notify_all();
-        std::for_each(workerThreads_.begin(), workerThreads_.end(), [](std::thread &thread) -> void {
-            if (thread.joinable()) {
-                thread.join();
+        {
+            const std::lock_guard<std::mutex> lockGuard(sleepMutex_);
+            isShutdown_ = true;
+        }
+        sleepCondition_.notify_all();
+        std::for_each(workers_.begin(), workers_.end(), [](std::unique_ptr<Worker> &worker) -> void {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
             }
         });
     }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::mutex injectionMutex_;
+
+    std::vector<Task *> injection_; // 容量是 2 的幂
+
+    size_t injectionHead_ = 0;
+
+    std::atomic<size_t> injectionSize_{0};
+
+    std::vector<Task *> freeNodes_; // 由 injectionMutex_ 保护
+
+    std::atomic<bool> isShutdown_;
+
+    std::mutex sleepMutex_;
+
+    std::condition_variable sleepCondition_;
+
+    std::atomic<size_t> sleepers_;
+
+    size_t signals_;
+
+    const size_t capacity_;
 };
 
 /**
- * 返回单例线程池实例
+ * 返回单例线程池实例（线程数与 CPU 核数相同，注入队列最多 65536 个任务）
  *
  * @return 单例线程池实例
  */
-ThreadPool& getThreadPool() {
-    static ThreadPool pool(10);
+ThreadPool &getThreadPool() {
+    static ThreadPool pool(static_cast<int>(std::thread::hardware_concurrency()), 64 * 1024);
     return pool;
 }
 
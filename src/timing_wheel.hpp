@@ -0,0 +1,279 @@
+#ifndef WEBSERVER_TIMING_WHEEL_HPP
+#define WEBSERVER_TIMING_WHEEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+class TimingWheel;
+
+/**
+ * 时间轮中双向循环链表的链接
+ */
+struct TimerLink {
+    TimerLink *prev = nullptr;
+
+    TimerLink *next = nullptr;
+};
+
+/**
+ * 时间轮上的定时器（侵入式：嵌入到拥有它的对象中，布置、重新布置与取消都是 O(1) 且不分配内存）
+ *
+ * 到期时在驱动时间轮的线程中调用回调；析构时自动取消
+ */
+class TimerNode : private TimerLink {
+public:
+    explicit TimerNode(std::function<void()> callback = nullptr) : callback_(std::move(callback)) {}
+
+    TimerNode(const TimerNode &) = delete;
+
+    TimerNode &operator=(const TimerNode &) = delete;
+
+    ~TimerNode() {
+        cancel();
+    }
+
+    void setCallback(std::function<void()> callback) {
+        callback_ = std::move(callback);
+    }
+
+    bool isArmed() const {
+        return wheel_ != nullptr;
+    }
+
+    /**
+     * 取消，未布置时什么也不做
+     */
+    inline void cancel();
+
+private:
+    friend class TimingWheel;
+
+    TimingWheel *wheel_ = nullptr;
+
+    uint64_t expiry_ = 0; // 到期的刻度
+
+    std::function<void()> callback_;
+};
+
+/**
+ * 分层时间轮
+ *
+ * 时间按 tick 划分为刻度，共 LEVELS 层，每层 SLOTS 个槽位，第 n 层的一个槽位覆盖 SLOTS^n 个刻度；
+ * 定时器按距到期的刻度数放入能容纳它的最低一层，布置、重新布置与取消只是链表操作。
+ * 每前进一个刻度处理第 0 层的一个槽位，第 0 层转完一圈时把上一层的下一个槽位中的定时器重新分配到下层（逐层进位）。
+ * 到期时间向上取整到刻度，定时器不会早于到期时间触发，最多晚一个刻度
+ *
+ * 适合大量经常被推迟、很少真正到期的超时（如每个连接的空闲超时），不是线程安全的
+ */
+class TimingWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr unsigned LEVEL_BITS = 6;
+
+    static constexpr size_t SLOTS = size_t(1) << LEVEL_BITS;
+
+    static constexpr size_t LEVELS = 4;
+
+    static constexpr uint64_t MAX_TICKS = uint64_t(1) << (LEVEL_BITS * LEVELS); // 更远的到期时间截断到这里
+
+    /**
+     * @param tick 刻度的长度
+     * @param start 第 0 个刻度的时间
+     */
+    explicit TimingWheel(Clock::duration tick = std::chrono::milliseconds(100), Clock::time_point start = Clock::now())
+            : tick_(tick), start_(start) {
+        for (auto &level: slots_) {
+            for (TimerLink &slot: level) {
+                slot.prev = slot.next = &slot;
+            }
+        }
+    }
+
+    TimingWheel(const TimingWheel &) = delete;
+
+    TimingWheel &operator=(const TimingWheel &) = delete;
+
+    ~TimingWheel() {
+        for (auto &level: slots_) {
+            for (TimerLink &slot: level) {
+                while (slot.next != &slot) {
+                    static_cast<TimerNode *>(slot.next)->cancel();
+                }
+            }
+        }
+    }
+
+    /**
+     * 布置定时器，已布置时改为新的到期时间
+     */
+    void arm(TimerNode &node, Clock::time_point deadline) {
+        auto elapsed = deadline - start_;
+        // 向上取整，且至少是下一个刻度
+        uint64_t expiry = elapsed <= Clock::duration::zero() ? 0 : (elapsed + tick_ - Clock::duration(1)) / tick_;
+        expiry = std::clamp(expiry, current_ + 1, current_ + MAX_TICKS - 1);
+        node.cancel();
+        node.wheel_ = this;
+        node.expiry_ = expiry;
+        ++size_;
+        place(node);
+    }
+
+    void arm(TimerNode &node, Clock::duration delay) {
+        arm(node, Clock::now() + delay);
+    }
+
+    /**
+     * 前进到 now，依次调用到期的定时器的回调（回调中可以布置或取消定时器，也可以销毁定时器所在的对象）
+     *
+     * @return 到期的定时器个数
+     */
+    size_t advance(Clock::time_point now = Clock::now()) {
+        auto elapsed = now - start_;
+        uint64_t target = elapsed <= Clock::duration::zero() ? 0 : static_cast<uint64_t>(elapsed / tick_);
+        size_t fired = 0;
+        while (current_ < target) {
+            if (size_ == 0) { // 没有定时器时直接跳到目标刻度
+                current_ = target;
+                break;
+            }
+            ++current_;
+            cascade();
+            fired += expire(slots_[0][current_ & (SLOTS - 1)]);
+        }
+        return fired;
+    }
+
+    /**
+     * 距下一个需要处理的刻度的毫秒数（向上取整），没有定时器时为 -1，可直接作为 epoll_wait 等的超时参数
+     *
+     * 只查看第 0 层，上层的定时器在下一次进位时才需要处理
+     */
+    int nextTimeoutMs(Clock::time_point now = Clock::now()) const {
+        if (size_ == 0)
+            return -1;
+        uint64_t next = current_ + 1;
+        while ((next & (SLOTS - 1)) != 0 && isEmpty(slots_[0][next & (SLOTS - 1)])) {
+            ++next;
+        }
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(start_ + tick_ * static_cast<int64_t>(next) - now);
+        return static_cast<int>(std::max<int64_t>(remaining.count(), 0));
+    }
+
+    /**
+     * 已布置的定时器个数
+     */
+    size_t size() const {
+        return size_;
+    }
+
+    Clock::duration tick() const {
+        return tick_;
+    }
+
+private:
+    friend class TimerNode;
+
+    static bool isEmpty(const TimerLink &slot) {
+        return slot.next == &slot;
+    }
+
+    static void link(TimerLink &slot, TimerLink &node) {
+        node.prev = slot.prev;
+        node.next = &slot;
+        slot.prev->next = &node;
+        slot.prev = &node;
+    }
+
+    static void unlink(TimerLink &node) {
+        node.prev->next = node.next;
+        node.next->prev = node.prev;
+        node.prev = node.next = nullptr;
+    }
+
+    /**
+     * 放入能容纳剩余刻度数的最低一层（剩余为 0 时放入当前刻度的槽位，由调用方随即处理）
+     */
+    void place(TimerNode &node) {
+        uint64_t remaining = node.expiry_ - current_;
+        size_t level = 0;
+        while (level + 1 < LEVELS && remaining >= (uint64_t(1) << (LEVEL_BITS * (level + 1)))) {
+            ++level;
+        }
+        link(slots_[level][(node.expiry_ >> (LEVEL_BITS * level)) & (SLOTS - 1)], node);
+    }
+
+    /**
+     * 下层转完一圈时，把上层当前槽位中的定时器重新分配到下层
+     */
+    void cascade() {
+        for (size_t level = 1; level < LEVELS; ++level) {
+            if ((current_ & ((uint64_t(1) << (LEVEL_BITS * level)) - 1)) != 0)
+                break;
+            TimerLink &slot = slots_[level][(current_ >> (LEVEL_BITS * level)) & (SLOTS - 1)];
+            TimerLink pending;
+            take(slot, pending);
+            while (!isEmpty(pending)) {
+                auto &node = static_cast<TimerNode &>(*pending.next);
+                unlink(node);
+                place(node);
+            }
+        }
+    }
+
+    size_t expire(TimerLink &slot) {
+        TimerLink expired;
+        take(slot, expired);
+        size_t fired = 0;
+        while (!isEmpty(expired)) {
+            auto &node = static_cast<TimerNode &>(*expired.next);
+            node.cancel();
+            // 回调可能销毁定时器所在的对象，先复制出来
+            std::function<void()> callback = node.callback_;
+            ++fired;
+            if (callback)
+                callback();
+        }
+        return fired;
+    }
+
+    /**
+     * 把 slot 中的全部节点移到空链表 to 中
+     */
+    static void take(TimerLink &slot, TimerLink &to) {
+        if (isEmpty(slot)) {
+            to.prev = to.next = &to;
+            return;
+        }
+        to.next = slot.next;
+        to.prev = slot.prev;
+        to.next->prev = &to;
+        to.prev->next = &to;
+        slot.prev = slot.next = &slot;
+    }
+
+    Clock::duration tick_;
+
+    Clock::time_point start_;
+
+    uint64_t current_ = 0; // 已处理到的刻度
+
+    size_t size_ = 0;
+
+    std::array<std::array<TimerLink, SLOTS>, LEVELS> slots_;
+};
+
+void TimerNode::cancel() {
+    if (!wheel_)
+        return;
+    TimingWheel::unlink(*this);
+    --wheel_->size_;
+    wheel_ = nullptr;
+}
+
+#endif //WEBSERVER_TIMING_WHEEL_HPP
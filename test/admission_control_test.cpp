@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <src/admission_control.hpp>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(AdmissionControlTest, Unlimited) {
+    AdmissionController controller;
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_TRUE(controller.tryAcquire());
+    }
+    ASSERT_EQ(10000, controller.inFlight());
+    ASSERT_EQ(0, controller.rejected());
+}
+
+TEST(AdmissionControlTest, FixedLimit) {
+    AdmissionController controller(4);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(controller.tryAcquire());
+    }
+    ASSERT_FALSE(controller.tryAcquire());
+    ASSERT_EQ(1, controller.rejected());
+
+    controller.release(1s); // 没有目标排队时间时上限不变
+    ASSERT_EQ(4, controller.limit());
+    ASSERT_TRUE(controller.tryAcquire());
+    ASSERT_FALSE(controller.tryAcquire());
+}
+
+TEST(AdmissionControlTest, DecreaseOnQueueing) {
+    AdmissionController controller(100, 2ms, 10);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(controller.tryAcquire());
+    }
+
+    // 同一阵拥塞中的多个慢请求只降低一次
+    controller.release(5ms);
+    controller.release(5ms);
+    controller.release(5ms);
+    ASSERT_EQ(90, controller.limit());
+    ASSERT_EQ(97, controller.inFlight());
+    ASSERT_FALSE(controller.tryAcquire()); // 仍在处理的请求超过了新的上限
+
+    for (int i = 0; i < 40; ++i) {
+        std::this_thread::sleep_for(3ms);
+        controller.release(5ms);
+    }
+    ASSERT_EQ(10, controller.limit()); // 不低于最小值
+    ASSERT_EQ(57, controller.inFlight());
+}
+
+TEST(AdmissionControlTest, IncreaseWhenHealthy) {
+    AdmissionController controller(20, 2ms, 1);
+    controller.tryAcquire();
+    controller.release(5ms);
+    ASSERT_EQ(18, controller.limit());
+
+    // 上限没有被用到时不增加
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(controller.tryAcquire());
+        controller.release(0ms);
+    }
+    ASSERT_EQ(18, controller.limit());
+
+    // 满负荷且排队时间正常：每处理约一个上限的请求加 1，直到最大值
+    for (int round = 0; round < 100; ++round) {
+        while (controller.tryAcquire()) {
+        }
+        while (controller.inFlight() > 0) {
+            controller.release(0ms);
+        }
+    }
+    ASSERT_EQ(20, controller.limit());
+}
@@ -0,0 +1,76 @@
+#ifndef WEBSERVER_ALLOCATION_COUNTER_HPP
+#define WEBSERVER_ALLOCATION_COUNTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/**
+ * 堆分配计数，用于验证稳定运行时不分配堆内存
+ *
+ * 替换了全局的 operator new / delete，每个测试程序只能有一个源文件包含本文件；
+ * 从构造开始计数，被 Uncounted 标记的线程的分配不计入
+ */
+class AllocationCounter {
+public:
+    /**
+     * 在作用域内不计入当前线程的分配（如服务器测试中作为客户端的测试线程）
+     */
+    class Uncounted {
+    public:
+        Uncounted() : previous_(isCounted_) {
+            isCounted_ = false;
+        }
+
+        Uncounted(const Uncounted &) = delete;
+
+        Uncounted &operator=(const Uncounted &) = delete;
+
+        ~Uncounted() {
+            isCounted_ = previous_;
+        }
+
+    private:
+        bool previous_;
+    };
+
+    AllocationCounter() : start_(total_.load(std::memory_order_relaxed)) {}
+
+    /**
+     * 构造以来的分配次数
+     */
+    size_t count() const {
+        return total_.load(std::memory_order_relaxed) - start_;
+    }
+
+    static void record() {
+        if (isCounted_)
+            total_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    static inline std::atomic<size_t> total_{0};
+
+    static inline thread_local bool isCounted_ = true;
+
+    size_t start_;
+};
+
+void *operator new(size_t size) {
+    AllocationCounter::record();
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+// 不内联：否则 GCC 看到 operator new 的结果被 free() 释放，误报 -Wmismatched-new-delete
+[[gnu::noinline]] void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+#endif //WEBSERVER_ALLOCATION_COUNTER_HPP
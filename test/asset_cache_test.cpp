@@ -0,0 +1,278 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <src/asset_cache.hpp>
+#include <thread>
+#include <vector>
+
+class AssetCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char pattern[] = "/tmp/asset_cache_test_XXXXXX";
+        root = std::string(mkdtemp(pattern)) + "/";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(root);
+    }
+
+    void write(const std::string &path, const std::string &content) const {
+        std::ofstream(root + path, std::ios::out | std::ios::trunc) << content;
+    }
+
+    std::string root;
+};
+
+TEST_F(AssetCacheTest, HitWithoutReload) {
+    write("index.html", "<html></html>");
+    AssetCache cache(root);
+
+    auto first = cache.get("index.html");
+    ASSERT_NE(nullptr, first);
+    ASSERT_EQ("<html></html>", first->body);
+    ASSERT_EQ("Content-Type: text/html; charset=utf-8\r\nContent-Length: 13\r\n", first->headerFields);
+
+    auto second = cache.get("index.html");
+    ASSERT_EQ(first.get(), second.get()); // 命中时返回同一份数据
+    ASSERT_EQ(1, cache.hits());
+    ASSERT_EQ(1, cache.misses());
+
+    ASSERT_EQ(nullptr, cache.get("missing.html"));
+    ASSERT_EQ(nullptr, cache.get("")); // 目录不是资源
+}
+
+TEST_F(AssetCacheTest, InvalidateOnModification) {
+    write("style.css", "a{}");
+    AssetCache cache(root, 1024 * 1024, std::chrono::milliseconds(0));
+    ASSERT_EQ("a{}", cache.get("style.css")->body);
+
+    // 修改时间精度可能较粗，等待后再修改
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    write("style.css", "body{}");
+    ASSERT_EQ("body{}", cache.get("style.css")->body);
+
+    std::remove((root + "style.css").c_str());
+    ASSERT_EQ(nullptr, cache.get("style.css"));
+}
+
+TEST_F(AssetCacheTest, EvictWithinBudget) {
+    const size_t capacity = 16 * 4096; // 每个分片 4096 字节
+    AssetCache cache(root, capacity);
+    for (int i = 0; i < 200; ++i) {
+        write(std::to_string(i) + ".txt", std::string(1000, 'x'));
+        ASSERT_NE(nullptr, cache.get(std::to_string(i) + ".txt"));
+    }
+    ASSERT_LE(cache.usage(), capacity);
+    ASSERT_GT(cache.usage(), 0);
+
+    // 超过分片容量的资源仍可获取，只是不缓存
+    write("large.bin", std::string(8192, 'y'));
+    ASSERT_EQ(8192, cache.get("large.bin")->body.size());
+}
+
+TEST_F(AssetCacheTest, FileBackedLargeAsset) {
+    write("background.jpg", std::string(4096, 'z'));
+    write("icon.png", std::string(100, 'i'));
+    AssetCache cache(root, 1024 * 1024, std::chrono::seconds(1), 1024);
+
+    auto large = cache.get("background.jpg");
+    ASSERT_TRUE(large->isFileBacked());
+    ASSERT_TRUE(large->body.empty());
+    ASSERT_EQ(4096, large->size);
+    ASSERT_NE(std::string::npos, large->headerFields.find("Content-Length: 4096\r\n"));
+
+    char buf[16];
+    ASSERT_EQ(16, pread(large->file->fd(), buf, sizeof(buf), 4000));
+    ASSERT_EQ(std::string(16, 'z'), std::string(buf, sizeof(buf)));
+
+    auto small = cache.get("icon.png");
+    ASSERT_FALSE(small->isFileBacked());
+    ASSERT_EQ(100, small->size);
+}
+
+TEST_F(AssetCacheTest, PrecompressedSiblings) {
+    write("style.css", "body{}");
+    write("style.css.gz", "gzip bytes");
+    write("style.css.br", "br bytes");
+    AssetCache cache(root);
+
+    auto brotli = cache.get("style.css", AcceptEncoding("gzip, deflate, br"));
+    ASSERT_EQ(ContentEncoding::BROTLI, brotli->encoding);
+    ASSERT_EQ("br bytes", brotli->body);
+    ASSERT_EQ("Content-Type: text/css; charset=utf-8\r\nContent-Length: 8\r\nContent-Encoding: br\r\n"
+              "Vary: Accept-Encoding\r\n", brotli->headerFields);
+
+    ASSERT_EQ("gzip bytes", cache.get("style.css", AcceptEncoding("gzip"))->body);
+    ASSERT_EQ("gzip bytes", cache.get("style.css", AcceptEncoding("br;q=0.5, gzip"))->body);
+    ASSERT_EQ("br bytes", cache.get("style.css", AcceptEncoding("*"))->body);
+
+    // 不接受压缩时返回原始内容，同样带 Vary
+    auto identity = cache.get("style.css");
+    ASSERT_EQ("body{}", identity->body);
+    ASSERT_EQ("Content-Type: text/css; charset=utf-8\r\nContent-Length: 6\r\nVary: Accept-Encoding\r\n",
+              identity->headerFields);
+    ASSERT_EQ("body{}", cache.get("style.css", AcceptEncoding("gzip;q=0, br;q=0"))->body);
+    ASSERT_EQ(1, cache.misses()); // 各版本在同一个缓存项中
+}
+
+TEST_F(AssetCacheTest, StaleSiblingIgnored) {
+    write("news1.html.gz", "old gzip bytes");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    write("news1.html", "<html>new</html>");
+    AssetCache cache(root);
+
+    auto asset = cache.get("news1.html", AcceptEncoding("gzip"));
+    ASSERT_EQ(ContentEncoding::IDENTITY, asset->encoding);
+    ASSERT_EQ("<html>new</html>", asset->body);
+    ASSERT_EQ(std::string::npos, asset->headerFields.find("Vary"));
+}
+
+TEST_F(AssetCacheTest, RegeneratedSiblingReloaded) {
+    write("style.css", "body{}");
+    write("style.css.gz", "gzip bytes");
+    AssetCache cache(root, 1024 * 1024, std::chrono::milliseconds(0));
+    auto before = cache.get("style.css", AcceptEncoding("gzip"));
+    ASSERT_EQ("gzip bytes", before->body);
+
+    // 只重新生成预压缩文件（大小不变），原文件未变
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    write("style.css.gz", "gzip BYTES");
+    auto after = cache.get("style.css", AcceptEncoding("gzip"));
+    ASSERT_EQ("gzip BYTES", after->body);
+    ASSERT_NE(before->etag, after->etag);
+    ASSERT_EQ(before->modifiedTime.tv_sec, after->modifiedTime.tv_sec); // Last-Modified 仍是原文件的
+
+    // 新增与删除预压缩文件同样重新加载
+    write("style.css.br", "br bytes");
+    ASSERT_EQ("br bytes", cache.get("style.css", AcceptEncoding("br"))->body);
+    std::remove((root + "style.css.gz").c_str());
+    ASSERT_EQ("body{}", cache.get("style.css", AcceptEncoding("gzip"))->body);
+}
+
+TEST_F(AssetCacheTest, CompressInBackground) {
+    if (!ContentCoding::canCompress(ContentEncoding::GZIP))
+        GTEST_SKIP() << "Built without zlib";
+
+    std::string page;
+    for (int i = 0; i < 200; ++i) {
+        page += "<p>news item " + std::to_string(i) + "</p>\n";
+    }
+    write("board.html", page);
+    write("index.html", "<html></html>");
+    write("logo.png", page);
+    std::vector<std::function<void()>> tasks;
+    AssetCache cache(root, 1024 * 1024, std::chrono::seconds(1), 256 * 1024,
+                     [&tasks](std::function<void()> task) { tasks.push_back(std::move(task)); });
+
+    // 压缩完成之前返回原始内容
+    auto first = cache.get("board.html", AcceptEncoding("gzip"));
+    ASSERT_EQ(ContentEncoding::IDENTITY, first->encoding);
+    ASSERT_NE(std::string::npos, first->headerFields.find("Vary: Accept-Encoding\r\n"));
+    ASSERT_EQ(1, tasks.size());
+
+    // 太小或不是文本的资源不压缩
+    cache.get("index.html", AcceptEncoding("gzip"));
+    cache.get("logo.png", AcceptEncoding("gzip"));
+    ASSERT_EQ(1, tasks.size());
+
+    size_t before = cache.usage();
+    for (auto &task: tasks) {
+        task();
+    }
+    auto compressed = cache.get("board.html", AcceptEncoding("gzip"));
+    ASSERT_EQ(ContentEncoding::GZIP, compressed->encoding);
+    ASSERT_LT(compressed->size, first->size);
+    ASSERT_EQ(0, compressed->body.rfind("\x1f\x8b", 0)); // gzip 的魔数
+    ASSERT_NE(std::string::npos, compressed->headerFields.find("Content-Encoding: gzip\r\n"));
+    ASSERT_GT(cache.usage(), before);
+    ASSERT_EQ(first.get(), cache.get("board.html").get());
+}
+
+TEST_F(AssetCacheTest, ValidatorsPerVersion) {
+    write("style.css", "body{}");
+    write("style.css.br", "br bytes");
+    AssetCache cache(root, 1024 * 1024, std::chrono::milliseconds(0));
+
+    auto identity = cache.get("style.css");
+    auto brotli = cache.get("style.css", AcceptEncoding("br"));
+    struct stat st{};
+    ASSERT_EQ(0, stat((root + "style.css").c_str(), &st));
+    ASSERT_EQ('"', identity->etag.front());
+    ASSERT_EQ('"', identity->etag.back());
+    ASSERT_NE(identity->etag, brotli->etag); // 不同编码的版本是不同的表示
+    ASSERT_EQ("ETag: " + identity->etag + "\r\nLast-Modified: " + std::string(CachedClock::httpDate(st.st_mtim.tv_sec)) +
+              "\r\nAccept-Ranges: bytes\r\n", identity->validatorFields);
+    ASSERT_TRUE(identity->isNegotiable);
+    ASSERT_EQ(identity->etag, cache.get("style.css")->etag);
+
+    // 修改后生成新的实体标签
+    std::string etag = identity->etag;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    write("style.css", "body{ }");
+    ASSERT_NE(etag, cache.get("style.css")->etag);
+}
+
+TEST_F(AssetCacheTest, NegativeLookups) {
+    AssetCache cache(root, 1024 * 1024, std::chrono::milliseconds(50));
+    ASSERT_EQ(nullptr, cache.get("robots.txt"));
+    ASSERT_EQ(1, cache.misses());
+    ASSERT_EQ(0, cache.negativeHits());
+
+    // 记录过期之前不再访问文件系统，期间出现的文件也视为不存在
+    write("robots.txt", "User-agent: *");
+    ASSERT_EQ(nullptr, cache.get("robots.txt"));
+    ASSERT_EQ(1, cache.misses());
+    ASSERT_EQ(1, cache.negativeHits());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    ASSERT_NE(nullptr, cache.get("robots.txt"));
+    ASSERT_EQ(2, cache.misses());
+
+    // 大量不同的路径只互相替换记录，已缓存的资源不受影响
+    for (size_t i = 0; i < AssetCache::MAX_ABSENT_PER_SHARD * 32; ++i) {
+        ASSERT_EQ(nullptr, cache.get("missing/" + std::to_string(i)));
+    }
+    ASSERT_NE(nullptr, cache.get("robots.txt"));
+}
+
+TEST(AbsentPathsTest, OldestRecordIsEvicted) {
+    AbsentPaths absent(4);
+    auto start = std::chrono::steady_clock::now();
+    auto at = [start](int ms) { return start + std::chrono::milliseconds(ms); };
+    // 同一分片的哈希低位相同
+    auto hash = [](uint64_t i) { return i * 16 + 3; };
+    for (uint64_t i = 0; i < 4; ++i) {
+        absent.insert(hash(i), at(static_cast<int>(i)));
+    }
+    ASSERT_EQ(4, absent.size());
+
+    // 重新确认的记录移到最新的位置，之后淘汰的是最早确认的一条
+    absent.insert(hash(0), at(10));
+    absent.insert(hash(4), at(11));
+    ASSERT_EQ(4, absent.size());
+    ASSERT_EQ(nullptr, absent.find(hash(1)));
+    ASSERT_EQ(at(10), *absent.find(hash(0)));
+    ASSERT_EQ(at(11), *absent.find(hash(4)));
+
+    // 删除后探测链上的其他记录仍能找到
+    absent.erase(hash(2));
+    ASSERT_EQ(nullptr, absent.find(hash(2)));
+    ASSERT_EQ(at(3), *absent.find(hash(3)));
+    ASSERT_EQ(3, absent.size());
+
+    // 大量不同的哈希只互相替换，留下的是最近的 capacity 条
+    for (uint64_t i = 100; i < 100 + 1000; ++i) {
+        absent.insert(hash(i), at(static_cast<int>(i)));
+    }
+    ASSERT_EQ(absent.capacity(), absent.size());
+    for (uint64_t i = 100; i < 100 + 1000; ++i) {
+        ASSERT_EQ(i >= 1096, absent.find(hash(i)) != nullptr) << i;
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <src/asset_pack.hpp>
+#include <thread>
+
+class AssetPackTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char pattern[] = "/tmp/asset_pack_test_XXXXXX";
+        root = std::string(mkdtemp(pattern)) + "/";
+        pack = root.substr(0, root.size() - 1) + ".pack";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(root);
+        std::filesystem::remove(pack);
+    }
+
+    void write(const std::string &path, const std::string &content) const {
+        std::filesystem::create_directories(std::filesystem::path(root + path).parent_path());
+        std::ofstream(root + path, std::ios::out | std::ios::trunc) << content;
+    }
+
+    std::string root;
+
+    std::string pack;
+};
+
+TEST_F(AssetPackTest, LookupMatchesAssetCache) {
+    write("index.html", "<html></html>");
+    write("css/style.css", "body{}");
+    write("css/style.css.br", "br bytes");
+    write("images/empty.png", "");
+    ASSERT_TRUE(AssetPack::build(root, pack, false));
+    auto assets = AssetPack::open(pack);
+    ASSERT_NE(nullptr, assets);
+    ASSERT_EQ(3, assets->size());
+
+    // 与资源缓存生成相同的响应头
+    AssetCache cache(root);
+    for (std::string path: {"index.html", "css/style.css", "images/empty.png"}) {
+        for (const char *accept: {"", "gzip, br"}) {
+            auto packed = assets->get(path, AcceptEncoding(accept));
+            auto cached = cache.get(path, AcceptEncoding(accept));
+            ASSERT_NE(nullptr, packed) << path;
+            ASSERT_EQ(cached->content(), packed->content());
+            ASSERT_EQ(cached->headerFields, packed->headerFields);
+            ASSERT_EQ(cached->etag, packed->etag);
+            ASSERT_EQ(cached->validatorFields, packed->validatorFields);
+            ASSERT_EQ(cached->encoding, packed->encoding);
+            ASSERT_FALSE(packed->isFileBacked());
+        }
+    }
+    ASSERT_EQ(nullptr, assets->get("css/style.css.br")); // 压缩版本不单独成为资源
+    ASSERT_EQ(nullptr, assets->get("missing.html"));
+    ASSERT_EQ(nullptr, assets->get(""));
+
+    // 文件内容按页对齐，直接引用映射
+    auto index = assets->get("index.html");
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(index->content().data()) % AssetPack::PAGE_SIZE);
+    ASSERT_TRUE(index->body.empty());
+}
+
+TEST_F(AssetPackTest, ManyAssets) {
+    for (int i = 0; i < 1000; ++i) {
+        write("dir" + std::to_string(i % 7) + "/page" + std::to_string(i) + ".html", std::to_string(i));
+    }
+    ASSERT_TRUE(AssetPack::build(root, pack));
+    auto assets = AssetPack::open(pack);
+    ASSERT_NE(nullptr, assets);
+    ASSERT_EQ(1000, assets->size());
+    for (int i = 0; i < 1000; ++i) {
+        auto asset = assets->get("dir" + std::to_string(i % 7) + "/page" + std::to_string(i) + ".html");
+        ASSERT_NE(nullptr, asset) << i;
+        ASSERT_EQ(std::to_string(i), asset->content());
+    }
+    ASSERT_EQ(nullptr, assets->get("dir0/page1.html"));
+}
+
+TEST_F(AssetPackTest, CompressWhilePacking) {
+    std::string page;
+    for (int i = 0; i < 100; ++i) {
+        page += "<p>news item " + std::to_string(i) + "</p>\n";
+    }
+    write("news.html", page);
+    ASSERT_TRUE(AssetPack::build(root, pack));
+    auto assets = AssetPack::open(pack);
+    auto identity = assets->get("news.html");
+    ASSERT_EQ(page, identity->content());
+    if (!ContentCoding::canCompress(ContentEncoding::GZIP))
+        GTEST_SKIP() << "built without zlib";
+    ASSERT_NE(std::string::npos, identity->headerFields.find("Vary: Accept-Encoding\r\n"));
+    auto gzip = assets->get("news.html", AcceptEncoding("gzip"));
+    ASSERT_EQ(ContentEncoding::GZIP, gzip->encoding);
+    ASSERT_LT(gzip->size, page.size());
+}
+
+TEST_F(AssetPackTest, RejectInvalidFiles) {
+    ASSERT_EQ(nullptr, AssetPack::open(pack)); // 不存在
+    write("index.html", "<html></html>");
+    ASSERT_TRUE(AssetPack::build(root, pack));
+
+    // 截断
+    std::filesystem::resize_file(pack, std::filesystem::file_size(pack) - 1);
+    ASSERT_EQ(nullptr, AssetPack::open(pack));
+    // 魔数不符
+    std::ofstream(pack, std::ios::trunc) << std::string(4096, 'x');
+    ASSERT_EQ(nullptr, AssetPack::open(pack));
+    ASSERT_FALSE(AssetPack::build(root + "missing/", pack));
+}
+
+TEST_F(AssetPackTest, RebuildKeepsOldMappingValid) {
+    write("index.html", "old");
+    ASSERT_TRUE(AssetPack::build(root, pack));
+    auto old = AssetPack::open(pack);
+    auto asset = old->get("index.html");
+
+    write("index.html", "new");
+    ASSERT_TRUE(AssetPack::build(root, pack));
+    ASSERT_EQ("new", AssetPack::open(pack)->get("index.html")->content());
+    old.reset();
+    ASSERT_EQ("old", asset->content()); // 资源持有映射
+}
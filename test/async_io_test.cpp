@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <src/async_io.hpp>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+
+class AsyncIoTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+    }
+
+    void TearDown() override {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    /**
+     * 以边缘触发注册文件描述符，就绪事件交给对应的 AsyncFd
+     */
+    void watch(AsyncFd &io) {
+        ASSERT_TRUE(loop.add(io.fd(), EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET));
+        watched[io.fd()] = &io;
+    }
+
+    void run() {
+        loop.loop([this](int fd, uint32_t events) { watched.at(fd)->notify(events); });
+    }
+
+    EventLoop loop;
+
+    int fds[2]{};
+
+    std::unordered_map<int, AsyncFd *> watched;
+};
+
+TEST_F(AsyncIoTest, ReadWaitsForData) {
+    AsyncFd io(fds[0]);
+    watch(io);
+
+    std::string received;
+    auto reader = [&]() -> Coroutine<> {
+        char buffer[64];
+        ssize_t len;
+        while ((len = co_await io.read(buffer, sizeof(buffer))) > 0) {
+            received.append(buffer, len);
+        }
+        loop.quit();
+    };
+    Coroutine<> coroutine = reader();
+    coroutine.start();
+    ASSERT_FALSE(coroutine.done()); // 没有数据时挂起
+
+    loop.runAfter(std::chrono::milliseconds(5), [this]() { ASSERT_EQ(5, write(fds[1], "hello", 5)); });
+    loop.runAfter(std::chrono::milliseconds(10), [this]() {
+        ASSERT_EQ(6, write(fds[1], " world", 6));
+        shutdown(fds[1], SHUT_WR);
+    });
+    run();
+    ASSERT_TRUE(coroutine.done());
+    ASSERT_EQ("hello world", received);
+}
+
+TEST_F(AsyncIoTest, WriteWaitsForBufferSpace) {
+    AsyncFd io(fds[0]);
+    watch(io);
+
+    // 写入远大于 socket 缓冲区的数据，对端每毫秒读取一次
+    std::string data(4 * 1024 * 1024, 'x');
+    auto writer = [&]() -> Coroutine<size_t> {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            iovec iov{data.data() + sent, data.size() - sent};
+            msghdr message{};
+            message.msg_iov = &iov;
+            message.msg_iovlen = 1;
+            ssize_t len = co_await io.write(&message);
+            if (len < 0)
+                break;
+            sent += len;
+        }
+        co_return sent;
+    };
+    Coroutine<size_t> coroutine = writer();
+    coroutine.start();
+    ASSERT_FALSE(coroutine.done());
+
+    size_t received = 0;
+    std::function<void()> drain = [&]() {
+        char buffer[65536];
+        ssize_t len;
+        while ((len = read(fds[1], buffer, sizeof(buffer))) > 0) {
+            received += len;
+        }
+        if (received == data.size()) {
+            loop.quit();
+        } else {
+            loop.runAfter(std::chrono::milliseconds(1), drain);
+        }
+    };
+    loop.runAfter(std::chrono::milliseconds(1), drain);
+    run();
+    ASSERT_TRUE(coroutine.done());
+    ASSERT_EQ(data.size(), coroutine.result());
+    ASSERT_EQ(data.size(), received);
+}
+
+TEST_F(AsyncIoTest, AcceptAndSendfile) {
+    char path[] = "/tmp/async_io_test_XXXXXX";
+    int file = mkstemp(path);
+    unlink(path);
+    ASSERT_EQ(16, write(file, "0123456789abcdef", 16));
+
+    int listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = inet_addr("127.0.0.1");
+    ASSERT_EQ(0, bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)));
+    ASSERT_EQ(0, listen(listenFd, 8));
+    socklen_t length = sizeof(address);
+    getsockname(listenFd, reinterpret_cast<sockaddr *>(&address), &length);
+
+    AsyncFd listener(listenFd);
+    watch(listener);
+    std::unique_ptr<AsyncFd> connection;
+    auto server = [&]() -> Coroutine<ssize_t> {
+        sockaddr_in peer{};
+        ssize_t fd = co_await listener.accept(&peer);
+        if (fd < 0)
+            co_return fd;
+        connection = std::make_unique<AsyncFd>(static_cast<int>(fd));
+        watch(*connection);
+        ssize_t sent = co_await connection->sendfile(file, 10, 6);
+        loop.quit();
+        co_return sent;
+    };
+    Coroutine<ssize_t> coroutine = server();
+    coroutine.start();
+    ASSERT_FALSE(coroutine.done()); // 还没有连接
+
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(0, connect(client, reinterpret_cast<sockaddr *>(&address), sizeof(address)));
+    run();
+    ASSERT_EQ(6, coroutine.result());
+
+    char buffer[16];
+    ASSERT_EQ(6, read(client, buffer, sizeof(buffer)));
+    ASSERT_EQ("abcdef", std::string(buffer, 6));
+
+    close(client);
+    close(connection->fd());
+    close(listenFd);
+    close(file);
+}
+
+TEST_F(AsyncIoTest, SleepAndCancel) {
+    AsyncFd io(fds[0]);
+    watch(io);
+
+    auto reader = [&]() -> Coroutine<ssize_t> {
+        char buffer[16];
+        co_return co_await io.read(buffer, sizeof(buffer));
+    };
+    auto canceller = [&]() -> Coroutine<> {
+        co_await SleepFor(loop, std::chrono::milliseconds(20));
+        io.cancel();
+        loop.quit();
+    };
+
+    auto start = EventLoop::Clock::now();
+    Coroutine<ssize_t> reading = reader();
+    Coroutine<> cancelling = canceller();
+    reading.start();
+    cancelling.start();
+    run();
+    ASSERT_GE(EventLoop::Clock::now() - start, std::chrono::milliseconds(20));
+    ASSERT_TRUE(reading.done());
+    ASSERT_EQ(-ECANCELED, reading.result());
+
+    // 挂起中的协程被销毁时同时取消定时器
+    {
+        Coroutine<> sleeping = canceller();
+        sleeping.start();
+        ASSERT_NE(-1, loop.nextTimeoutMs());
+    }
+    ASSERT_EQ(-1, loop.nextTimeoutMs());
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <src/clock.hpp>
+#include <thread>
+
+TEST(CachedClockTest, HttpDate) {
+    // RFC 7231 中的示例
+    ASSERT_EQ("Sun, 06 Nov 1994 08:49:37 GMT", CachedClock::httpDate(784111777));
+    ASSERT_EQ("Thu, 01 Jan 1970 00:00:00 GMT", CachedClock::httpDate(0));
+    ASSERT_EQ("Sat, 29 Feb 2020 23:59:59 GMT", CachedClock::httpDate(1583020799));
+    ASSERT_EQ(29, CachedClock::httpDate().size());
+}
+
+TEST(CachedClockTest, LogTimestamp) {
+    setenv("TZ", "UTC", 1);
+    tzset();
+    ASSERT_EQ("1994-11-06 08:49:37", CachedClock::logTimestamp(784111777));
+    // 同一秒内返回同一个缓冲区
+    std::string_view first = CachedClock::logTimestamp(784111778);
+    ASSERT_EQ(first.data(), CachedClock::logTimestamp(784111778).data());
+    ASSERT_EQ("1994-11-06 08:49:38", first);
+}
+
+TEST(CachedClockTest, ThreadLocalBuffers) {
+    std::string_view main = CachedClock::httpDate(0);
+    std::string other;
+    std::thread([&other]() { other = std::string(CachedClock::httpDate(784111777)); }).join();
+    ASSERT_EQ("Thu, 01 Jan 1970 00:00:00 GMT", main); // 其他线程不会改写本线程的缓存
+    ASSERT_EQ("Sun, 06 Nov 1994 08:49:37 GMT", other);
+}
+
+TEST(CachedClockTest, NowIsCurrentSecond) {
+    std::time_t before = std::time(nullptr);
+    std::time_t now = CachedClock::now();
+    ASSERT_LE(std::abs(now - before), 1);
+}
+
+TEST(CachedClockTest, ParseHttpDate) {
+    std::time_t time = 0;
+    ASSERT_TRUE(CachedClock::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", time));
+    ASSERT_EQ(784111777, time);
+    ASSERT_TRUE(CachedClock::parseHttpDate("Sat, 29 Feb 2020 23:59:59 GMT", time));
+    ASSERT_EQ(1583020799, time);
+    ASSERT_TRUE(CachedClock::parseHttpDate(CachedClock::httpDate(1700000000), time));
+    ASSERT_EQ(1700000000, time);
+
+    ASSERT_FALSE(CachedClock::parseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT", time)); // RFC 850
+    ASSERT_FALSE(CachedClock::parseHttpDate("Sun Nov  6 08:49:37 1994", time)); // asctime
+    ASSERT_FALSE(CachedClock::parseHttpDate("Sun, 06 Nox 1994 08:49:37 GMT", time));
+    ASSERT_FALSE(CachedClock::parseHttpDate("Sun, 30 Feb 1994 08:49:37 GMT", time));
+    ASSERT_FALSE(CachedClock::parseHttpDate("Sun, 06 Nov 1994 24:49:37 GMT", time));
+    ASSERT_FALSE(CachedClock::parseHttpDate("Sun, 06 Nov 1994 08:49:37 UTC", time));
+    ASSERT_FALSE(CachedClock::parseHttpDate("", time));
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <src/conditional_request.hpp>
+#include <string>
+
+static constexpr std::string_view ETAG = "\"5f3a.0-4d2\"";
+
+static constexpr std::time_t MODIFIED = 784111777; // Sun, 06 Nov 1994 08:49:37 GMT
+
+class ConditionalRequestTest : public ::testing::Test {
+protected:
+    /**
+     * 以给定的头字段判定大小为 1234 的资源
+     */
+    ConditionalRequest::Outcome evaluate(const std::string &headers, const std::string &method = "GET") {
+        raw = method + " /image.png HTTP/1.1\r\n" + headers + "\r\n";
+        parser.reset();
+        EXPECT_EQ(ParseResult::COMPLETE, parser.parse(raw));
+        return ConditionalRequest::evaluate(parser.request(), ETAG, MODIFIED, 1234, ranges);
+    }
+
+    std::string raw;
+
+    HttpParser parser;
+
+    ByteRanges ranges;
+};
+
+TEST_F(ConditionalRequestTest, NotModified) {
+    using Outcome = ConditionalRequest::Outcome;
+    ASSERT_EQ(Outcome::FULL, evaluate(""));
+    ASSERT_EQ(Outcome::NOT_MODIFIED, evaluate("If-None-Match: \"5f3a.0-4d2\"\r\n"));
+    ASSERT_EQ(Outcome::NOT_MODIFIED, evaluate("If-None-Match: \"other\", W/\"5f3a.0-4d2\"\r\n")); // 弱比较
+    ASSERT_EQ(Outcome::NOT_MODIFIED, evaluate("If-None-Match: *\r\n"));
+    ASSERT_EQ(Outcome::FULL, evaluate("If-None-Match: \"other\"\r\n"));
+
+    ASSERT_EQ(Outcome::NOT_MODIFIED, evaluate("If-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n"));
+    ASSERT_EQ(Outcome::NOT_MODIFIED, evaluate("If-Modified-Since: Mon, 07 Nov 1994 08:49:37 GMT\r\n"));
+    ASSERT_EQ(Outcome::FULL, evaluate("If-Modified-Since: Sun, 06 Nov 1994 08:49:36 GMT\r\n"));
+    ASSERT_EQ(Outcome::FULL, evaluate("If-Modified-Since: yesterday\r\n"));
+    // 有 If-None-Match 时忽略 If-Modified-Since
+    ASSERT_EQ(Outcome::FULL, evaluate("If-None-Match: \"other\"\r\n"
+                                      "If-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n"));
+}
+
+TEST_F(ConditionalRequestTest, Ranges) {
+    using Outcome = ConditionalRequest::Outcome;
+    ASSERT_EQ(Outcome::PARTIAL, evaluate("Range: bytes=0-499\r\n"));
+    ASSERT_EQ(1, ranges.size());
+    ASSERT_EQ(0, ranges[0].offset);
+    ASSERT_EQ(500, ranges[0].length);
+
+    ASSERT_EQ(Outcome::PARTIAL, evaluate("Range: bytes=1000-, -100, 10-19\r\n"));
+    ASSERT_EQ(3, ranges.size());
+    ASSERT_EQ(1000, ranges[0].offset);
+    ASSERT_EQ(234, ranges[0].length);
+    ASSERT_EQ(1134, ranges[1].offset);
+    ASSERT_EQ(1233, ranges[1].last());
+    ASSERT_EQ(19, ranges[2].last());
+
+    // 结束位置超出资源时截断，不可满足的段被跳过
+    ASSERT_EQ(Outcome::PARTIAL, evaluate("Range: bytes=1200-99999, 5000-6000\r\n"));
+    ASSERT_EQ(1, ranges.size());
+    ASSERT_EQ(34, ranges[0].length);
+    ASSERT_EQ(Outcome::RANGE_NOT_SATISFIABLE, evaluate("Range: bytes=1234-\r\n"));
+    ASSERT_EQ(Outcome::RANGE_NOT_SATISFIABLE, evaluate("Range: bytes=-0\r\n"));
+
+    // 格式错误、不支持的单位或可疑的范围：返回完整内容
+    ASSERT_EQ(Outcome::FULL, evaluate("Range: bytes=500-100\r\n"));
+    ASSERT_EQ(Outcome::FULL, evaluate("Range: bytes=abc\r\n"));
+    ASSERT_EQ(Outcome::FULL, evaluate("Range: bytes=\r\n"));
+    ASSERT_EQ(Outcome::FULL, evaluate("Range: items=0-1\r\n"));
+    ASSERT_EQ(Outcome::FULL, evaluate("Range: bytes=0-999, 0-999\r\n")); // 重叠
+    std::string many = "Range: bytes=0-0";
+    for (size_t i = 1; i <= ByteRanges::MAX_RANGES; ++i) {
+        many += ", " + std::to_string(i * 2) + "-" + std::to_string(i * 2);
+    }
+    ASSERT_EQ(Outcome::FULL, evaluate(many + "\r\n"));
+
+    // 304 优先于范围
+    ASSERT_EQ(Outcome::NOT_MODIFIED, evaluate("If-None-Match: \"5f3a.0-4d2\"\r\nRange: bytes=0-1\r\n"));
+}
+
+TEST_F(ConditionalRequestTest, IfRange) {
+    using Outcome = ConditionalRequest::Outcome;
+    ASSERT_EQ(Outcome::PARTIAL, evaluate("If-Range: \"5f3a.0-4d2\"\r\nRange: bytes=0-1\r\n"));
+    ASSERT_EQ(Outcome::FULL, evaluate("If-Range: \"other\"\r\nRange: bytes=0-1\r\n"));
+    ASSERT_EQ(Outcome::FULL, evaluate("If-Range: W/\"5f3a.0-4d2\"\r\nRange: bytes=0-1\r\n")); // 强比较
+    ASSERT_EQ(Outcome::PARTIAL, evaluate("If-Range: Sun, 06 Nov 1994 08:49:37 GMT\r\nRange: bytes=0-1\r\n"));
+    ASSERT_EQ(Outcome::FULL, evaluate("If-Range: Mon, 07 Nov 1994 08:49:37 GMT\r\nRange: bytes=0-1\r\n"));
+}
+
+TEST_F(ConditionalRequestTest, OnlyGetAndHead) {
+    using Outcome = ConditionalRequest::Outcome;
+    ASSERT_EQ(Outcome::NOT_MODIFIED, evaluate("If-None-Match: \"5f3a.0-4d2\"\r\n", "HEAD"));
+    ASSERT_EQ(Outcome::PARTIAL, evaluate("Range: bytes=0-1\r\n", "HEAD"));
+    for (const std::string method: {"POST", "PUT", "DELETE"}) {
+        ASSERT_EQ(Outcome::FULL, evaluate("If-None-Match: \"5f3a.0-4d2\"\r\n", method)) << method;
+        ASSERT_EQ(Outcome::FULL, evaluate("If-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n", method)) << method;
+        ASSERT_EQ(Outcome::FULL, evaluate("Range: bytes=0-1\r\n", method)) << method;
+        ASSERT_EQ(Outcome::FULL, evaluate("Range: bytes=5000-\r\n", method)) << method;
+    }
+}
+
+TEST(EntityTagTest, MatchesAny) {
+    ASSERT_TRUE(ConditionalRequest::matchesAny("\"a\", \"b\"", "\"b\"", true));
+    ASSERT_TRUE(ConditionalRequest::matchesAny("W/\"a\"", "\"a\"", false));
+    ASSERT_FALSE(ConditionalRequest::matchesAny("W/\"a\"", "\"a\"", true));
+    ASSERT_FALSE(ConditionalRequest::matchesAny("\"a,b\"", "\"a\"", false)); // 标签中可以有逗号
+    ASSERT_TRUE(ConditionalRequest::matchesAny("\"a,b\"", "\"a,b\"", false));
+    ASSERT_FALSE(ConditionalRequest::matchesAny("a", "\"a\"", false));
+    ASSERT_FALSE(ConditionalRequest::matchesAny("", "\"a\"", false));
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <src/content_encoding.hpp>
+#include <string>
+
+TEST(AcceptEncodingTest, Parse) {
+    AcceptEncoding none;
+    ASSERT_TRUE(none.accepts(ContentEncoding::IDENTITY));
+    ASSERT_FALSE(none.acceptsAnyCompression());
+    ASSERT_FALSE(AcceptEncoding("").acceptsAnyCompression());
+
+    AcceptEncoding browser("gzip, deflate, br");
+    ASSERT_EQ(1000, browser.quality(ContentEncoding::GZIP));
+    ASSERT_EQ(1000, browser.quality(ContentEncoding::BROTLI));
+    ASSERT_TRUE(browser.accepts(ContentEncoding::IDENTITY)); // 未列出时仍可接受
+
+    AcceptEncoding weighted("GZIP;q=0.8 , br ; q=0.25,identity;q=0");
+    ASSERT_EQ(800, weighted.quality(ContentEncoding::GZIP));
+    ASSERT_EQ(250, weighted.quality(ContentEncoding::BROTLI));
+    ASSERT_FALSE(weighted.accepts(ContentEncoding::IDENTITY));
+
+    AcceptEncoding wildcard("br;q=0, *;q=0.5");
+    ASSERT_FALSE(wildcard.accepts(ContentEncoding::BROTLI));
+    ASSERT_EQ(500, wildcard.quality(ContentEncoding::GZIP));
+    ASSERT_EQ(500, wildcard.quality(ContentEncoding::IDENTITY));
+
+    ASSERT_TRUE(AcceptEncoding("x-gzip").accepts(ContentEncoding::GZIP));
+    ASSERT_EQ(1000, AcceptEncoding("gzip;q=1.0").quality(ContentEncoding::GZIP));
+    ASSERT_EQ(0, AcceptEncoding("gzip;q=0.000").quality(ContentEncoding::GZIP));
+}
+
+TEST(ContentCodingTest, Compressible) {
+    ASSERT_TRUE(ContentCoding::isCompressible("text/html; charset=utf-8"));
+    ASSERT_TRUE(ContentCoding::isCompressible("application/javascript; charset=utf-8"));
+    ASSERT_TRUE(ContentCoding::isCompressible("image/svg+xml"));
+    ASSERT_FALSE(ContentCoding::isCompressible("image/jpeg"));
+    ASSERT_FALSE(ContentCoding::isCompressible("application/octet-stream"));
+    ASSERT_EQ(".br", ContentCoding::extension(ContentEncoding::BROTLI));
+    ASSERT_EQ("gzip", ContentCoding::name(ContentEncoding::GZIP));
+}
+
+TEST(ContentCodingTest, Compress) {
+    std::string text;
+    for (int i = 0; i < 100; ++i) {
+        text += "<li class=\"news\">Breaking news number " + std::to_string(i) + "</li>\n";
+    }
+    for (ContentEncoding encoding: {ContentEncoding::GZIP, ContentEncoding::BROTLI}) {
+        std::string output;
+        ASSERT_EQ(ContentCoding::canCompress(encoding), ContentCoding::compress(encoding, text, output));
+        if (ContentCoding::canCompress(encoding)) {
+            ASSERT_GT(output.size(), 0);
+            ASSERT_LT(output.size(), text.size() / 4);
+        }
+    }
+
+#ifdef WEBSERVER_HAVE_ZLIB
+    std::string compressed;
+    ASSERT_TRUE(ContentCoding::compress(ContentEncoding::GZIP, text, compressed));
+    z_stream stream{};
+    ASSERT_EQ(Z_OK, inflateInit2(&stream, 15 + 16));
+    std::string decompressed(text.size(), '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(compressed.data());
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    stream.next_out = reinterpret_cast<Bytef *>(decompressed.data());
+    stream.avail_out = static_cast<uInt>(decompressed.size());
+    ASSERT_EQ(Z_STREAM_END, inflate(&stream, Z_FINISH));
+    inflateEnd(&stream);
+    ASSERT_EQ(text, decompressed);
+#endif
+}
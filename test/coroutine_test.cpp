@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <src/coroutine.hpp>
+#include <stdexcept>
+#include <string>
+#include <test/allocation_counter.hpp>
+
+static Coroutine<int> add(int a, int b) {
+    co_return a + b;
+}
+
+static Coroutine<int> sum(int n) {
+    int total = 0;
+    for (int i = 0; i < n; ++i) {
+        total += co_await add(i, 1);
+    }
+    co_return total;
+}
+
+static Coroutine<int> one() {
+    co_return 1;
+}
+
+static Coroutine<int> count(int n) {
+    int total = 0;
+    for (int i = 0; i < n; ++i) {
+        total += co_await one();
+    }
+    co_return total;
+}
+
+static Coroutine<> fail() {
+    throw std::runtime_error("failed");
+    co_return;
+}
+
+static Coroutine<std::string> recover() {
+    try {
+        co_await fail();
+    } catch (const std::runtime_error &e) {
+        co_return e.what();
+    }
+    co_return "unreachable";
+}
+
+TEST(CoroutineTest, AwaitChain) {
+    Coroutine<int> coroutine = sum(10);
+    coroutine.start();
+    ASSERT_TRUE(coroutine.done());
+    ASSERT_EQ(55, coroutine.result());
+
+    Coroutine<std::string> recovered = recover();
+    recovered.start();
+    ASSERT_EQ("failed", recovered.result());
+
+    Coroutine<> failed = fail();
+    failed.start();
+    ASSERT_TRUE(failed.done());
+    ASSERT_THROW(failed.result(), std::runtime_error);
+}
+
+TEST(CoroutineTest, DeepChainDoesNotGrowStack) {
+    // 对称转移：同步完成的子协程直接恢复等待者，一百万次 co_await 也不会耗尽调用栈
+    Coroutine<int> coroutine = count(1000000);
+    coroutine.start();
+    ASSERT_EQ(1000000, coroutine.result());
+}
+
+TEST(CoroutineTest, AsyncEvent) {
+    AsyncEvent event;
+    std::string trace;
+    auto waiter = [&]() -> Coroutine<> {
+        trace += "wait,";
+        int first = co_await event.wait();
+        trace += std::to_string(first) + ",";
+        int second = co_await event.wait();
+        trace += std::to_string(second);
+    };
+
+    Coroutine<> coroutine = waiter();
+    coroutine.start();
+    ASSERT_EQ("wait,", trace);
+    ASSERT_TRUE(event.isWaiting());
+
+    event.notify(1); // 恢复等待者，它随即再次挂起
+    ASSERT_EQ("wait,1,", trace);
+    ASSERT_FALSE(coroutine.done());
+
+    event.notify(2);
+    ASSERT_TRUE(coroutine.done());
+    ASSERT_EQ("wait,1,2", trace);
+
+    // 没有等待者时保留最后一次的结果，下一次等待立即返回
+    event.notify(3);
+    event.notify(4);
+    ASSERT_FALSE(event.isWaiting());
+    auto once = [&]() -> Coroutine<int> { co_return co_await event.wait(); };
+    Coroutine<int> immediate = once();
+    immediate.start();
+    ASSERT_TRUE(immediate.done());
+    ASSERT_EQ(4, immediate.result());
+}
+
+TEST(CoroutineTest, DetachedFreesItself) {
+    AsyncEvent event;
+    bool finished = false;
+    auto body = [](AsyncEvent &event, bool &finished) -> Detached {
+        co_await event.wait();
+        finished = true;
+    };
+
+    Detached task = body(event, finished);
+    size_t cached = FramePool::cached();
+    ASSERT_TRUE(task.handle());
+    ASSERT_FALSE(event.isWaiting()); // 创建后尚未开始
+    task.start();
+    ASSERT_TRUE(event.isWaiting());
+
+    event.notify(0);
+    ASSERT_TRUE(finished);
+    ASSERT_EQ(cached + 1, FramePool::cached()); // 结束后帧归还给内存池
+
+    // 挂起中的协程可以由持有 handle 的一方销毁
+    Detached suspended = body(event, finished);
+    suspended.start();
+    ASSERT_EQ(cached, FramePool::cached());
+    suspended.handle().destroy();
+    ASSERT_EQ(cached + 1, FramePool::cached());
+}
+
+TEST(CoroutineTest, FramesComeFromPool) {
+    auto round = []() {
+        for (int i = 0; i < 100; ++i) {
+            Coroutine<int> coroutine = sum(10);
+            coroutine.start();
+            ASSERT_EQ(55, coroutine.result());
+        }
+    };
+
+    // 预热：每种大小的帧分配过一次之后循环使用
+    round();
+    AllocationCounter allocations;
+    round();
+    ASSERT_EQ(0, allocations.count());
+    ASSERT_GE(FramePool::cached(), 2);
+}
+
+TEST(CoroutineTest, FramePoolSizeClasses) {
+    void *small = FramePool::allocate(1);
+    void *medium = FramePool::allocate(FramePool::GRANULARITY + 1);
+    size_t cached = FramePool::cached();
+    FramePool::deallocate(small, 1);
+    FramePool::deallocate(medium, FramePool::GRANULARITY + 1);
+    ASSERT_EQ(cached + 2, FramePool::cached());
+
+    // 同一级的大小复用同一块内存
+    ASSERT_EQ(small, FramePool::allocate(FramePool::GRANULARITY));
+    ASSERT_EQ(medium, FramePool::allocate(2 * FramePool::GRANULARITY));
+    FramePool::deallocate(small, FramePool::GRANULARITY);
+    FramePool::deallocate(medium, 2 * FramePool::GRANULARITY);
+
+    // 过大的帧直接使用堆内存，不进入内存池
+    void *large = FramePool::allocate(FramePool::MAX_POOLED_SIZE + 1);
+    FramePool::deallocate(large, FramePool::MAX_POOLED_SIZE + 1);
+    ASSERT_EQ(cached + 2, FramePool::cached());
+}
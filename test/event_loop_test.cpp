@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <src/event_loop.hpp>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+
+TEST(EventLoopTest, ReadinessAndRunInLoop) {
+    EventLoop loop;
+
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+    ASSERT_TRUE(loop.add(fds[0], EPOLLIN | EPOLLET));
+
+    std::string received;
+    std::thread producer([&]() {
+        ASSERT_EQ(5, write(fds[1], "hello", 5));
+    });
+
+    loop.loop([&](int fd, uint32_t events) {
+        ASSERT_EQ(fds[0], fd);
+        ASSERT_TRUE(events & EPOLLIN);
+        char buf[16];
+        ssize_t len;
+        while ((len = read(fd, buf, sizeof(buf))) > 0) {
+            received.append(buf, len);
+        }
+        // 由其他线程投递任务并退出循环
+        std::thread([&]() { loop.runInLoop([&]() { loop.quit(); }); }).join();
+    });
+    producer.join();
+
+    ASSERT_EQ("hello", received);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(EventLoopTest, Timers) {
+    EventLoop loop;
+    ASSERT_EQ(-1, loop.nextTimeoutMs());
+
+    std::string fired;
+    auto start = EventLoop::Clock::now();
+    loop.runAfter(std::chrono::milliseconds(30), [&]() {
+        fired += "b";
+        loop.quit();
+    });
+    loop.runAfter(std::chrono::milliseconds(10), [&]() {
+        fired += "a";
+        // 回调中添加的定时器按到期时间排队，不会在本轮执行
+        loop.runAfter(std::chrono::milliseconds(0), [&]() { fired += "c"; });
+    });
+    auto cancelled = loop.runAfter(std::chrono::milliseconds(20), [&]() { fired += "x"; });
+    ASSERT_GE(loop.nextTimeoutMs(), 1);
+    ASSERT_LE(loop.nextTimeoutMs(), 10);
+    loop.cancelTimer(cancelled);
+    loop.cancelTimer(cancelled);
+
+    loop.loop([](int, uint32_t) {});
+    ASSERT_EQ("acb", fired);
+    ASSERT_GE(EventLoop::Clock::now() - start, std::chrono::milliseconds(30));
+    ASSERT_EQ(-1, loop.nextTimeoutMs());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
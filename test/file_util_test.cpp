@@ -6,6 +6,31 @@
 //    ASSERT_EQ(1, 3 - 2);
 //}
 
+TEST(FileUtilNormalizePathTest, BasicAssertions) {
+    ASSERT_EQ(std::make_pair(std::string("index.html"), true), FileUtil::normalizePath("/index.html"));
+    ASSERT_EQ(std::make_pair(std::string(""), true), FileUtil::normalizePath("/"));
+    ASSERT_EQ(std::make_pair(std::string("images/R-C.png"), true),
+              FileUtil::normalizePath("//images/./foo/../R-C.png?v=1#top"));
+    ASSERT_EQ(std::make_pair(std::string("images/a b.png"), true), FileUtil::normalizePath("/images/a%20b.png"));
+    ASSERT_FALSE(FileUtil::normalizePath("/../etc/passwd").second);
+    ASSERT_FALSE(FileUtil::normalizePath("/%2e%2e/etc/passwd").second);
+    ASSERT_FALSE(FileUtil::normalizePath("/a%00b").second);
+    ASSERT_FALSE(FileUtil::normalizePath("/a%zz").second);
+    ASSERT_EQ(std::make_pair(std::string("b/d"), true), FileUtil::normalizePath("/a/../b/c/.././d/"));
+}
+
+TEST(FileUtilNormalizePathTest, ReusesBuffer) {
+    std::string path;
+    ASSERT_TRUE(FileUtil::normalizePath("/images/background.jpg?v=2", path));
+    ASSERT_EQ("images/background.jpg", path);
+    const char *data = path.data();
+    ASSERT_TRUE(FileUtil::normalizePath("/css/../js/app.js", path));
+    ASSERT_EQ("js/app.js", path);
+    ASSERT_EQ(data, path.data()); // 缓冲区容量足够时不重新分配
+    ASSERT_FALSE(FileUtil::normalizePath("/../a", path));
+    ASSERT_TRUE(path.empty());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <src/histogram.hpp>
+
+TEST(HistogramTest, BasicAssertions) {
+    Histogram histogram;
+    ASSERT_EQ(0, histogram.count());
+    ASSERT_EQ(0, histogram.valueAtPercentile(50));
+
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        histogram.record(i);
+    }
+    ASSERT_EQ(1000, histogram.count());
+    ASSERT_EQ(1, histogram.min());
+    ASSERT_EQ(1000, histogram.max());
+    ASSERT_DOUBLE_EQ(500.5, histogram.mean());
+    // 小于 2048 的数值精确记录
+    ASSERT_EQ(500, histogram.valueAtPercentile(50));
+    ASSERT_EQ(990, histogram.valueAtPercentile(99));
+    ASSERT_EQ(1000, histogram.valueAtPercentile(100));
+    ASSERT_EQ(1, histogram.valueAtPercentile(0));
+}
+
+TEST(HistogramTest, RelativeError) {
+    // 任意数值所在桶的上界与数值本身的相对误差不超过 1/1024
+    for (uint64_t value = 1; value < (uint64_t(1) << 40); value = value * 3 + 7) {
+        uint64_t highest = Histogram::highestEquivalentValue(Histogram::indexOf(value));
+        ASSERT_GE(highest, value);
+        ASSERT_LE(highest - value, value / 1024) << value;
+        // 桶的下标随数值单调不减
+        ASSERT_LE(Histogram::indexOf(value), Histogram::indexOf(value + 1));
+    }
+
+    Histogram histogram;
+    histogram.record(1'000'000);
+    uint64_t p50 = histogram.valueAtPercentile(50);
+    ASSERT_EQ(1'000'000, p50); // 不超过实际的最大值
+}
+
+TEST(HistogramTest, MergeAndClamp) {
+    Histogram a(1'000'000), b(1'000'000);
+    for (int i = 0; i < 90; ++i) {
+        a.record(100);
+    }
+    for (int i = 0; i < 10; ++i) {
+        b.record(50'000);
+    }
+    b.record(5'000'000); // 超出范围按最大值记录
+
+    a.merge(b);
+    ASSERT_EQ(101, a.count());
+    ASSERT_EQ(100, a.min());
+    ASSERT_EQ(1'000'000, a.max());
+    ASSERT_EQ(100, a.valueAtPercentile(50));
+    uint64_t p95 = a.valueAtPercentile(95);
+    ASSERT_GE(p95, 50'000);
+    ASSERT_LE(p95, 50'000 + 50'000 / 1024);
+
+    a.reset();
+    ASSERT_EQ(0, a.count());
+    ASSERT_EQ(0, a.max());
+}
@@ -12,6 +12,7 @@ TEST(HttpHandlerResolveRequest, BasicAssertions) {
     ASSERT_EQ("/get", request.url);
     ASSERT_EQ("HTTP/1.1", request.version);
     ASSERT_EQ("localhost:8080", request.headers.get("Host"));
+    ASSERT_EQ("localhost:8080", request.headers.get(KnownHeader::HOST));
     ASSERT_EQ("I am body", request.body);
 }
 
@@ -21,10 +22,36 @@ TEST(HttpHandlerSerializeResponseTest, BasicAssertions) {
     headers.put("User-Agent", "Mozilla/5.0");
     HttpResponse response("HTTP/1.1", "403", "Forbidden", headers, "I am body");
 
-    ASSERT_EQ("HTTP/1.1 403 Forbidden\r\nUser-Agent: Mozilla/5.0\r\nHost: localhost:8080\r\n\r\nI am body",
+    ASSERT_EQ("HTTP/1.1 403 Forbidden\r\nHost: localhost:8080\r\nUser-Agent: Mozilla/5.0\r\nContent-Length: 9\r\n\r\nI am body",
               HttpHandler::serializeResponse(std::move(response)));
 }
 
+static bool isKeepAlive(std::string_view bytes) {
+    HttpParser parser;
+    EXPECT_EQ(ParseResult::COMPLETE, parser.parse(bytes));
+    return HttpHandler::isKeepAlive(parser.request());
+}
+
+TEST(HttpHandlerIsKeepAliveTest, BasicAssertions) {
+    ASSERT_TRUE(isKeepAlive("GET / HTTP/1.1\r\nHost: a\r\n\r\n"));
+    ASSERT_FALSE(isKeepAlive("GET / HTTP/1.1\r\nconnection: Close\r\n\r\n"));
+    ASSERT_FALSE(isKeepAlive("GET / HTTP/1.0\r\nHost: a\r\n\r\n"));
+    ASSERT_TRUE(isKeepAlive("GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n"));
+
+    // Connection 是选项列表
+    ASSERT_FALSE(isKeepAlive("GET / HTTP/1.1\r\nConnection: close, TE\r\n\r\n"));
+    ASSERT_FALSE(isKeepAlive("GET / HTTP/1.1\r\nConnection: TE,\tClose\r\n\r\n"));
+    ASSERT_TRUE(isKeepAlive("GET / HTTP/1.1\r\nConnection: TE\r\n\r\n"));
+    ASSERT_TRUE(isKeepAlive("GET / HTTP/1.0\r\nConnection: Keep-Alive, Upgrade\r\n\r\n"));
+    ASSERT_FALSE(isKeepAlive("GET / HTTP/1.0\r\nConnection: Upgrade\r\n\r\n"));
+    ASSERT_FALSE(isKeepAlive("GET / HTTP/1.0\r\nConnection: keep-alive-ish\r\n\r\n"));
+}
+
+TEST(HttpHandlerResolveRequest, MalformedRequest) {
+    ASSERT_THROW(HttpHandler::resolveRequest("GET /get HTTP/1.1"), std::invalid_argument);
+    ASSERT_THROW(HttpHandler::resolveRequest("GET /get HTTP/1.1\r\nHost localhost\r\n\r\n"), std::invalid_argument);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <src/http_headers.hpp>
+#include <src/memory_pool.hpp>
+#include <string>
+#include <test/allocation_counter.hpp>
+#include <vector>
+
+static std::string joined(const HttpHeaders &headers) {
+    std::string result;
+    headers.forEach([&result](std::string_view header, std::string_view attribute) {
+        result.append(header).append(": ").append(attribute).append("\n");
+    });
+    return result;
+}
+
+TEST(HeaderNamesTest, Lookup) {
+    for (size_t i = 0; i < HeaderNames::COUNT; ++i) {
+        auto header = static_cast<KnownHeader>(i);
+        ASSERT_EQ(header, HeaderNames::lookup(HeaderNames::name(header)));
+    }
+    static_assert(HeaderNames::lookup("Content-Length") == KnownHeader::CONTENT_LENGTH);
+    ASSERT_EQ(KnownHeader::IF_NONE_MATCH, HeaderNames::lookup("if-none-match"));
+    ASSERT_EQ(KnownHeader::HOST, HeaderNames::lookup("HOST"));
+    ASSERT_EQ(KnownHeader::UNKNOWN, HeaderNames::lookup(""));
+    ASSERT_EQ(KnownHeader::UNKNOWN, HeaderNames::lookup("X-Forwarded-For"));
+    ASSERT_EQ(KnownHeader::UNKNOWN, HeaderNames::lookup("Hast"));
+    ASSERT_EQ(KnownHeader::UNKNOWN, HeaderNames::lookup("Content-Lengths"));
+}
+
+TEST(HttpHeadersTest, InsertionOrderAndCaseInsensitive) {
+    HttpHeaders headers;
+    headers.put("Host", "localhost");
+    headers.put("X-Request-Id", "42");
+    headers.put("content-type", "text/html");
+    ASSERT_EQ("Host: localhost\nX-Request-Id: 42\ncontent-type: text/html\n", joined(headers));
+
+    ASSERT_EQ("localhost", headers.get("host"));
+    ASSERT_EQ("localhost", headers.get(KnownHeader::HOST));
+    ASSERT_EQ("42", headers.get("x-request-id"));
+    ASSERT_EQ("text/html", headers.get(KnownHeader::CONTENT_TYPE));
+    ASSERT_TRUE(headers.contains("Content-Type"));
+
+    // 查找不存在的字段不会插入
+    ASSERT_TRUE(headers.get("Connection").empty());
+    ASSERT_TRUE(headers.get("X-Missing").empty());
+    ASSERT_EQ("default", headers.getOrDefault("X-Missing", "default"));
+    ASSERT_FALSE(headers.contains(KnownHeader::CONNECTION));
+    ASSERT_EQ(3, headers.size());
+}
+
+TEST(HttpHeadersTest, MultipleValues) {
+    HttpHeaders headers;
+    headers.add("Accept", "text/html");
+    headers.add("X-Tag", "a");
+    headers.add("accept", "image/webp");
+    headers.add("x-tag", "b");
+    ASSERT_EQ(2, headers.count("Accept"));
+    ASSERT_EQ(2, headers.count("X-TAG"));
+    ASSERT_EQ("text/html", headers.get("Accept"));
+
+    std::vector<std::string> values;
+    headers.forEachValue("ACCEPT", [&values](std::string_view value) { values.emplace_back(value); });
+    ASSERT_EQ((std::vector<std::string>{"text/html", "image/webp"}), values);
+
+    // put 替换第一个值并移除其余同名字段
+    headers.put("x-tag", "c");
+    ASSERT_EQ(1, headers.count("X-Tag"));
+    ASSERT_EQ("Accept: text/html\nX-Tag: c\naccept: image/webp\n", joined(headers));
+
+    headers.put("Accept", "a much longer value than before");
+    ASSERT_EQ("Accept: a much longer value than before\nX-Tag: c\n", joined(headers));
+
+    ASSERT_TRUE(headers.erase("accept"));
+    ASSERT_FALSE(headers.erase("Accept"));
+    ASSERT_FALSE(headers.contains(KnownHeader::ACCEPT));
+    ASSERT_EQ("X-Tag: c\n", joined(headers));
+}
+
+TEST(HttpHeadersTest, Overflow) {
+    HttpHeaders headers;
+    for (size_t i = 0; i < HttpHeaders::INLINE_CAPACITY * 2; ++i) {
+        headers.add("X-Header-" + std::to_string(i), std::to_string(i));
+    }
+    headers.add("Connection", "close");
+    ASSERT_EQ(HttpHeaders::INLINE_CAPACITY * 2 + 1, headers.size());
+    ASSERT_EQ("close", headers.get(KnownHeader::CONNECTION));
+    ASSERT_EQ("12", headers.get("x-header-12"));
+
+    ASSERT_TRUE(headers.erase("X-Header-3"));
+    ASSERT_EQ("close", headers.get("connection"));
+    ASSERT_EQ("4", headers.get("X-Header-4"));
+    ASSERT_EQ(HttpHeaders::INLINE_CAPACITY * 2, headers.size());
+
+    HttpHeaders copy = headers;
+    ASSERT_EQ(joined(headers), joined(copy));
+}
+
+TEST(HttpHeadersTest, ArenaBacked) {
+    BufferPool pool;
+    Arena arena(&pool);
+    {
+        HttpHeaders headers(&arena);
+        headers.add("Host", "127.0.0.1:8080");
+        headers.add("Connection", "keep-alive");
+        headers.add("Accept-Encoding", "gzip, deflate, br");
+    }
+    arena.reset();
+
+    AllocationCounter allocations;
+    for (int i = 0; i < 100; ++i) {
+        HttpHeaders headers(&arena);
+        headers.add("Host", "127.0.0.1:8080");
+        headers.add("Connection", "keep-alive");
+        headers.add("Accept-Encoding", "gzip, deflate, br");
+        ASSERT_EQ("keep-alive", headers.get(KnownHeader::CONNECTION));
+        ASSERT_FALSE(headers.contains(KnownHeader::IF_NONE_MATCH));
+        arena.reset();
+    }
+    ASSERT_EQ(0, allocations.count());
+}
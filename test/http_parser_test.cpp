@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <src/http_parser.hpp>
+#include <string>
+
+static const std::string REQUEST = "POST /comment HTTP/1.1\r\n"
+                                   "Host: localhost:8080\r\n"
+                                   "Content-Type:text/plain \r\n"
+                                   "Content-Length: 11\r\n"
+                                   "\r\n"
+                                   "hello world"
+                                   "GET /index HTTP/1.1\r\n\r\n";
+
+TEST(HttpParserTest, CompleteRequest) {
+    HttpParser parser;
+    ASSERT_EQ(ParseResult::COMPLETE, parser.parse(REQUEST));
+
+    const HttpRequestView &request = parser.request();
+    ASSERT_EQ("POST", request.method);
+    ASSERT_EQ("/comment", request.url);
+    ASSERT_EQ("HTTP/1.1", request.version);
+    ASSERT_EQ(3, request.headerCount);
+    ASSERT_EQ("localhost:8080", request.header("host"));
+    ASSERT_EQ("text/plain", request.header("Content-Type"));
+    ASSERT_EQ("hello world", request.body);
+    ASSERT_TRUE(request.header("If-None-Match").empty());
+    ASSERT_EQ("11", request.header(KnownHeader::CONTENT_LENGTH));
+    ASSERT_TRUE(request.hasHeader(KnownHeader::HOST));
+    ASSERT_FALSE(request.hasHeader(KnownHeader::CONNECTION));
+
+    // 流水线中的下一个请求
+    std::string_view rest = std::string_view(REQUEST).substr(parser.consumed());
+    parser.reset();
+    ASSERT_EQ(ParseResult::COMPLETE, parser.parse(rest));
+    ASSERT_EQ("/index", parser.request().url);
+    ASSERT_EQ(rest.size(), parser.consumed());
+}
+
+TEST(HttpParserTest, ByteByByte) {
+    // 每次只多给一个字节，模拟请求被拆分到多次 recv() 中
+    HttpParser parser;
+    std::string buffer;
+    size_t end = REQUEST.find("GET");
+    for (size_t i = 0; i < end - 1; ++i) {
+        buffer.push_back(REQUEST[i]);
+        ASSERT_EQ(ParseResult::NEED_MORE, parser.parse(buffer)) << i;
+    }
+    buffer.push_back(REQUEST[end - 1]);
+    ASSERT_EQ(ParseResult::COMPLETE, parser.parse(buffer));
+    ASSERT_EQ("hello world", parser.request().body);
+    ASSERT_EQ(end, parser.consumed());
+}
+
+TEST(HttpParserTest, Malformed) {
+    auto parse = [](std::string_view bytes) {
+        HttpParser parser;
+        return parser.parse(bytes);
+    };
+    ASSERT_EQ(ParseResult::NEED_MORE, parse("GET /get HTTP/1.1"));
+    ASSERT_EQ(ParseResult::MALFORMED, parse("GET /get HTTP/1.1\rX"));
+    ASSERT_EQ(ParseResult::MALFORMED, parse("GET /get\r\n\r\n"));
+    ASSERT_EQ(ParseResult::MALFORMED, parse("GET /get FTP/1.1\r\n\r\n"));
+    ASSERT_EQ(ParseResult::MALFORMED, parse("GET /get HTTP/1.1\r\nHost localhost\r\n\r\n"));
+    ASSERT_EQ(ParseResult::MALFORMED, parse("GET /get HTTP/1.1\r\nHost : localhost\r\n\r\n"));
+    ASSERT_EQ(ParseResult::MALFORMED, parse("GET /get HTTP/1.1\r\nContent-Length: -1\r\n\r\n"));
+    ASSERT_EQ(ParseResult::MALFORMED, parse("GET /get HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n"));
+    ASSERT_EQ(ParseResult::MALFORMED, parse("GET /get HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
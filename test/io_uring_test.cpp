@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <src/io_uring.hpp>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+class IoUringTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!IoUring::isSupported())
+            GTEST_SKIP() << "io_uring is not supported by this kernel";
+    }
+
+    /**
+     * 等待并取出 n 个完成事件
+     */
+    static std::vector<io_uring_cqe> wait(IoUring &ring, size_t n) {
+        std::vector<io_uring_cqe> result;
+        while (result.size() < n) {
+            ring.submitAndWait(1, 1000);
+            ring.forEachCompletion([&result](const io_uring_cqe &cqe) { result.push_back(cqe); });
+        }
+        return result;
+    }
+
+    static io_uring_cqe waitOne(IoUring &ring) {
+        return wait(ring, 1)[0];
+    }
+};
+
+TEST_F(IoUringTest, ReadRegisteredFile) {
+    char path[] = "/tmp/io_uring_test_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_EQ(11, write(fd, "hello world", 11));
+
+    IoUring ring(8);
+    ASSERT_TRUE(ring.registerSparseFiles(4));
+    ASSERT_TRUE(ring.updateFile(2, fd));
+    // 已注册的文件不受原描述符关闭的影响
+    close(fd);
+    unlink(path);
+
+    char buffer[16]{};
+    ring.read(2, true, buffer, sizeof(buffer), 6, 42);
+    io_uring_cqe cqe = waitOne(ring);
+    ASSERT_EQ(42, cqe.user_data);
+    ASSERT_EQ(5, cqe.res);
+    ASSERT_EQ("world", std::string(buffer, 5));
+}
+
+TEST_F(IoUringTest, MultishotRecvWithBufferRing) {
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+
+    IoUring ring(8);
+    BufferRing buffers(ring, 7, 4, 64);
+    ring.recvMultishot(fds[0], buffers.group(), 1);
+    ring.submitAndWait(0, -1);
+
+    for (const char *message: {"first", "second"}) {
+        ASSERT_EQ(static_cast<ssize_t>(strlen(message)), write(fds[1], message, strlen(message)));
+        io_uring_cqe cqe = waitOne(ring);
+        ASSERT_EQ(1, cqe.user_data);
+        ASSERT_TRUE(cqe.flags & IORING_CQE_F_BUFFER);
+        ASSERT_TRUE(cqe.flags & IORING_CQE_F_MORE); // 仍在等待下一次数据
+        uint16_t id = BufferRing::bufferId(cqe.flags);
+        ASSERT_EQ(message, buffers.data(id, cqe.res));
+        buffers.recycle(id);
+    }
+
+    // 对端关闭后 recv 返回 0 并结束
+    close(fds[1]);
+    io_uring_cqe cqe = waitOne(ring);
+    ASSERT_EQ(0, cqe.res);
+    ASSERT_FALSE(cqe.flags & IORING_CQE_F_MORE);
+    close(fds[0]);
+}
+
+TEST_F(IoUringTest, LinkedSendAndClose) {
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+    IoUring ring(8);
+    std::string head = "HTTP/1.1 200 OK\r\n\r\n", body = "payload";
+    iovec iov[2] = {{head.data(), head.size()}, {body.data(), body.size()}};
+    msghdr message{};
+    message.msg_iov = iov;
+    message.msg_iovlen = 2;
+    ring.sendmsg(fds[0], &message, 1, true);
+    ring.close(fds[0], 2);
+    // 两个请求一次提交，按链接顺序完成
+    ASSERT_EQ(2, ring.submitAndWait(0, -1));
+    std::vector<io_uring_cqe> cqes = wait(ring, 2);
+    ASSERT_EQ(1, cqes[0].user_data);
+    ASSERT_EQ(static_cast<int>(head.size() + body.size()), cqes[0].res);
+    ASSERT_EQ(2, cqes[1].user_data);
+    ASSERT_EQ(0, cqes[1].res);
+
+    std::string received;
+    char buffer[64];
+    ssize_t len;
+    while ((len = read(fds[1], buffer, sizeof(buffer))) > 0) {
+        received.append(buffer, len);
+    }
+    ASSERT_EQ(head + body, received); // 读到 EOF，说明发送后连接已关闭
+    close(fds[1]);
+}
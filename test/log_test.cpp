@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <src/log.hpp>
+#include <thread>
+#include <vector>
 
 TEST(MainTest, BasicAssertions) {
     LogLevel level = LogLevel::INFO;
@@ -12,6 +15,193 @@ TEST(MainTest, BasicAssertions) {
     log.fatal("Hello world!");
 }
 
+/**
+ * 记录写出内容的输出器，可以让写出暂停以模拟慢速输出
+ */
+class CaptureLogAppender : public LogAppender {
+public:
+    CaptureLogAppender() : LogAppender(std::make_shared<LogFormatter>(LogLevel::DEBUG), LogLevel::DEBUG) {}
+
+    void log(LogLevel level, std::shared_ptr<LogEvent> logEvent) override {
+        write(formatter_->format(level, logEvent) + "\n");
+    }
+
+    void write(std::string_view text) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        resumed.wait(lock, [this]() { return !isPaused; });
+        output.append(text);
+        ++writes;
+    }
+
+    void flush() override {
+        ++flushes;
+    }
+
+    void pause(bool paused) {
+        {
+            const std::lock_guard<std::mutex> lockGuard(mutex);
+            isPaused = paused;
+        }
+        resumed.notify_all();
+    }
+
+    size_t lines() {
+        const std::lock_guard<std::mutex> lockGuard(mutex);
+        return std::count(output.begin(), output.end(), '\n');
+    }
+
+    std::mutex mutex;
+    std::condition_variable resumed;
+    bool isPaused = false;
+    std::string output;
+    std::atomic<size_t> writes{0};
+    std::atomic<size_t> flushes{0};
+};
+
+/**
+ * 格式化时计数的类型，用于验证被过滤的日志不做格式化
+ */
+struct Counted {
+    static inline int formats = 0;
+};
+
+template<>
+struct fmt::formatter<Counted> : fmt::formatter<std::string_view> {
+    template<typename FormatContext>
+    auto format(const Counted &, FormatContext &ctx) const {
+        ++Counted::formats;
+        return fmt::formatter<std::string_view>::format("counted", ctx);
+    }
+};
+
+TEST(LogRecordTest, DeferredFormatting) {
+    std::string name = "index.html";
+    const char *method = "GET";
+    LogRecord record = LogRecord::capture(LogLevel::INFO, "{} {} {} {:.1f} {}", method, std::string_view(name),
+                                          404, 2.25, 'x');
+    name = "changed"; // 参数在捕获时已复制
+    ASSERT_EQ("GET index.html 404 2.2 x", record.content());
+
+    // 参数超过内联缓冲区时使用堆内存
+    std::string large(LogRecord::INLINE_SIZE * 2, 'a');
+    ASSERT_EQ(large + "!", LogRecord::capture(LogLevel::INFO, "{}!", large).content());
+
+    // 其他类型在捕获时格式化为字符串
+    ASSERT_EQ("counted", LogRecord::capture(LogLevel::INFO, "{}", Counted()).content());
+    ASSERT_EQ("{not a format}", LogRecord::text(LogLevel::INFO, "{not a format}").content());
+}
+
+TEST(LogRecordTest, FormatErrorDoesNotThrow) {
+    // 只对原类型有效的格式说明：指针在捕获时已格式化为字符串
+    int value = 0;
+    LogRecord record = LogRecord::capture(LogLevel::ERROR, "at {:p}", static_cast<const void *>(&value));
+    std::string content;
+    ASSERT_NO_THROW(content = record.content());
+    ASSERT_EQ(0, content.find("<format error: "));
+    ASSERT_NE(std::string::npos, content.find("> at {:p}"));
+}
+
+// Logger 只接受字符串字面量格式串，且按参数实际保存的类型校验
+static_assert(std::is_constructible_v<LogFormat<int>, const char (&)[5]>);
+static_assert(!std::is_constructible_v<LogFormat<int>, std::string>);
+static_assert(!std::is_constructible_v<LogFormat<int>, decltype(fmt::runtime(std::string_view()))>);
+
+TEST(LoggerTest, LevelCheckedBeforeCapture) {
+    auto sink = std::make_shared<CaptureLogAppender>();
+    Logger log(LogLevel::INFO, sink);
+
+    Counted::formats = 0;
+    log.debug("{}", Counted());
+    ASSERT_EQ(0, Counted::formats);
+    ASSERT_EQ(0, sink->lines());
+
+    // 宏在等级不够时连参数都不求值
+    int evaluations = 0;
+    LOG_DEBUG(log, "{}", ++evaluations);
+    ASSERT_EQ(0, evaluations);
+    LOG_INFO(log, "value {}", ++evaluations);
+    ASSERT_EQ(1, evaluations);
+
+    log.warning("{} request for {}", "GET", "/");
+    log.error("{braces} kept"); // 不带参数的文本按原样输出
+    ASSERT_EQ(3, sink->lines());
+    ASSERT_NE(std::string::npos, sink->output.find("[INFO   ] : value 1\n"));
+    ASSERT_NE(std::string::npos, sink->output.find("[WARNING] : GET request for /\n"));
+    ASSERT_NE(std::string::npos, sink->output.find("[ERROR  ] : {braces} kept\n"));
+    ASSERT_FALSE(log.isEnabled(LogLevel::DEBUG));
+    ASSERT_TRUE(log.isEnabled(LogLevel::INFO));
+}
+
+TEST(AsyncLogAppenderTest, BatchesAndFlushes) {
+    auto formatter = std::make_shared<LogFormatter>(LogLevel::INFO);
+    auto sink = std::make_shared<CaptureLogAppender>();
+    auto appender = std::make_shared<AsyncLogAppender>(formatter, LogLevel::INFO, sink, 1 << 16,
+                                                       LogOverflowPolicy::BLOCK);
+    Logger log(LogLevel::INFO, appender);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&log, t]() {
+            for (int i = 0; i < 1000; ++i) {
+                log.info(fmt::format("thread {} line {}", t, i));
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    log.debug("filtered out");
+    appender->flush();
+
+    ASSERT_EQ(4000, sink->lines());
+    ASSERT_EQ(0, appender->dropped());
+    ASSERT_LT(sink->writes.load(), 4000); // 批量写出
+    ASSERT_GT(sink->flushes.load(), 0);
+    ASSERT_NE(std::string::npos, sink->output.find("[INFO   ] : thread 3 line 999\n"));
+    ASSERT_EQ(std::string::npos, sink->output.find("filtered out"));
+    // 同一线程的日志保持顺序
+    ASSERT_LT(sink->output.find("thread 0 line 1\n"), sink->output.find("thread 0 line 2\n"));
+}
+
+TEST(AsyncLogAppenderTest, DropWhenFull) {
+    auto formatter = std::make_shared<LogFormatter>(LogLevel::INFO);
+    auto sink = std::make_shared<CaptureLogAppender>();
+    auto appender = std::make_shared<AsyncLogAppender>(formatter, LogLevel::INFO, sink, 16,
+                                                       LogOverflowPolicy::DROP);
+    Logger log(LogLevel::INFO, appender);
+
+    // 输出暂停期间队列很快被占满，多出的日志被丢弃，生产者不会阻塞
+    sink->pause(true);
+    for (int i = 0; i < 1000; ++i) {
+        log.info("line");
+    }
+    ASSERT_GT(appender->dropped(), 0);
+    sink->pause(false);
+    appender->flush();
+    ASSERT_EQ(1000, sink->lines() + appender->dropped());
+}
+
+TEST(AsyncLogAppenderTest, BlockWhenFull) {
+    auto formatter = std::make_shared<LogFormatter>(LogLevel::INFO);
+    auto sink = std::make_shared<CaptureLogAppender>();
+    auto appender = std::make_shared<AsyncLogAppender>(formatter, LogLevel::INFO, sink, 16,
+                                                       LogOverflowPolicy::BLOCK);
+    Logger log(LogLevel::INFO, appender);
+
+    sink->pause(true);
+    std::thread producer([&log]() {
+        for (int i = 0; i < 1000; ++i) {
+            log.info("line");
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    sink->pause(false);
+    producer.join();
+    appender->flush();
+    ASSERT_EQ(1000, sink->lines());
+    ASSERT_EQ(0, appender->dropped());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
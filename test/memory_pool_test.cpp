@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <src/http_handler.hpp>
+#include <src/memory_pool.hpp>
+#include <string>
+#include <test/allocation_counter.hpp>
+
+static const std::string REQUEST =
+        "GET /images/background.jpg HTTP/1.1\r\n"
+        "Host: 127.0.0.1:8080\r\n"
+        "Connection: keep-alive\r\n"
+        "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/537.36\r\n"
+        "Accept: image/avif,image/webp,image/apng,image/svg+xml,image/*,*/*;q=0.8\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\n"
+        "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+        "\r\n";
+
+TEST(BufferPoolTest, SizeClasses) {
+    ASSERT_EQ(64, BufferPool::blockSize(1));
+    ASSERT_EQ(128, BufferPool::blockSize(65));
+    ASSERT_EQ(8192, BufferPool::blockSize(8192));
+
+    BufferPool pool;
+    void *small = pool.allocate(100);
+    void *large = pool.allocate(5000);
+    ASSERT_EQ(2, pool.upstreamAllocations());
+    pool.deallocate(small, 100);
+    pool.deallocate(large, 5000);
+    ASSERT_EQ(128 + 8192, pool.cachedBytes());
+
+    // 同一级的大小复用同一块内存
+    ASSERT_EQ(small, pool.allocate(128));
+    ASSERT_EQ(large, pool.allocate(8000));
+    ASSERT_EQ(2, pool.upstreamAllocations());
+    ASSERT_EQ(0, pool.cachedBytes());
+    pool.deallocate(small, 128);
+    pool.deallocate(large, 8000);
+
+    // 过大的请求直接交给上游，不进入空闲链表
+    void *huge = pool.allocate(BufferPool::MAX_BLOCK_SIZE + 1);
+    pool.deallocate(huge, BufferPool::MAX_BLOCK_SIZE + 1);
+    ASSERT_EQ(3, pool.upstreamAllocations());
+    ASSERT_EQ(128 + 8192, pool.cachedBytes());
+
+    pool.release();
+    ASSERT_EQ(0, pool.cachedBytes());
+}
+
+TEST(BufferPoolTest, CachedBytesLimit) {
+    BufferPool pool(1024);
+    void *first = pool.allocate(1024);
+    void *second = pool.allocate(1024);
+    pool.deallocate(first, 1024);
+    pool.deallocate(second, 1024); // 超过上限，归还给上游
+    ASSERT_EQ(1024, pool.cachedBytes());
+}
+
+TEST(BufferPoolTest, ContainersRecycleAcrossOwners) {
+    BufferPool pool;
+    auto fill = [&pool]() {
+        std::pmr::string buffer(&pool);
+        buffer.append(REQUEST);
+        std::pmr::deque<std::string_view> queue(&pool);
+        for (int i = 0; i < 100; ++i) {
+            queue.emplace_back(buffer);
+        }
+    };
+
+    // 一个容器释放的内存块被之后的容器取出
+    fill();
+    size_t upstream = pool.upstreamAllocations();
+    AllocationCounter allocations;
+    for (int i = 0; i < 10; ++i) {
+        fill();
+    }
+    ASSERT_EQ(upstream, pool.upstreamAllocations());
+    ASSERT_EQ(0, allocations.count());
+}
+
+TEST(ArenaTest, BumpAllocation) {
+    BufferPool pool;
+    Arena arena(&pool, 1024);
+
+    auto *first = static_cast<char *>(arena.allocate(10, 1));
+    auto *second = static_cast<char *>(arena.allocate(8, 8));
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(second) % 8);
+    ASSERT_GE(second, first + 10);
+    ASSERT_LT(second, first + 10 + 8);
+    ASSERT_EQ(1, arena.blockCount());
+
+    // 当前块放不下时使用新块，大于一块的分配单独申请
+    ASSERT_NE(nullptr, arena.allocate(1000, 1));
+    ASSERT_EQ(2, arena.blockCount());
+    void *large = arena.allocate(4096, 16);
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(large) % 16);
+    ASSERT_EQ(2, arena.blockCount());
+    size_t upstream = pool.upstreamAllocations();
+
+    // 重置后从第一块重新开始，不再向上游申请
+    arena.reset();
+    ASSERT_EQ(first, arena.allocate(10, 1));
+    ASSERT_NE(nullptr, arena.allocate(1000, 1));
+    ASSERT_EQ(2, arena.blockCount());
+    ASSERT_EQ(upstream, pool.upstreamAllocations());
+
+    // 释放后内存块回到缓冲区池，供其他区域使用
+    arena.release();
+    ASSERT_EQ(0, arena.blockCount());
+    ASSERT_EQ(2 * 1024 + BufferPool::blockSize(4096 + 16 + 16), pool.cachedBytes());
+    Arena other(&pool, 1024);
+    ASSERT_NE(nullptr, other.allocate(1000, 1));
+    ASSERT_NE(nullptr, other.allocate(1000, 1));
+    ASSERT_EQ(upstream, pool.upstreamAllocations());
+}
+
+TEST(ArenaTest, PooledObjects) {
+    BufferPool pool;
+    PooledPtr<std::pmr::string> text = makePooled<std::pmr::string>(&pool, REQUEST);
+    ASSERT_EQ(REQUEST, std::string_view(*text));
+    ASSERT_EQ(&pool, text->get_allocator().resource()); // 成员也从同一内存资源分配
+    text.reset();
+    ASSERT_GT(pool.cachedBytes(), 0);
+}
+
+TEST(ArenaTest, RequestsDoNotAllocateInSteadyState) {
+    BufferPool pool;
+    Arena arena(&pool);
+    auto handle = [&arena]() {
+        arena.reset();
+        HttpRequest request = HttpHandler::resolveRequest(REQUEST, &arena);
+        EXPECT_EQ("/images/background.jpg", request.url);
+        EXPECT_EQ("gzip, deflate, br", request.headers.get("Accept-Encoding"));
+
+        HttpHeaders headers(&arena);
+        headers.put("Content-Type", "image/jpeg");
+        headers.put("Connection", request.headers.get("Connection"));
+        HttpResponse response(request.version, "200", "OK", std::move(headers), "<binary>", &arena);
+        std::pmr::string bytes = HttpHandler::serializeResponse(response, &arena);
+        EXPECT_EQ(0, bytes.rfind("HTTP/1.1 200 OK\r\n", 0));
+        EXPECT_NE(std::string::npos, bytes.find("\r\nContent-Length: 8\r\n\r\n<binary>"));
+    };
+
+    // 预热：内存区域申请到足够的内存块之后，每个请求只在区域中分配
+    handle();
+    AllocationCounter allocations;
+    size_t upstream = pool.upstreamAllocations();
+    for (int i = 0; i < 100; ++i) {
+        handle();
+    }
+    ASSERT_EQ(0, allocations.count());
+    ASSERT_EQ(upstream, pool.upstreamAllocations());
+}
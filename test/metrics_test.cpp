@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <src/metrics.hpp>
+#include <thread>
+#include <vector>
+
+TEST(MetricsTest, CounterAndGauge) {
+    Counter counter;
+    Gauge gauge;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&]() {
+            for (int j = 0; j < 10000; ++j) {
+                counter.add();
+                gauge.add(2);
+                gauge.sub();
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    ASSERT_EQ(40000, counter.value());
+    ASSERT_EQ(40000, gauge.value());
+
+    // 增减可以发生在不同的线程上
+    std::thread([&gauge]() { gauge.sub(40000); }).join();
+    ASSERT_EQ(0, gauge.value());
+}
+
+TEST(MetricsTest, LatencyHistogram) {
+    LatencyHistogram histogram;
+    histogram.observe(std::chrono::nanoseconds(500));
+    histogram.observe(std::chrono::microseconds(3));
+    histogram.observe(std::chrono::milliseconds(2));
+    histogram.observe(std::chrono::nanoseconds(-1)); // 按 0 记录
+    histogram.observe(std::chrono::hours(1)); // 超出范围按最大值记录
+
+    LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+    ASSERT_EQ(5, snapshot.count);
+    ASSERT_EQ(2, snapshot.countBelow(1024));
+    ASSERT_EQ(3, snapshot.countBelow(4096));
+    ASSERT_EQ(4, snapshot.countBelow(uint64_t(1) << 22));
+    ASSERT_EQ(4, snapshot.countBelow(LatencyHistogram::HIGHEST_NANOS));
+    ASSERT_EQ(500 + 3000 + 2000000 + LatencyHistogram::HIGHEST_NANOS, snapshot.sumNanos);
+}
+
+TEST(MetricsTest, Render) {
+    MetricsRegistry registry;
+    registry.counter("requests_total", "Requests", "code=\"200\"").add(3);
+    registry.counter("requests_total", "Requests", "code=\"404\"").add();
+    registry.gauge("active", "Active").add(2);
+    registry.callback("ratio", "Ratio", "gauge", []() { return 0.5; });
+    registry.histogram("latency_seconds", "Latency", "stage=\"parse\"").observe(std::chrono::microseconds(2));
+
+    std::string text = registry.render();
+    // 同名指标只输出一次 HELP 与 TYPE
+    ASSERT_NE(std::string::npos, text.find("# HELP requests_total Requests\n"
+                                           "# TYPE requests_total counter\n"
+                                           "requests_total{code=\"200\"} 3\n"
+                                           "requests_total{code=\"404\"} 1\n"));
+    ASSERT_NE(std::string::npos, text.find("# TYPE active gauge\nactive 2\n"));
+    ASSERT_NE(std::string::npos, text.find("ratio 0.5\n"));
+    ASSERT_NE(std::string::npos, text.find("# TYPE latency_seconds histogram\n"));
+    // 累计桶：2 微秒落在 (1.024us, 4.096us] 之间
+    ASSERT_NE(std::string::npos, text.find("latency_seconds_bucket{stage=\"parse\",le=\"1.024e-06\"} 0\n"));
+    ASSERT_NE(std::string::npos, text.find("latency_seconds_bucket{stage=\"parse\",le=\"4.096e-06\"} 1\n"));
+    ASSERT_NE(std::string::npos, text.find("latency_seconds_bucket{stage=\"parse\",le=\"+Inf\"} 1\n"));
+    ASSERT_NE(std::string::npos, text.find("latency_seconds_sum{stage=\"parse\"} 2e-06\n"));
+    ASSERT_NE(std::string::npos, text.find("latency_seconds_count{stage=\"parse\"} 1\n"));
+}
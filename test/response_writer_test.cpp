@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <src/response_writer.hpp>
+
+TEST(ResponseWriterTest, BasicAssertions) {
+    std::string buffer = "stale data";
+    std::string_view head = ResponseWriter(buffer)
+            .status(HttpStatus::NOT_FOUND)
+            .connection(false)
+            .header(HttpHeader::CONTENT_LENGTH, size_t(157))
+            .header("X-Custom", "1")
+            .fields("Content-Type: text/html\r\n")
+            .end();
+    ASSERT_EQ("HTTP/1.1 404 Not Found\r\nConnection: close\r\nContent-Length: 157\r\nX-Custom: 1\r\n"
+              "Content-Type: text/html\r\n\r\n", head);
+
+    // 缓冲区被循环使用：清空后容量保留
+    size_t capacity = buffer.capacity();
+    ResponseWriter(buffer).status("HTTP/1.0", "200", "OK").end();
+    ASSERT_EQ("HTTP/1.0 200 OK\r\n\r\n", buffer);
+    ASSERT_EQ(capacity, buffer.capacity());
+}
+
+TEST(HttpStringsTest, BasicAssertions) {
+    static_assert(HttpStrings::statusLine(HttpStatus::OK) == "HTTP/1.1 200 OK\r\n");
+    static_assert(HttpStrings::headerPrefix(HttpHeader::RETRY_AFTER) == "Retry-After: ");
+    static_assert(HttpStrings::headerPrefix(HttpHeader::ALLOW) == "Allow: ");
+    static_assert(HttpStrings::statusCode(HttpStatus::METHOD_NOT_ALLOWED) == "405");
+    ASSERT_EQ("HTTP/1.1 503 Service Unavailable\r\n", HttpStrings::statusLine(HttpStatus::SERVICE_UNAVAILABLE));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+TEST(ResponseWriterTest, DateHeader) {
+    std::string buffer;
+    std::string_view head = ResponseWriter(buffer).status(HttpStatus::OK).date().end();
+    ASSERT_EQ(0, head.find("HTTP/1.1 200 OK\r\nDate: "));
+    // IMF-fixdate 固定 29 个字符
+    ASSERT_EQ(std::string_view("HTTP/1.1 200 OK\r\n").size() + 6 + 29 + 4, head.size());
+    ASSERT_EQ(" GMT\r\n\r\n", head.substr(head.size() - 8));
+}
+
+TEST(ResponseWriterTest, ContentRange) {
+    std::string buffer;
+    std::string_view head = ResponseWriter(buffer)
+            .status(HttpStatus::PARTIAL_CONTENT)
+            .contentRange(0, 499, 1234)
+            .end();
+    ASSERT_EQ("HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 0-499/1234\r\n\r\n", head);
+    head = ResponseWriter(buffer).status(HttpStatus::RANGE_NOT_SATISFIABLE).contentRange(1234).end();
+    ASSERT_EQ("HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */1234\r\n\r\n", head);
+}
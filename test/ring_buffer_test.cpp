@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <src/ring_buffer.hpp>
+#include <thread>
+#include <vector>
+
+TEST(RingBufferTest, BasicAssertions) {
+    RingBuffer<int> buffer(3);
+    ASSERT_EQ(4, buffer.capacity()); // 向上取整为 2 的幂
+    ASSERT_TRUE(buffer.empty());
+
+    for (int i = 0; i < 4; ++i) {
+        int value = i;
+        ASSERT_TRUE(buffer.tryPush(std::move(value)));
+    }
+    int overflow = 4;
+    ASSERT_FALSE(buffer.tryPush(std::move(overflow)));
+    ASSERT_EQ(4, buffer.size());
+
+    int value;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(buffer.tryPop(value));
+        ASSERT_EQ(i, value);
+    }
+    ASSERT_FALSE(buffer.tryPop(value));
+    ASSERT_EQ(4, buffer.pushed());
+    ASSERT_EQ(4, buffer.popped());
+}
+
+TEST(RingBufferTest, MoveOnlyValues) {
+    RingBuffer<std::unique_ptr<int>> buffer(2);
+    ASSERT_TRUE(buffer.tryPush(std::make_unique<int>(1)));
+    std::unique_ptr<int> value;
+    ASSERT_TRUE(buffer.tryPop(value));
+    ASSERT_EQ(1, *value);
+}
+
+TEST(RingBufferTest, MultipleProducers) {
+    // 多个生产者并发写入，单个消费者读出：每个生产者的数据都完整且保持各自的顺序
+    RingBuffer<uint64_t> buffer(64);
+    const uint64_t producers = 4, perProducer = 20000;
+    std::vector<std::thread> threads;
+    for (uint64_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&buffer, p]() {
+            for (uint64_t i = 0; i < perProducer; ++i) {
+                uint64_t value = (p << 32) | i;
+                while (!buffer.tryPush(std::move(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint64_t> next(producers, 0);
+    uint64_t value;
+    for (uint64_t received = 0; received < producers * perProducer;) {
+        if (!buffer.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint64_t p = value >> 32;
+        ASSERT_EQ(next[p], value & 0xffffffff);
+        ++next[p];
+        ++received;
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    ASSERT_TRUE(buffer.empty());
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <src/router.hpp>
+#include <string>
+
+/**
+ * 以处理器的名字作为处理器，便于检查匹配到的是哪条路由
+ */
+class RouterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        router.route("/", "index")
+                .route("/metrics", "metrics")
+                .route("/news/latest", "latest")
+                .route("/news/{id}", "news")
+                .route("/news/{id}/comments/{comment}", "comment")
+                .route("/news/hot/{rank}", "hot")
+                .route("/users/{name}/", "user")
+                .mount("/", "statics")
+                .mount("/images", "images")
+                .mount("/news/archive/", "archive");
+        router.compile();
+    }
+
+    /**
+     * 匹配到的处理器的名字，没有匹配时为空
+     */
+    std::string match(std::string_view url) {
+        const std::string *handler = router.match(url, params);
+        return handler ? *handler : "";
+    }
+
+    Router<std::string> router;
+
+    RouteParams params;
+};
+
+TEST_F(RouterTest, ExactRoutes) {
+    ASSERT_EQ("index", match("/"));
+    ASSERT_EQ("metrics", match("/metrics"));
+    ASSERT_EQ("metrics", match("/metrics?format=text"));
+    ASSERT_EQ("metrics", match("/metrics#top"));
+    ASSERT_EQ(0, params.size());
+    ASSERT_EQ("statics", match("/metrics/")); // 按完整路径比较
+    ASSERT_EQ("statics", match("/Metrics"));
+}
+
+TEST_F(RouterTest, ParameterizedRoutes) {
+    ASSERT_EQ("news", match("/news/12?from=index"));
+    ASSERT_EQ(1, params.size());
+    ASSERT_EQ("12", params.get("id"));
+    ASSERT_EQ("", params.get("comment"));
+
+    ASSERT_EQ("latest", match("/news/latest")); // 字面量段优先
+    ASSERT_EQ(0, params.size());
+
+    ASSERT_EQ("comment", match("/news/7/comments/3"));
+    ASSERT_EQ(2, params.size());
+    ASSERT_EQ("7", params.get("id"));
+    ASSERT_EQ("3", params.get("comment"));
+
+    ASSERT_EQ("hot", match("/news/hot/1"));
+    ASSERT_EQ(1, params.size());
+    ASSERT_EQ("1", params.get("rank"));
+    ASSERT_EQ("comment", match("/news/hot/comments/5")); // 字面量段之后不匹配时回溯到参数段
+    ASSERT_EQ(2, params.size());
+    ASSERT_EQ("hot", params.get("id"));
+    ASSERT_EQ("", params.get("rank"));
+
+    ASSERT_EQ("news", match("/news/%31")); // 参数值不解码
+    ASSERT_EQ("%31", params.get("id"));
+
+    ASSERT_EQ("user", match("/users/alice/"));
+    ASSERT_EQ("alice", params.get("name"));
+    ASSERT_EQ("statics", match("/users/alice")); // 末尾的 '/' 也是一段
+    ASSERT_EQ("statics", match("/news//comments/3")); // 参数不能为空
+}
+
+TEST_F(RouterTest, Mounts) {
+    ASSERT_EQ("images", match("/images/news1.jpg"));
+    ASSERT_EQ("/news1.jpg", params.rest());
+    ASSERT_EQ("images", match("/images"));
+    ASSERT_EQ("", params.rest());
+    ASSERT_EQ("statics", match("/imagesX/a.jpg")); // 挂载点按整段比较
+    ASSERT_EQ("/imagesX/a.jpg", params.rest());
+
+    ASSERT_EQ("archive", match("/news/archive/2022/05.html?page=2"));
+    ASSERT_EQ("/2022/05.html", params.rest());
+    ASSERT_EQ(0, params.size());
+    ASSERT_EQ("statics", match("/news/1/other")); // 参数化路由不匹配时交给最长的挂载点
+    ASSERT_EQ(0, params.size());
+    ASSERT_EQ("/news/1/other", params.rest());
+
+    ASSERT_EQ("", match("*"));
+    ASSERT_EQ("", match("http://example.com/"));
+    ASSERT_EQ("", match(""));
+}
+
+TEST(RouterRegistrationTest, RejectInvalidRoutes) {
+    Router<int> router;
+    router.route("/news/{id}", 1).mount("/static", 2);
+    ASSERT_THROW(router.route("news", 0), std::invalid_argument);
+    ASSERT_THROW(router.route("/news/{}", 0), std::invalid_argument);
+    ASSERT_THROW(router.route("/news/{id}.html", 0), std::invalid_argument);
+    ASSERT_THROW(router.route("/news/{slug}/edit", 0), std::invalid_argument);
+    ASSERT_THROW(router.route("/news/{id}", 0), std::invalid_argument);
+    ASSERT_THROW(router.route("/a?b", 0), std::invalid_argument);
+    ASSERT_THROW(router.mount("/static/", 0), std::invalid_argument);
+    ASSERT_THROW(router.mount("/users/{name}", 0), std::invalid_argument);
+
+    router.route("/only", 3);
+    ASSERT_THROW(router.route("/only", 0), std::invalid_argument);
+    std::string tooMany;
+    for (size_t i = 0; i <= RouteParams::MAX_PARAMS; ++i) {
+        tooMany += "/{p" + std::to_string(i) + "}";
+    }
+    ASSERT_THROW(router.route(tooMany, 0), std::invalid_argument);
+}
+
+TEST(RouterRegistrationTest, ManyExactRoutes) {
+    Router<int> router;
+    for (int i = 0; i < 1000; ++i) {
+        router.route("/page/" + std::to_string(i), i);
+    }
+    router.mount("/", -1);
+    router.compile();
+
+    RouteParams params;
+    for (int i = 0; i < 1000; ++i) {
+        const int *handler = router.match("/page/" + std::to_string(i), params);
+        ASSERT_NE(nullptr, handler);
+        ASSERT_EQ(i, *handler);
+    }
+    ASSERT_EQ(-1, *router.match("/page/1000", params));
+    ASSERT_EQ(-1, *router.match("/page/", params));
+
+    // 未重新编译之前，新注册的精确路由不参与匹配
+    router.route("/late", 7);
+    ASSERT_EQ(-1, *router.match("/late", params));
+    router.compile();
+    ASSERT_EQ(7, *router.match("/late", params));
+}
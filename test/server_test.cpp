@@ -0,0 +1,669 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <src/server.hpp>
+#include <test/allocation_counter.hpp>
+#include <thread>
+#include <vector>
+
+class ServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char pattern[] = "/tmp/server_test_XXXXXX";
+        root = std::string(mkdtemp(pattern)) + "/";
+        std::ofstream(root + "index.html") << "<html>index</html>";
+        std::ofstream(root + "404.html") << "<html>404</html>";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(root);
+    }
+
+    static Logger quietLogger() {
+        auto formatter = std::make_shared<LogFormatter>(LogLevel::ERROR);
+        return {LogLevel::ERROR, std::make_shared<TerminalLogAppender>(formatter, LogLevel::ERROR)};
+    }
+
+    /**
+     * 连接到本机端口，失败时返回 -1
+     */
+    static int connectTo(int port) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = inet_addr("127.0.0.1");
+        if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    /**
+     * 在持久连接上发送请求并读取一个完整的响应（按 Content-Length 划分）
+     */
+    static std::string exchange(int fd, const std::string &raw) {
+        send(fd, raw.data(), raw.size(), MSG_NOSIGNAL);
+        std::string response;
+        char buf[4096];
+        size_t headEnd = std::string::npos;
+        size_t total = std::string::npos;
+        while (response.size() != total) {
+            ssize_t len = recv(fd, buf, sizeof(buf), 0);
+            if (len <= 0)
+                break;
+            response.append(buf, len);
+            if (headEnd == std::string::npos && (headEnd = response.find("\r\n\r\n")) != std::string::npos) {
+                size_t length = response.find("Content-Length: ");
+                total = headEnd + 4 + std::stoul(response.substr(length + 16));
+            }
+        }
+        return response;
+    }
+
+    /**
+     * 发送请求并读取到对端关闭为止
+     */
+    static std::string request(int port, const std::string &raw) {
+        int fd = connectTo(port);
+        if (fd < 0)
+            return {};
+        send(fd, raw.data(), raw.size(), MSG_NOSIGNAL);
+        std::string response;
+        char buf[4096];
+        ssize_t len;
+        while ((len = recv(fd, buf, sizeof(buf), 0)) > 0) {
+            response.append(buf, len);
+        }
+        close(fd);
+        return response;
+    }
+
+    std::string root;
+};
+
+TEST_F(ServerTest, ThreadPoolMode) {
+    ServerOptions options;
+    options.staticRoot = root;
+    options.tcpNoDelay = true;
+    Server server("127.0.0.1", 18431, quietLogger(), options);
+    std::thread thread([&server]() { server.setup(); });
+
+    std::string response = request(18431, "GET / HTTP/1.1\r\nConnection: close\r\n\r\n");
+    ASSERT_EQ(0, response.rfind("HTTP/1.1 200 OK\r\n", 0));
+    ASSERT_NE(std::string::npos, response.find("\r\n\r\n<html>index</html>"));
+    ASSERT_NE(std::string::npos, response.find("\r\nDate: "));
+
+    std::string metrics = request(18431, "GET /metrics HTTP/1.1\r\nConnection: close\r\n\r\n");
+    ASSERT_EQ(0, metrics.rfind("HTTP/1.1 200 OK\r\n", 0));
+    ASSERT_NE(std::string::npos, metrics.find("Content-Type: text/plain; version=0.0.4"));
+    ASSERT_NE(std::string::npos, metrics.find("\nwebserver_connections_accepted_total 2\n"));
+    ASSERT_NE(std::string::npos, metrics.find("\nwebserver_responses_total{code=\"200\"} 2\n"));
+    ASSERT_NE(std::string::npos, metrics.find("\nwebserver_asset_cache_misses_total 1\n"));
+    ASSERT_NE(std::string::npos, metrics.find("webserver_stage_duration_seconds_count{stage=\"handle\"} 1\n"));
+    ASSERT_NE(std::string::npos, metrics.find("webserver_thread_pool_task_wait_seconds_count 2\n"));
+
+    server.shutdown();
+    thread.join();
+}
+
+TEST_F(ServerTest, ReusePortEventLoops) {
+    ServerOptions options;
+    options.staticRoot = root;
+    options.eventLoops = 2;
+    options.handleInLoop = true;
+    options.deferAcceptSeconds = 1;
+    options.backlog = 128;
+    Server server("127.0.0.1", 18432, quietLogger(), options);
+    std::thread thread([&server]() { server.setup(); });
+
+    // 流水线中的多个请求在事件循环线程中依次处理
+    std::string response = request(18432, "GET /index.html HTTP/1.1\r\n\r\n"
+                                          "GET /missing HTTP/1.1\r\nConnection: close\r\n\r\n");
+    ASSERT_EQ(0, response.rfind("HTTP/1.1 200 OK\r\n", 0));
+    ASSERT_NE(std::string::npos, response.find("HTTP/1.1 404 Not Found\r\n"));
+    ASSERT_NE(std::string::npos, response.find("<html>404</html>"));
+
+    // 内核按四元组哈希分配连接，足够多的连接会落到每个事件循环上
+    for (int i = 0; i < 64; ++i) {
+        ASSERT_NE(std::string::npos, request(18432, "GET / HTTP/1.1\r\nConnection: close\r\n\r\n").find("index"));
+    }
+    std::vector<size_t> accepted = server.acceptedConnections();
+    ASSERT_EQ(2, accepted.size());
+    ASSERT_EQ(65, accepted[0] + accepted[1]);
+    ASSERT_GT(accepted[0], 0);
+    ASSERT_GT(accepted[1], 0);
+
+    server.shutdown();
+    thread.join();
+}
+
+TEST_F(ServerTest, IoUringBackend) {
+    // 大于分块大小的文件需要多次读取与发送
+    std::string large(300 * 1024, 'x');
+    for (size_t i = 0; i < large.size(); i += 1000) {
+        large[i] = static_cast<char>('a' + i / 1000 % 26);
+    }
+    std::ofstream(root + "large.txt") << large;
+
+    ServerOptions options;
+    options.staticRoot = root;
+    options.ioBackend = IoBackend::IO_URING; // 内核不支持时退回 epoll，行为相同
+    options.sendfileThreshold = 64 * 1024;
+    options.handleInLoop = true;
+    Server server("127.0.0.1", 18433, quietLogger(), options);
+    std::thread thread([&server]() { server.setup(); });
+
+    std::string response = request(18433, "GET /index.html HTTP/1.1\r\n\r\n"
+                                          "GET /large.txt HTTP/1.1\r\n\r\n"
+                                          "GET /missing HTTP/1.1\r\nConnection: close\r\n\r\n");
+    ASSERT_EQ(0, response.rfind("HTTP/1.1 200 OK\r\n", 0));
+    ASSERT_NE(std::string::npos, response.find("<html>index</html>HTTP/1.1 200 OK\r\n"));
+    ASSERT_NE(std::string::npos, response.find("\r\n\r\n" + large + "HTTP/1.1 404 Not Found\r\n"));
+    ASSERT_EQ(response.size() - std::string("<html>404</html>").size(), response.rfind("<html>404</html>"));
+
+    for (int i = 0; i < 16; ++i) {
+        ASSERT_NE(std::string::npos, request(18433, "GET / HTTP/1.1\r\nConnection: close\r\n\r\n").find("index"));
+    }
+    ASSERT_EQ(0, request(18433, "BAD\r\n\r\n").rfind("HTTP/1.1 400 Bad Request\r\n", 0));
+
+    std::string metrics = request(18433, "GET /metrics HTTP/1.1\r\nConnection: close\r\n\r\n");
+    ASSERT_NE(std::string::npos, metrics.find("\nwebserver_connections_accepted_total 19\n"));
+    ASSERT_NE(std::string::npos, metrics.find("\nwebserver_parse_errors_total 1\n"));
+
+    server.shutdown();
+    thread.join();
+}
+
+TEST_F(ServerTest, IdleKeepAliveConnectionsAreClosed) {
+    int port = 18434;
+    for (IoBackend backend: {IoBackend::EPOLL, IoBackend::IO_URING}) {
+        ServerOptions options;
+        options.staticRoot = root;
+        options.keepAliveTimeoutSeconds = 1;
+        options.ioBackend = backend;
+        Server server("127.0.0.1", port, quietLogger(), options);
+        std::thread thread([&server]() { server.setup(); });
+
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = inet_addr("127.0.0.1");
+        ASSERT_EQ(0, connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)));
+        std::string raw = "GET / HTTP/1.1\r\n\r\n";
+        send(fd, raw.data(), raw.size(), MSG_NOSIGNAL);
+
+        // 响应之后连接保持打开，空闲超过超时后由服务器关闭
+        auto start = std::chrono::steady_clock::now();
+        std::string response;
+        char buf[4096];
+        ssize_t len;
+        while ((len = recv(fd, buf, sizeof(buf), 0)) > 0) {
+            response.append(buf, len);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        close(fd);
+        ASSERT_EQ(0, response.rfind("HTTP/1.1 200 OK\r\n", 0));
+        ASSERT_NE(std::string::npos, response.find("Connection: keep-alive"));
+        ASSERT_GE(elapsed, std::chrono::seconds(1));
+        ASSERT_LT(elapsed, std::chrono::seconds(5));
+
+        server.shutdown();
+        thread.join();
+        ++port;
+    }
+}
+
+TEST_F(ServerTest, SteadyStateRequestsDoNotAllocate) {
+    AllocationCounter::Uncounted client; // 测试线程作为客户端，只统计服务器线程的分配
+    int port = 18436;
+    for (IoBackend backend: {IoBackend::EPOLL, IoBackend::IO_URING}) {
+        for (bool handleInLoop: {true, false}) {
+            ServerOptions options;
+            options.staticRoot = root;
+            options.ioBackend = backend;
+            options.handleInLoop = handleInLoop;
+            options.maxKeepAliveRequests = 1000000;
+            Server server("127.0.0.1", port, quietLogger(), options);
+            std::thread thread([&server]() { server.setup(); });
+
+            int fd = connectTo(port);
+            ASSERT_GE(fd, 0);
+            auto keepAlive = [fd](int count) {
+                for (int i = 0; i < count; ++i) {
+                    std::string response = exchange(fd, "GET /index.html HTTP/1.1\r\nHost: localhost\r\n\r\n");
+                    ASSERT_NE(std::string::npos, response.find("\r\n\r\n<html>index</html>"));
+                }
+            };
+            auto shortLived = [port](int count) {
+                for (int i = 0; i < count; ++i) {
+                    std::string response = request(port, "GET /missing HTTP/1.1\r\nConnection: close\r\n\r\n");
+                    ASSERT_NE(std::string::npos, response.find("<html>404</html>"));
+                }
+            };
+
+            // 预热：缓冲区、协程帧与连接对象都分配过之后循环使用，持久连接上的请求与新连接都不再分配堆内存。
+            // 服务器处理上一个短连接的关闭时可能已经接受了下一个连接，先让几个连接同时存在，池中才有足够的空闲对象
+            keepAlive(100);
+            std::vector<int> concurrent;
+            for (int i = 0; i < 4; ++i) {
+                concurrent.push_back(connectTo(port));
+                exchange(concurrent.back(), "GET /index.html HTTP/1.1\r\nHost: localhost\r\n\r\n");
+            }
+            for (int other: concurrent) {
+                close(other);
+            }
+            shortLived(20);
+            AllocationCounter allocations;
+            keepAlive(1000);
+            shortLived(100);
+            EXPECT_EQ(0, allocations.count()) << "backend " << static_cast<int>(backend)
+                                                        << ", handleInLoop " << handleInLoop;
+
+            close(fd);
+            server.shutdown();
+            thread.join();
+            ++port;
+        }
+    }
+}
+
+TEST_F(ServerTest, ContentEncodingNegotiation) {
+    std::ofstream(root + "style.css") << "body{}";
+    std::ofstream(root + "style.css.br") << "br bytes";
+    std::string page;
+    for (int i = 0; i < 200; ++i) {
+        page += "<p>news item " + std::to_string(i) + "</p>\n";
+    }
+    std::ofstream(root + "news1.html") << page;
+
+    ServerOptions options;
+    options.staticRoot = root;
+    Server server("127.0.0.1", 18440, quietLogger(), options);
+    std::thread thread([&server]() { server.setup(); });
+
+    // 预压缩文件
+    std::string response = request(18440, "GET /style.css HTTP/1.1\r\nAccept-Encoding: gzip, br\r\n"
+                                          "Connection: close\r\n\r\n");
+    ASSERT_NE(std::string::npos, response.find("\r\nContent-Encoding: br\r\nVary: Accept-Encoding\r\n"));
+    ASSERT_NE(std::string::npos, response.find("\r\n\r\nbr bytes"));
+    response = request(18440, "GET /style.css HTTP/1.1\r\nConnection: close\r\n\r\n");
+    ASSERT_EQ(std::string::npos, response.find("Content-Encoding"));
+    ASSERT_NE(std::string::npos, response.find("\r\nVary: Accept-Encoding\r\n"));
+    ASSERT_NE(std::string::npos, response.find("\r\n\r\nbody{}"));
+
+    // 在线程池中压缩，完成之前返回原始内容
+    if (ContentCoding::canCompress(ContentEncoding::GZIP)) {
+        bool isCompressed = false;
+        for (int i = 0; i < 200 && !isCompressed; ++i) {
+            response = request(18440, "GET /news1.html HTTP/1.1\r\nAccept-Encoding: gzip\r\nConnection: close\r\n\r\n");
+            ASSERT_NE(std::string::npos, response.find("\r\nVary: Accept-Encoding\r\n"));
+            isCompressed = response.find("\r\nContent-Encoding: gzip\r\n") != std::string::npos;
+            if (!isCompressed)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_TRUE(isCompressed);
+        ASSERT_LT(response.size(), page.size());
+    }
+
+    server.shutdown();
+    thread.join();
+}
+
+TEST_F(ServerTest, SlowClientsAreTimedOut) {
+    std::ofstream(root + "large.bin") << std::string(32 * 1024 * 1024, 'x');
+    int port = 18441;
+    for (IoBackend backend: {IoBackend::EPOLL, IoBackend::IO_URING}) {
+        ServerOptions options;
+        options.staticRoot = root;
+        options.requestTimeoutSeconds = 1;
+        options.writeTimeoutSeconds = 1;
+        options.ioBackend = backend;
+        Server server("127.0.0.1", port, quietLogger(), options);
+        std::thread thread([&server]() { server.setup(); });
+
+        // 请求头始终没有发送完整
+        int fd = connectTo(port);
+        ASSERT_GE(fd, 0);
+        std::string raw = "GET / HTTP/1.1\r\nHost: ";
+        send(fd, raw.data(), raw.size(), MSG_NOSIGNAL);
+        auto start = std::chrono::steady_clock::now();
+        char buf[4096];
+        ASSERT_EQ(0, recv(fd, buf, sizeof(buf), 0));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        close(fd);
+        ASSERT_GE(elapsed, std::chrono::milliseconds(900));
+        ASSERT_LT(elapsed, std::chrono::seconds(5));
+
+        // 客户端不读取响应，发送没有进展
+        fd = connectTo(port);
+        ASSERT_GE(fd, 0);
+        raw = "GET /large.bin HTTP/1.1\r\n\r\n";
+        send(fd, raw.data(), raw.size(), MSG_NOSIGNAL);
+        std::string metrics;
+        for (int i = 0; i < 100; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            metrics = request(port, "GET /metrics HTTP/1.1\r\nConnection: close\r\n\r\n");
+            if (metrics.find("{kind=\"write\"} 1\n") != std::string::npos)
+                break;
+        }
+        close(fd);
+        ASSERT_NE(std::string::npos, metrics.find("\nwebserver_connection_timeouts_total{kind=\"request\"} 1\n"));
+        ASSERT_NE(std::string::npos, metrics.find("\nwebserver_connection_timeouts_total{kind=\"write\"} 1\n"));
+        ASSERT_NE(std::string::npos, metrics.find("\nwebserver_connection_timeouts_total{kind=\"idle\"} 0\n"));
+
+        server.shutdown();
+        thread.join();
+        ++port;
+    }
+}
+
+TEST_F(ServerTest, ConditionalAndRangeRequests) {
+    std::string image;
+    for (int i = 0; i < 4096; ++i) {
+        image += static_cast<char>('a' + i % 26);
+    }
+    std::ofstream(root + "image.png") << image;
+    std::ofstream(root + "note.txt") << image.substr(0, 100);
+
+    int port = 18443;
+    for (IoBackend backend: {IoBackend::EPOLL, IoBackend::IO_URING}) {
+        ServerOptions options;
+        options.staticRoot = root;
+        options.sendfileThreshold = 1024; // image.png 通过 sendfile 发送，note.txt 在内存中
+        options.ioBackend = backend;
+        Server server("127.0.0.1", port, quietLogger(), options);
+        std::thread thread([&server]() { server.setup(); });
+
+        auto get = [port](const std::string &path, const std::string &headers) {
+            return request(port, "GET " + path + " HTTP/1.1\r\n" + headers + "Connection: close\r\n\r\n");
+        };
+        auto field = [](const std::string &response, const std::string &name) {
+            size_t start = response.find("\r\n" + name + ": ");
+            if (start == std::string::npos)
+                return std::string();
+            start += name.size() + 4;
+            return response.substr(start, response.find("\r\n", start) - start);
+        };
+        auto body = [](const std::string &response) { return response.substr(response.find("\r\n\r\n") + 4); };
+
+        for (const std::string path: {"/image.png", "/note.txt"}) {
+            size_t size = path == "/image.png" ? 4096 : 100;
+            std::string response = get(path, "");
+            ASSERT_EQ(0, response.rfind("HTTP/1.1 200 OK\r\n", 0));
+            ASSERT_EQ("bytes", field(response, "Accept-Ranges"));
+            std::string etag = field(response, "ETag");
+            std::string lastModified = field(response, "Last-Modified");
+            ASSERT_FALSE(etag.empty());
+            ASSERT_FALSE(lastModified.empty());
+
+            // 客户端的副本仍是最新的
+            response = get(path, "If-None-Match: " + etag + "\r\n");
+            ASSERT_EQ(0, response.rfind("HTTP/1.1 304 Not Modified\r\n", 0));
+            ASSERT_EQ(etag, field(response, "ETag"));
+            ASSERT_EQ("", body(response));
+            response = get(path, "If-Modified-Since: " + lastModified + "\r\n");
+            ASSERT_EQ(0, response.rfind("HTTP/1.1 304 Not Modified\r\n", 0));
+            response = get(path, "If-None-Match: \"stale\"\r\n");
+            ASSERT_EQ(0, response.rfind("HTTP/1.1 200 OK\r\n", 0));
+            ASSERT_EQ(image.substr(0, size), body(response));
+
+            // 单段范围
+            response = get(path, "Range: bytes=10-49\r\nIf-Range: " + etag + "\r\n");
+            ASSERT_EQ(0, response.rfind("HTTP/1.1 206 Partial Content\r\n", 0));
+            ASSERT_EQ("bytes 10-49/" + std::to_string(size), field(response, "Content-Range"));
+            ASSERT_EQ("40", field(response, "Content-Length"));
+            ASSERT_EQ(image.substr(10, 40), body(response));
+            response = get(path, "Range: bytes=10-49\r\nIf-Range: \"stale\"\r\n");
+            ASSERT_EQ(0, response.rfind("HTTP/1.1 200 OK\r\n", 0));
+
+            // 多段范围
+            response = get(path, "Range: bytes=0-4, -5\r\n");
+            ASSERT_EQ(0, response.rfind("HTTP/1.1 206 Partial Content\r\n", 0));
+            std::string type = field(response, "Content-Type");
+            ASSERT_EQ(0, type.rfind("multipart/byteranges; boundary=", 0));
+            std::string boundary = type.substr(type.find('=') + 1);
+            std::string multipart = body(response);
+            ASSERT_EQ(std::to_string(multipart.size()), field(response, "Content-Length"));
+            std::string contentType = path == "/image.png" ? "image/png" : "text/plain; charset=utf-8";
+            std::string expected = "--" + boundary + "\r\nContent-Type: " + contentType +
+                                   "\r\nContent-Range: bytes 0-4/" + std::to_string(size) + "\r\n\r\n" +
+                                   image.substr(0, 5);
+            ASSERT_EQ(0, multipart.rfind(expected, 0));
+            ASSERT_NE(std::string::npos, multipart.find("Content-Range: bytes " + std::to_string(size - 5) + "-" +
+                                                        std::to_string(size - 1) + "/" + std::to_string(size) +
+                                                        "\r\n\r\n" + image.substr(size - 5, 5) + "\r\n--" + boundary +
+                                                        "--\r\n"));
+
+            // 超出资源
+            response = get(path, "Range: bytes=9999-\r\n");
+            ASSERT_EQ(0, response.rfind("HTTP/1.1 416 Range Not Satisfiable\r\n", 0));
+            ASSERT_EQ("bytes */" + std::to_string(size), field(response, "Content-Range"));
+        }
+
+        server.shutdown();
+        thread.join();
+        ++port;
+    }
+}
+
+TEST_F(ServerTest, AssetPackMode) {
+    std::ofstream(root + "style.css") << "body{}";
+    ServerOptions options;
+    options.staticRoot = root;
+    options.packAssetsOnStartup = true;
+    Server server("127.0.0.1", 18445, quietLogger(), options);
+    std::thread thread([&server]() { server.setup(); });
+
+    std::string response = request(18445, "GET /style.css HTTP/1.1\r\nConnection: close\r\n\r\n");
+    ASSERT_EQ(0, response.rfind("HTTP/1.1 200 OK\r\n", 0));
+    ASSERT_NE(std::string::npos, response.find("\r\n\r\nbody{}"));
+    size_t start = response.find("ETag: ") + 6;
+    std::string etag = response.substr(start, response.find("\r\n", start) - start);
+    response = request(18445, "GET /style.css HTTP/1.1\r\nIf-None-Match: " + etag + "\r\nConnection: close\r\n\r\n");
+    ASSERT_EQ(0, response.rfind("HTTP/1.1 304 Not Modified\r\n", 0));
+
+    // 资源包是启动时的快照，之后新增的文件不可见
+    std::ofstream(root + "later.html") << "later";
+    response = request(18445, "GET /later.html HTTP/1.1\r\nConnection: close\r\n\r\n");
+    ASSERT_EQ(0, response.rfind("HTTP/1.1 404 Not Found\r\n", 0));
+    ASSERT_NE(std::string::npos, response.find("\r\n\r\n<html>404</html>"));
+
+    server.shutdown();
+    thread.join();
+}
+
+TEST_F(ServerTest, RoutesAndNegativeLookups) {
+    ServerOptions options;
+    options.staticRoot = root;
+    options.metricsPath = "/stats";
+    Server server("127.0.0.1", 18446, quietLogger(), options);
+    std::thread thread([&server]() { server.setup(); });
+
+    int fd = connectTo(18446);
+    ASSERT_GE(fd, 0);
+    std::string response = exchange(fd, "GET /index?from=nav HTTP/1.1\r\n\r\n");
+    ASSERT_EQ(0, response.rfind("HTTP/1.1 200 OK\r\n", 0));
+    ASSERT_NE(std::string::npos, response.find("\r\n\r\n<html>index</html>"));
+    response = exchange(fd, "GET /stats HTTP/1.1\r\n\r\n");
+    ASSERT_EQ(0, response.rfind("HTTP/1.1 200 OK\r\n", 0));
+    response = exchange(fd, "GET /metrics HTTP/1.1\r\n\r\n"); // 不再是指标路径，交给静态资源目录
+    ASSERT_EQ(0, response.rfind("HTTP/1.1 404 Not Found\r\n", 0));
+
+    // 同一个连接由同一个分片处理：第二次请求不存在的路径时不再访问文件系统
+    for (int i = 0; i < 2; ++i) {
+        response = exchange(fd, "GET /robots.txt HTTP/1.1\r\n\r\n");
+        ASSERT_EQ(0, response.rfind("HTTP/1.1 404 Not Found\r\n", 0));
+        ASSERT_NE(std::string::npos, response.find("\r\n\r\n<html>404</html>"));
+    }
+    response = exchange(fd, "GET /stats HTTP/1.1\r\n\r\n");
+    ASSERT_NE(std::string::npos, response.find("\nwebserver_asset_cache_negative_hits_total 1\n"));
+    close(fd);
+
+    server.shutdown();
+    thread.join();
+}
+
+TEST_F(ServerTest, HeadAndUnsupportedMethods) {
+    std::string image(4096, 'x');
+    std::ofstream(root + "image.png") << image;
+    std::ofstream(root + "note.txt") << "note";
+
+    int port = 18449;
+    for (IoBackend backend: {IoBackend::EPOLL, IoBackend::IO_URING}) {
+        ServerOptions options;
+        options.staticRoot = root;
+        options.sendfileThreshold = 1024; // image.png 通过 sendfile 发送
+        options.ioBackend = backend;
+        Server server("127.0.0.1", port, quietLogger(), options);
+        std::thread thread([&server]() { server.setup(); });
+
+        // HEAD 的响应带着 GET 的 Content-Length 但没有响应体，同一连接上随后的响应紧接着响应头
+        for (const std::string path: {"/image.png", "/note.txt", "/missing"}) {
+            std::string response = request(port, "HEAD " + path + " HTTP/1.1\r\n\r\n"
+                                                  "GET /note.txt HTTP/1.1\r\nConnection: close\r\n\r\n");
+            size_t headEnd = response.find("\r\n\r\n");
+            ASSERT_NE(std::string::npos, headEnd) << path;
+            std::string head = response.substr(0, headEnd + 4);
+            std::string next = response.substr(headEnd + 4);
+            std::string length = path == "/image.png" ? "4096" : path == "/note.txt" ? "4" : "";
+            if (!length.empty()) {
+                EXPECT_EQ(0, head.rfind("HTTP/1.1 200 OK\r\n", 0)) << path;
+                EXPECT_NE(std::string::npos, head.find("\r\nContent-Length: " + length + "\r\n")) << path;
+            } else {
+                EXPECT_EQ(0, head.rfind("HTTP/1.1 404 Not Found\r\n", 0)) << path;
+            }
+            EXPECT_EQ(0, next.rfind("HTTP/1.1 200 OK\r\n", 0)) << path;
+            EXPECT_EQ("note", next.substr(next.find("\r\n\r\n") + 4)) << path;
+        }
+
+        // 其他方法返回 405，连接仍可继续使用
+        std::string response = request(port, "POST /note.txt HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"
+                                             "GET /note.txt HTTP/1.1\r\nConnection: close\r\n\r\n");
+        EXPECT_EQ(0, response.rfind("HTTP/1.1 405 Method Not Allowed\r\n", 0));
+        EXPECT_NE(std::string::npos, response.find("\r\nAllow: GET, HEAD\r\nContent-Length: 0\r\n\r\n"
+                                                   "HTTP/1.1 200 OK\r\n"));
+        EXPECT_EQ("note", response.substr(response.rfind("\r\n\r\n") + 4));
+
+        server.shutdown();
+        thread.join();
+        ++port;
+    }
+}
+
+TEST_F(ServerTest, OverloadIsShed) {
+    ServerOptions options;
+    options.staticRoot = root;
+    options.maxInFlightRequests = 1;
+    options.targetQueueWaitMs = 0; // 固定的并发上限
+    options.maxConnections = 2;
+    Server server("127.0.0.1", 18447, quietLogger(), options);
+    std::thread thread([&server]() { server.setup(); });
+
+    // 占住线程池的全部工作线程，交给线程池的请求只能排队
+    ThreadPool &pool = getThreadPool();
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<size_t> blocked(0);
+    for (size_t i = 0; i < pool.size(); ++i) {
+        pool.post([&blocked, released]() {
+            blocked.fetch_add(1);
+            released.wait();
+        });
+    }
+    while (blocked.load() < pool.size()) {
+        std::this_thread::yield();
+    }
+
+    int admitted = connectTo(18447);
+    ASSERT_GE(admitted, 0);
+    std::string raw = "GET /index.html HTTP/1.1\r\n\r\n";
+    send(admitted, raw.data(), raw.size(), MSG_NOSIGNAL);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // 超过并发上限的请求立即得到 503，不进入线程池
+    std::string response = request(18447, "GET / HTTP/1.1\r\n\r\n");
+    EXPECT_EQ("HTTP/1.1 503 Service Unavailable\r\nRetry-After: 1\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+              response);
+
+    // 超过连接数上限的连接在 accept 后立即得到 503 并被关闭
+    int idle = connectTo(18447);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    int rejected = connectTo(18447);
+    std::string rejection;
+    char buf[256];
+    ssize_t len;
+    while ((len = recv(rejected, buf, sizeof(buf), 0)) > 0) {
+        rejection.append(buf, len);
+    }
+    EXPECT_EQ(0, rejection.rfind("HTTP/1.1 503 Service Unavailable\r\n", 0));
+    close(rejected);
+
+    release.set_value();
+    response = exchange(admitted, "");
+    ASSERT_EQ(0, response.rfind("HTTP/1.1 200 OK\r\n", 0));
+    response = exchange(admitted, "GET /metrics HTTP/1.1\r\n\r\n");
+    ASSERT_NE(std::string::npos, response.find("\nwebserver_requests_shed_total 1\n"));
+    ASSERT_NE(std::string::npos, response.find("\nwebserver_connections_shed_total 1\n"));
+    ASSERT_NE(std::string::npos, response.find("webserver_responses_total{code=\"503\"} 2\n"));
+    close(admitted);
+    close(idle);
+
+    server.shutdown();
+    thread.join();
+}
+
+TEST_F(ServerTest, DestroyWhileRequestInPool) {
+    ServerOptions options;
+    options.staticRoot = root;
+    auto server = std::make_unique<Server>("127.0.0.1", 18448, quietLogger(), options);
+    std::thread thread([&server]() { server->setup(); });
+
+    // 占住线程池的全部工作线程，请求的处理任务停留在线程池中
+    ThreadPool &pool = getThreadPool();
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<size_t> blocked(0);
+    for (size_t i = 0; i < pool.size(); ++i) {
+        pool.post([&blocked, released]() {
+            blocked.fetch_add(1);
+            released.wait();
+        });
+    }
+    while (blocked.load() < pool.size()) {
+        std::this_thread::yield();
+    }
+
+    int fd = connectTo(18448);
+    ASSERT_GE(fd, 0);
+    std::string raw = "GET /index.html HTTP/1.1\r\n\r\n";
+    send(fd, raw.data(), raw.size(), MSG_NOSIGNAL);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // 事件循环已退出，但服务器要等线程池中的任务结束才能销毁，任务引用着分片与连接的协程
+    server->shutdown();
+    thread.join();
+    std::atomic<bool> isDestroyed(false);
+    std::thread destroyer([&server, &isDestroyed]() {
+        server.reset();
+        isDestroyed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(isDestroyed.load());
+
+    release.set_value();
+    destroyer.join();
+    ASSERT_TRUE(isDestroyed.load());
+
+    // 服务器销毁时关闭了连接
+    char buf[256];
+    EXPECT_EQ(0, recv(fd, buf, sizeof(buf), 0));
+    close(fd);
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <src/simd_scanner.hpp>
+#include <string>
+
+// 各指令集等级的结果都应当与逐字节扫描一致
+TEST(SimdScannerTest, MatchesScalar) {
+    std::mt19937 random(42);
+    const std::string alphabet = "abcXYZ019 :;-/\t\r\n\x01\x7f\x80\xff";
+
+    for (SimdLevel level: {SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2}) {
+        if (!SimdScanner::setLevel(level))
+            continue;
+        ASSERT_EQ(level, SimdScanner::level());
+
+        for (int round = 0; round < 2000; ++round) {
+            size_t len = random() % 100;
+            std::string s(len, 'a');
+            // 大部分字节是普通字符，偶尔插入分隔符或控制字符
+            for (auto &c: s) {
+                if (random() % 16 == 0)
+                    c = alphabet[random() % alphabet.size()];
+            }
+
+            size_t control = len, colon = len;
+            for (size_t i = 0; i < len; ++i) {
+                auto u = static_cast<unsigned char>(s[i]);
+                if (control == len && ((u < 0x20 && u != '\t') || u == 0x7f))
+                    control = i;
+                if (colon == len && s[i] == ':')
+                    colon = i;
+            }
+            ASSERT_EQ(control, SimdScanner::findControl(s.data(), len)) << s;
+            ASSERT_EQ(colon, SimdScanner::findChar(s.data(), len, ':')) << s;
+        }
+    }
+    SimdScanner::setLevel(SimdScanner::detectLevel());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <src/task.hpp>
+#include <src/thread_pool.hpp>
+#include <test/allocation_counter.hpp>
+
+TEST(TaskTest, BasicAssertions) {
+    int value = 0;
+    Task task([&value]() { value = 42; });
+    ASSERT_TRUE(task);
+    ASSERT_TRUE(task.isInline());
+    task();
+    ASSERT_EQ(42, value);
+
+    task.reset();
+    ASSERT_FALSE(task);
+    ASSERT_FALSE(Task());
+}
+
+TEST(TaskTest, MoveOnlyCallable) {
+    auto pointer = std::make_unique<int>(7);
+    int result = 0;
+    Task task([pointer = std::move(pointer), &result]() { result = *pointer; });
+
+    Task moved(std::move(task));
+    ASSERT_FALSE(task);
+    moved();
+    ASSERT_EQ(7, result);
+
+    // packaged_task 只能移动，也能直接保存
+    std::packaged_task<int()> packaged([]() { return 5; });
+    auto future = packaged.get_future();
+    Task wrapped(std::move(packaged));
+    ASSERT_TRUE(wrapped.isInline());
+    wrapped();
+    ASSERT_EQ(5, future.get());
+}
+
+TEST(TaskTest, SmallBufferAndHeapFallback) {
+    auto counter = std::make_shared<int>(0);
+    struct Large {
+        char padding[Task::INLINE_SIZE + 1];
+        std::shared_ptr<int> counter;
+
+        void operator()() const {
+            ++*counter;
+        }
+    };
+
+    AllocationCounter allocations;
+    Task small([counter]() { ++*counter; });
+    ASSERT_EQ(0, allocations.count());
+    ASSERT_TRUE(small.isInline());
+
+    Task large(Large{{}, counter});
+    ASSERT_EQ(1, allocations.count());
+    ASSERT_FALSE(large.isInline());
+
+    // 移动后两种任务都正常执行，并在销毁时释放捕获的对象
+    Task a(std::move(small)), b(std::move(large));
+    a = std::move(b);
+    a();
+    ASSERT_EQ(1, *counter);
+    a.reset();
+    ASSERT_EQ(1, counter.use_count());
+}
+
+TEST(TaskTest, PostWithoutAllocation) {
+    ThreadPool pool(2);
+    std::atomic<int> counter(0);
+    auto round = [&pool, &counter](int n) {
+        int target = counter.load() + n;
+        for (int i = 0; i < n; ++i) {
+            pool.post([&counter]() { counter.fetch_add(1); });
+        }
+        while (counter.load() != target) {
+            std::this_thread::yield();
+        }
+    };
+
+    // 预热：节点与注入队列分配完成后循环使用
+    for (int i = 0; i < 100; ++i) {
+        round(100);
+    }
+    AllocationCounter allocations;
+    for (int i = 0; i < 100; ++i) {
+        round(100);
+    }
+    ASSERT_EQ(0, allocations.count());
+}
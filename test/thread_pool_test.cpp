@@ -15,8 +15,116 @@ TEST(ThreadPoolTest, BasicAssertions) {
 //    getThreadPool().shutdown();
 }
 
+TEST(ThreadPoolTest, ManyTasks) {
+    ThreadPool pool(4);
+    std::atomic<int> counter(0);
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 10000; ++i) {
+        futures.push_back(pool.submit([&counter]() { counter.fetch_add(1); }));
+    }
+    for (auto &future: futures) {
+        future.get();
+    }
+    ASSERT_EQ(10000, counter.load());
+}
+
+TEST(ThreadPoolTest, NestedSubmitAndSteal) {
+    // 工作线程内部提交的任务进入自己的队列，其他空闲线程从中窃取
+    ThreadPool pool(4);
+    std::atomic<int> counter(0);
+    std::promise<void> done;
+    const int total = 64 * 64;
+
+    pool.submit([&]() {
+        for (int i = 0; i < 64; ++i) {
+            pool.submit([&]() {
+                for (int j = 0; j < 64; ++j) {
+                    pool.submit([&]() {
+                        if (counter.fetch_add(1) + 1 == total)
+                            done.set_value();
+                    });
+                }
+            });
+        }
+    });
+    done.get_future().get();
+    ASSERT_EQ(total, counter.load());
+}
+
+TEST(ThreadPoolTest, SizedToHardware) {
+    ASSERT_EQ(std::max(1u, std::thread::hardware_concurrency()), getThreadPool().size());
+}
+
+TEST(ThreadPoolTest, PostMoveOnly) {
+    ThreadPool pool(2);
+    std::promise<int> promise;
+    auto future = promise.get_future();
+    auto value = std::make_unique<int>(9);
+    pool.post([promise = std::move(promise), value = std::move(value)]() mutable {
+        promise.set_value(*value);
+    });
+    ASSERT_EQ(9, future.get());
+}
+
+TEST(ThreadPoolTest, TryPostRespectsCapacity) {
+    ThreadPool pool(1, 4);
+    std::promise<void> started, release;
+    std::shared_future<void> released = release.get_future().share();
+    pool.post([&started, released]() {
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait(); // 唯一的工作线程被占用，之后的任务都留在注入队列中
+
+    std::atomic<int> done(0);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(pool.tryPost([&done]() { done.fetch_add(1); }));
+    }
+    ASSERT_FALSE(pool.tryPost([]() {}));
+    ASSERT_EQ(4, pool.queueDepth());
+
+    release.set_value();
+    while (done.load() < 4) {
+        std::this_thread::yield();
+    }
+    ASSERT_TRUE(pool.tryPost([&done]() { done.fetch_add(1); }));
+    while (done.load() < 5) {
+        std::this_thread::yield();
+    }
+}
+
+TEST(WorkStealingDequeTest, OwnerAndThieves) {
+    WorkStealingDeque<int> deque(2);
+    for (int i = 0; i < 100; ++i) {
+        deque.push(i); // 触发多次扩容
+    }
+    ASSERT_EQ(0, *deque.steal()); // 从顶部窃取最早的任务
+    ASSERT_EQ(99, *deque.pop());  // 所属线程从底部取最新的任务
+
+    std::atomic<int> sum(0);
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t) {
+        thieves.emplace_back([&]() {
+            while (auto item = deque.steal()) {
+                sum.fetch_add(*item);
+            }
+        });
+    }
+    while (auto item = deque.pop()) {
+        sum.fetch_add(*item);
+    }
+    for (auto &thief: thieves) {
+        thief.join();
+    }
+    // steal() 在竞争失败时也会返回空，剩余元素由所属线程兜底
+    while (auto item = deque.pop()) {
+        sum.fetch_add(*item);
+    }
+    ASSERT_EQ(98 * 99 / 2, sum.load()); // 1..98
+    ASSERT_TRUE(deque.empty());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
 }
-
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <src/timing_wheel.hpp>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+class TimingWheelTest : public ::testing::Test {
+protected:
+    TimingWheel::Clock::time_point at(TimingWheel::Clock::duration offset) const {
+        return start + offset;
+    }
+
+    TimingWheel::Clock::time_point start = TimingWheel::Clock::now();
+
+    TimingWheel wheel{10ms, start};
+};
+
+TEST_F(TimingWheelTest, FireInOrderNeverEarly) {
+    std::vector<int> fired;
+    TimerNode a([&]() { fired.push_back(1); });
+    TimerNode b([&]() { fired.push_back(2); });
+    TimerNode c([&]() { fired.push_back(3); });
+    wheel.arm(a, at(25ms)); // 向上取整到第 3 个刻度
+    wheel.arm(b, at(10ms));
+    wheel.arm(c, at(-5ms)); // 已经过去的时间在下一个刻度触发
+    ASSERT_EQ(3, wheel.size());
+
+    ASSERT_EQ(0, wheel.advance(at(9ms)));
+    ASSERT_EQ(2, wheel.advance(at(10ms)));
+    ASSERT_EQ((std::vector<int>{2, 3}), fired);
+    ASSERT_EQ(0, wheel.advance(at(29ms)));
+    ASSERT_EQ(1, wheel.advance(at(30ms)));
+    ASSERT_EQ((std::vector<int>{2, 3, 1}), fired);
+    ASSERT_EQ(0, wheel.size());
+    ASSERT_FALSE(a.isArmed());
+    ASSERT_EQ(-1, wheel.nextTimeoutMs(at(30ms)));
+}
+
+TEST_F(TimingWheelTest, RearmAndCancel) {
+    int count = 0;
+    TimerNode node([&]() { ++count; });
+    wheel.arm(node, at(50ms));
+    wheel.arm(node, at(200ms)); // 推迟
+    ASSERT_EQ(1, wheel.size());
+    wheel.advance(at(100ms));
+    ASSERT_EQ(0, count);
+    ASSERT_TRUE(node.isArmed());
+
+    node.cancel();
+    node.cancel();
+    ASSERT_EQ(0, wheel.size());
+    wheel.advance(at(300ms));
+    ASSERT_EQ(0, count);
+
+    {
+        TimerNode temporary([&]() { ++count; });
+        wheel.arm(temporary, at(400ms));
+        ASSERT_EQ(1, wheel.size());
+    }
+    ASSERT_EQ(0, wheel.size()); // 析构时取消
+}
+
+TEST_F(TimingWheelTest, CascadeAcrossLevels) {
+    // 覆盖每一层：刻度数分别落在第 0 到 3 层，以及超出范围被截断
+    std::vector<uint64_t> ticks = {1, 63, 64, 65, 4095, 4096, 4097, 100000, 262144, 300000};
+    std::vector<std::unique_ptr<TimerNode>> nodes;
+    std::vector<uint64_t> firedAt(ticks.size(), 0);
+    uint64_t now = 0;
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        nodes.push_back(std::make_unique<TimerNode>([&, i]() { firedAt[i] = now; }));
+        wheel.arm(*nodes.back(), at(10ms * ticks[i]));
+    }
+    // 逐刻度前进，每个定时器恰好在到期的刻度触发
+    for (now = 1; now <= 300000; ++now) {
+        wheel.advance(at(10ms * now));
+    }
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        ASSERT_EQ(ticks[i], firedAt[i]) << "timer " << i;
+    }
+
+    // 一次前进很多刻度时同样全部触发
+    size_t count = 0;
+    for (uint64_t tick: ticks) {
+        nodes.push_back(std::make_unique<TimerNode>([&]() { ++count; }));
+        wheel.arm(*nodes.back(), at(10ms * (300000 + tick)));
+    }
+    ASSERT_EQ(0, wheel.advance(at(10ms * 300000)));
+    ASSERT_EQ(ticks.size(), wheel.advance(at(10ms * 700000)));
+    ASSERT_EQ(ticks.size(), count);
+}
+
+TEST_F(TimingWheelTest, CallbackMayDestroyAndArm) {
+    auto owned = std::make_unique<TimerNode>();
+    owned->setCallback([&]() { owned.reset(); });
+    TimerNode rearmed;
+    int count = 0;
+    rearmed.setCallback([&]() {
+        if (++count < 3)
+            wheel.arm(rearmed, at(10ms * (count + 1)));
+    });
+    wheel.arm(*owned, at(10ms));
+    wheel.arm(rearmed, at(10ms));
+
+    wheel.advance(at(10ms));
+    ASSERT_EQ(nullptr, owned);
+    ASSERT_EQ(1, count);
+    wheel.advance(at(50ms));
+    ASSERT_EQ(3, count);
+    ASSERT_EQ(0, wheel.size());
+}
+
+TEST_F(TimingWheelTest, NextTimeout) {
+    TimerNode near, far;
+    wheel.arm(near, at(35ms));
+    ASSERT_EQ(40, wheel.nextTimeoutMs(at(0ms)));
+    ASSERT_EQ(0, wheel.nextTimeoutMs(at(45ms)));
+    near.cancel();
+
+    // 上层的定时器只需要在下一次进位时处理
+    wheel.arm(far, at(10s));
+    ASSERT_EQ(640, wheel.nextTimeoutMs(at(0ms)));
+}
+
+TEST_F(TimingWheelTest, ManyTimers) {
+    constexpr size_t COUNT = 200000;
+    std::vector<TimerNode> nodes(COUNT);
+    size_t fired = 0;
+    for (size_t i = 0; i < COUNT; ++i) {
+        nodes[i].setCallback([&fired]() { ++fired; });
+        wheel.arm(nodes[i], at(10ms * (1 + i % 5000)));
+    }
+    // 大部分定时器在到期前被推迟或取消
+    for (size_t i = 0; i < COUNT; ++i) {
+        if (i % 2 == 0) {
+            wheel.arm(nodes[i], at(100s));
+        } else if (i % 3 == 0) {
+            nodes[i].cancel();
+        }
+    }
+    size_t expected = 0;
+    for (size_t i = 0; i < COUNT; ++i) {
+        expected += nodes[i].isArmed() && i % 2 == 1;
+    }
+    ASSERT_EQ(expected, wheel.advance(at(50s)));
+    ASSERT_EQ(expected, fired);
+    ASSERT_EQ(COUNT / 2, wheel.size());
+}
@@ -0,0 +1,43 @@
+/**
+ * 静态资源打包工具
+ *
+ * 把静态资源目录打包成一个资源包文件（见 src/asset_pack.hpp），服务器以 --asset-pack 映射后直接提供，
+ * 多个服务器进程映射同一个文件时共享同一份内存
+ *
+ * 用法：pack_assets [--no-compress] <静态资源目录> <输出文件>
+ */
+
+#include <iostream>
+#include <src/asset_pack.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+int main(int argc, char **argv) {
+    bool compress = true;
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view(argv[i]) == "--no-compress") {
+            compress = false;
+        } else {
+            arguments.emplace_back(argv[i]);
+        }
+    }
+    if (arguments.size() != 2) {
+        std::cerr << "Usage: pack_assets [--no-compress] <root> <output>" << std::endl;
+        return 1;
+    }
+
+    if (!AssetPack::build(arguments[0], arguments[1], compress)) {
+        std::cerr << "Fail to pack " << arguments[0] << " into " << arguments[1] << std::endl;
+        return 1;
+    }
+    auto pack = AssetPack::open(arguments[1]);
+    if (!pack) {
+        std::cerr << "Fail to open " << arguments[1] << std::endl;
+        return 1;
+    }
+    std::cout << "Packed " << pack->size() << " assets into " << arguments[1] << " (" << pack->mappedBytes()
+              << " bytes)" << std::endl;
+    return 0;
+}